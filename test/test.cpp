@@ -33,6 +33,8 @@
 
 #include "language/stl.h"
 
+#include "utils/bits.h"
+
 int main() {
     std::cout << "Hello test!\n";
 
@@ -46,15 +48,8 @@ int main() {
       kLastValue = kCanceled
     };
     uintptr_t value = static_cast<uintptr_t>(State::kLastValue);
-    // Keep setting 1's to the right of the first one until there are only 1's.
-    // In each iteration we double the number of 1's that we set. At last add 1
-    // and we have the next power of 2.
-    auto i = [&]() {
-      for (size_t i = 1; i < sizeof(uintptr_t) * 8; i <<= 1) {
-        value |= value >> i;
-      }
-      return value + 1;
-    }();
+    // The next power of 2 above the last value.
+    auto i = utils::bits::NextPowerOfTwo(value + 1);
 
 
 
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/arena.h"
+
+#include <algorithm>
+
+void utils::Arena::Reset() {
+    while (block_) {
+        Block* previous = block_->previous;
+        ::operator delete(block_);
+        block_ = previous;
+    }
+    position_ = end_ = nullptr;
+    bytes_reserved_ = 0;
+}
+
+void* utils::Arena::AllocateSlow(size_t size, size_t alignment) {
+    const size_t needed = sizeof(Block) + alignment + size;
+
+    // A large allocation gets a block of its own, linked in behind the
+    // current one so the free space there is still used.
+    if (block_ && needed > block_size_ / 4) {
+        Block* block = static_cast<Block*>(::operator new(needed));
+        block->size = needed;
+        block->previous = block_->previous;
+        block_->previous = block;
+        bytes_reserved_ += needed;
+        const uintptr_t start = reinterpret_cast<uintptr_t>(block + 1);
+        return reinterpret_cast<void*>((start + alignment - 1) & ~(alignment - 1));
+    }
+
+    const size_t block_size = std::max(needed, block_size_);
+    Block* block = static_cast<Block*>(::operator new(block_size));
+    block->size = block_size;
+    block->previous = block_;
+    block_ = block;
+    bytes_reserved_ += block_size;
+    position_ = reinterpret_cast<char*>(block + 1);
+    end_ = reinterpret_cast<char*>(block) + block_size;
+    return Allocate(size, alignment);
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_ARENA_INCLUDE_H_
+#define UTILS_ARENA_INCLUDE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// A monotonic region: allocations bump a pointer through blocks taken from
+// the heap, nothing is freed on its own, and the destructor or Reset() hands
+// all blocks back at once. It replaces one malloc/free pair per object with
+// a few adds per object plus one heap call per block.
+//
+// The arena never runs destructors. New() only takes trivially destructible
+// types; ArenaVector and ArenaMap in utils/containers run the destructors of
+// their elements themselves, and skip that too when there are none to run.
+class UTILS_API Arena {
+public:
+    static const size_t kDefaultBlockSize = 16 * 1024;
+
+    explicit Arena(size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+    ~Arena() { Reset(); }
+
+    // Returns |size| bytes aligned to |alignment|, a power of two, valid until
+    // the arena is reset or destroyed.
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        const uintptr_t position = (reinterpret_cast<uintptr_t>(position_) + alignment - 1) & ~(alignment - 1);
+        const uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+        if (position_ == nullptr || position > end || size > end - position) return AllocateSlow(size, alignment);
+        position_ = reinterpret_cast<char*>(position + size);
+        return reinterpret_cast<void*>(position);
+    }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena does not run destructors");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Frees every block. Everything allocated so far becomes invalid.
+    void Reset();
+
+    // The bytes taken from the heap, including block headers and the unused
+    // tail of each block.
+    size_t bytes_reserved() const { return bytes_reserved_; }
+
+private:
+    struct Block {
+        Block* previous;
+        size_t size;
+    };
+
+    void* AllocateSlow(size_t size, size_t alignment);
+
+    char* position_ = nullptr;
+    char* end_ = nullptr;
+    Block* block_ = nullptr;
+    const size_t block_size_;
+    size_t bytes_reserved_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// A std allocator drawing from an Arena, for node-based containers whose
+// nodes should all go away with the arena. deallocate() does nothing.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    Arena* arena() const { return arena_; }
+
+private:
+    Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() != b.arena(); }
+
+} // namespace utils
+
+#endif  // !UTILS_ARENA_INCLUDE_H_
@@ -19,10 +19,13 @@
 #include <string.h>
 #include <wchar.h>
 
-#include <WinUser.h>
-
+#include "utils/bits.h"
 #include "utils/compiler.h"
 
+#if defined(OS_WIN)
+#include <WinUser.h>
+#endif
+
 #define UTILS_USER_LOWER        WM_USER + 0x07E1            // 07E1->2017, 
 #define UTILS_USER_UPPER        WM_USER + 0x7FFF - WM_USER
 #define UTILS_APP_LOWER         WM_APP
@@ -95,7 +98,13 @@ struct ToUnsigned<short> {
 };
 
 #ifdef OS_POSIX
-#error "without format_macros defined."
+
+#include <inttypes.h>
+
+#if !defined(PRIuS)
+#define PRIuS "zu"
+#endif
+
 #else // OS_WIN
 
 #if !defined(PRId64)
@@ -356,29 +365,13 @@ struct CompileAssert {
 
 
 // Returns the integer i such as 2^i <= n < 2^(i+1)
-inline int Log2Floor(uint32 n) {
-    if (n == 0) return -1;
-    int log = 0;
-    uint32 value = n;
-    for (int i = 4; i >= 0; --i) {
-        int shift = (1 << i);
-        uint32 x = value >> shift;
-        if (x != 0) {
-            value = x;
-            log += shift;
-        }
-    }
-    return log;
+constexpr int Log2Floor(uint32 n) {
+    return utils::bits::Log2Floor(n);
 }
 
 // Returns the integer i such as 2^(i-1) < n <= 2^i
-inline int Log2Ceiling(uint32 n) {
-    if (n == 0) {
-        return -1;
-    } else {
-        // Log2Floor returns -1 for 0, so the following works correctly for n=1.
-        return 1 + Log2Floor(n - 1);
-    }
+constexpr int Log2Ceiling(uint32 n) {
+    return utils::bits::Log2Ceiling(n);
 }
 
 // float_util
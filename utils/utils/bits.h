@@ -0,0 +1,301 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_BITS_INCLUDE_H_
+#define UTILS_BITS_INCLUDE_H_
+
+// Bit manipulation on unsigned integers of 8 to 64 bits. Every function is
+// constexpr. At runtime they compile to the matching instruction: the GCC and
+// clang builtins do that on their own, and on MSVC the intrinsics are called
+// whenever the compiler is not evaluating a constant expression. LZCNT, TZCNT,
+// POPCNT and BEXTR are only used when the build targets a processor that has
+// them (/arch:AVX2 or -mlzcnt -mbmi -mpopcnt); otherwise BSR/BSF or the
+// portable code below are, since a per-call CPU check costs more than the
+// instruction saves. This header sits under basictypes.h, so it only uses
+// the <stdint.h> types.
+
+#include <stdint.h>
+
+#include <type_traits>
+
+#include "utils/compiler.h"
+
+// MSVC reports 199711L in __cplusplus unless /Zc:__cplusplus is given.
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) < 201703L
+#error "utils/bits.h needs C++17 (/std:c++17 or -std=c++17)."
+#endif
+
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+#if defined(ARCH_CPU_X86_FAMILY) && (defined(__AVX2__) || defined(__BMI__))
+#include <immintrin.h>
+#endif
+
+// True while the compiler evaluates a constant expression, where the MSVC
+// intrinsics cannot be called. Only defined by compilers that can tell.
+#if (defined(COMPILER_GCC) && __GNUC__ >= 9) || defined(__clang__) || (defined(COMPILER_MSVC) && _MSC_VER >= 1925)
+#define UTILS_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+namespace utils {
+namespace bits {
+namespace internal {
+
+// The unsigned integer types of 8 to 64 bits, but not bool.
+template <typename T>
+using EnableIfUnsigned =
+    typename std::enable_if<std::is_unsigned<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8, int>::type;
+
+template <typename T>
+constexpr int BitWidth() { return static_cast<int>(sizeof(T) * 8); }
+
+// The portable versions, for constant expressions on compilers without the
+// builtins.
+constexpr int PopCountPortable(uint64_t value) {
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+}
+
+constexpr int CountLeadingZeroBitsPortable(uint64_t value) {
+    if (value == 0) return 64;
+    int count = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if ((value >> (64 - shift)) == 0) {
+            count += shift;
+            value <<= shift;
+        }
+    }
+    return count;
+}
+
+constexpr int CountTrailingZeroBitsPortable(uint64_t value) {
+    return value == 0 ? 64 : PopCountPortable((value & (~value + 1)) - 1);
+}
+
+constexpr int PopCount32(uint32_t value) {
+#if defined(COMPILER_GCC)
+    return __builtin_popcount(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED) && defined(__AVX2__)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) return static_cast<int>(__popcnt(value));
+#endif
+    return PopCountPortable(value);
+#endif
+}
+
+constexpr int PopCount64(uint64_t value) {
+#if defined(COMPILER_GCC)
+    return __builtin_popcountll(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED) && defined(__AVX2__) && defined(ARCH_CPU_X86_64)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) return static_cast<int>(__popcnt64(value));
+#endif
+    return PopCountPortable(value);
+#endif
+}
+
+constexpr int CountLeadingZeroBits32(uint32_t value) {
+#if defined(COMPILER_GCC)
+    return value == 0 ? 32 : __builtin_clz(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+        return static_cast<int>(__lzcnt(value));
+#else
+        unsigned long index = 0;
+        return _BitScanReverse(&index, value) ? 31 - static_cast<int>(index) : 32;
+#endif
+    }
+#endif
+    return CountLeadingZeroBitsPortable(value) - 32;
+#endif
+}
+
+constexpr int CountLeadingZeroBits64(uint64_t value) {
+#if defined(COMPILER_GCC)
+    return value == 0 ? 64 : __builtin_clzll(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED) && defined(ARCH_CPU_X86_64)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+        return static_cast<int>(__lzcnt64(value));
+#else
+        unsigned long index = 0;
+        return _BitScanReverse64(&index, value) ? 63 - static_cast<int>(index) : 64;
+#endif
+    }
+#endif
+    const uint32_t high = static_cast<uint32_t>(value >> 32);
+    return high ? CountLeadingZeroBits32(high) : 32 + CountLeadingZeroBits32(static_cast<uint32_t>(value));
+#endif
+}
+
+constexpr int CountTrailingZeroBits32(uint32_t value) {
+#if defined(COMPILER_GCC)
+    return value == 0 ? 32 : __builtin_ctz(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+        return static_cast<int>(_tzcnt_u32(value));
+#else
+        unsigned long index = 0;
+        return _BitScanForward(&index, value) ? static_cast<int>(index) : 32;
+#endif
+    }
+#endif
+    return value == 0 ? 32 : CountTrailingZeroBitsPortable(value);
+#endif
+}
+
+constexpr int CountTrailingZeroBits64(uint64_t value) {
+#if defined(COMPILER_GCC)
+    return value == 0 ? 64 : __builtin_ctzll(value);
+#else
+#if defined(UTILS_IS_CONSTANT_EVALUATED) && defined(ARCH_CPU_X86_64)
+    if (!UTILS_IS_CONSTANT_EVALUATED()) {
+#if defined(__AVX2__)
+        return static_cast<int>(_tzcnt_u64(value));
+#else
+        unsigned long index = 0;
+        return _BitScanForward64(&index, value) ? static_cast<int>(index) : 64;
+#endif
+    }
+#endif
+    const uint32_t low = static_cast<uint32_t>(value);
+    return low ? CountTrailingZeroBits32(low) : 32 + CountTrailingZeroBits32(static_cast<uint32_t>(value >> 32));
+#endif
+}
+
+} // namespace internal
+
+// Returns the number of set bits.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr int PopCount(T value) {
+    return sizeof(T) == 8 ? internal::PopCount64(value) : internal::PopCount32(static_cast<uint32_t>(value));
+}
+
+// Return the number of zero bits above the highest set bit, or below the
+// lowest one; both are the width of |T| for 0.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr int CountLeadingZeroBits(T value) {
+    return sizeof(T) == 8 ? internal::CountLeadingZeroBits64(value)
+                          : internal::CountLeadingZeroBits32(static_cast<uint32_t>(value)) - (32 - internal::BitWidth<T>());
+}
+
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr int CountTrailingZeroBits(T value) {
+    return value == 0 ? internal::BitWidth<T>()
+         : sizeof(T) == 8 ? internal::CountTrailingZeroBits64(value)
+                          : internal::CountTrailingZeroBits32(static_cast<uint32_t>(value));
+}
+
+// Returns the integer i such as 2^i <= n < 2^(i+1), or -1 for 0.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr int Log2Floor(T n) {
+    return internal::BitWidth<T>() - 1 - CountLeadingZeroBits(n);
+}
+
+// Returns the integer i such as 2^(i-1) < n <= 2^i, or -1 for 0.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr int Log2Ceiling(T n) {
+    // Log2Floor returns -1 for 0, so this works for n = 1.
+    return n == 0 ? -1 : 1 + Log2Floor(static_cast<T>(n - 1));
+}
+
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr bool IsPowerOfTwo(T value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// Returns the smallest power of two not below |value|: 1 for 0 and 1, and 0
+// when it does not fit in |T|.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T NextPowerOfTwo(T value) {
+    return value <= 1 ? T(1)
+         : Log2Ceiling(value) == internal::BitWidth<T>() ? T(0)
+                                                         : static_cast<T>(T(1) << Log2Ceiling(value));
+}
+
+// Returns the largest power of two not above |value|, or 0 for 0.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T PreviousPowerOfTwo(T value) {
+    return value == 0 ? T(0) : static_cast<T>(T(1) << Log2Floor(value));
+}
+
+// Reverses the byte order, between big and little endian. The shifts are
+// what MSVC, GCC and clang all turn into a single BSWAP.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T ByteSwap(T value) {
+    if constexpr (sizeof(T) == 1) {
+        return value;
+    } else if constexpr (sizeof(T) == 2) {
+#if defined(COMPILER_GCC)
+        return __builtin_bswap16(value);
+#else
+        return static_cast<T>((value >> 8) | (value << 8));
+#endif
+    } else if constexpr (sizeof(T) == 4) {
+#if defined(COMPILER_GCC)
+        return __builtin_bswap32(value);
+#else
+        return static_cast<T>(((value >> 24) & 0x000000FFu) | ((value >> 8) & 0x0000FF00u) |
+                              ((value << 8) & 0x00FF0000u) | ((value << 24) & 0xFF000000u));
+#endif
+    } else {
+#if defined(COMPILER_GCC)
+        return __builtin_bswap64(value);
+#else
+        return static_cast<T>(static_cast<uint64_t>(ByteSwap(static_cast<uint32_t>(value))) << 32 |
+                              ByteSwap(static_cast<uint32_t>(value >> 32)));
+#endif
+    }
+}
+
+// Rotate the bits by |shift| places, which is taken modulo the width of |T|.
+// Both compile to ROL/ROR.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T RotateLeft(T value, int shift) {
+    const int width = internal::BitWidth<T>();
+    shift &= width - 1;
+    return shift == 0 ? value : static_cast<T>(value << shift | value >> (width - shift));
+}
+
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T RotateRight(T value, int shift) {
+    const int width = internal::BitWidth<T>();
+    shift &= width - 1;
+    return shift == 0 ? value : static_cast<T>(value >> shift | value << (width - shift));
+}
+
+// Returns the |count| bits of |value| starting at bit |start|, shifted down
+// to bit 0, like BEXTR: bits past the top of |T| read as 0.
+template <typename T, internal::EnableIfUnsigned<T> = 0>
+constexpr T ExtractBits(T value, int start, int count) {
+    const int width = internal::BitWidth<T>();
+#if defined(UTILS_IS_CONSTANT_EVALUATED) && defined(ARCH_CPU_X86_FAMILY) && (defined(__AVX2__) || defined(__BMI__))
+    if (!UTILS_IS_CONSTANT_EVALUATED()) {
+#if defined(ARCH_CPU_X86_64)
+        if (sizeof(T) == 8) return static_cast<T>(_bextr_u64(value, start, count));
+#endif
+        if (sizeof(T) < 8) return static_cast<T>(_bextr_u32(static_cast<uint32_t>(value), start, count));
+    }
+#endif
+    if (start >= width || count <= 0) return 0;
+    value = static_cast<T>(value >> start);
+    return count >= width ? value : static_cast<T>(value & ((T(1) << count) - 1));
+}
+
+} // namespace bits
+} // namespace utils
+
+#endif  // !UTILS_BITS_INCLUDE_H_
@@ -0,0 +1,172 @@
+#include <Windows.h>
+#include "utils/basictypes.h"
+#include "utils/bits.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// The bit-at-a-time definitions the intrinsics are checked against.
+template <typename T>
+int ReferencePopCount(T value) {
+    int count = 0;
+    for (; value; value >>= 1) count += value & 1;
+    return count;
+}
+
+template <typename T>
+int ReferenceLog2Floor(T value) {
+    int log = -1;
+    for (; value; value >>= 1) ++log;
+    return log;
+}
+
+template <typename T>
+void CheckBits(T value) {
+    const int width = sizeof(T) * 8;
+    const int log = ReferenceLog2Floor(value);
+    int trailing = 0;
+    while (trailing < width && !(value >> trailing & 1)) ++trailing;
+    if (utils::bits::PopCount(value) != ReferencePopCount(value)) __debugbreak();
+    if (utils::bits::CountLeadingZeroBits(value) != width - 1 - log) __debugbreak();
+    if (utils::bits::CountTrailingZeroBits(value) != trailing) __debugbreak();
+    if (utils::bits::Log2Floor(value) != log) __debugbreak();
+    if (utils::bits::IsPowerOfTwo(value) != (ReferencePopCount(value) == 1)) __debugbreak();
+    if (value != 0) {
+        const T previous = utils::bits::PreviousPowerOfTwo(value);
+        const T next = utils::bits::NextPowerOfTwo(value);
+        if (!utils::bits::IsPowerOfTwo(previous) || previous > value || (previous << 1 <= value && previous << 1 != 0))
+            __debugbreak();
+        if (next != 0 && (!utils::bits::IsPowerOfTwo(next) || next < value || next >> 1 >= value)) __debugbreak();
+        if (next == 0 && log != width - 1) __debugbreak();
+        if (utils::bits::Log2Ceiling(value) != log + !utils::bits::IsPowerOfTwo(value)) __debugbreak();
+    }
+    if (utils::bits::ByteSwap(utils::bits::ByteSwap(value)) != value) __debugbreak();
+    for (int shift = 0; shift < width; ++shift) {
+        const T rotated = utils::bits::RotateLeft(value, shift);
+        if (utils::bits::RotateRight(rotated, shift) != value || utils::bits::PopCount(rotated) != ReferencePopCount(value))
+            __debugbreak();
+        if (shift && ((rotated >> shift) != static_cast<T>(value & (static_cast<T>(~T(0)) >> shift)))) __debugbreak();
+        for (int count = 0; count <= width - shift; ++count) {
+            T expected = 0;
+            for (int bit = 0; bit < count; ++bit) expected |= static_cast<T>((value >> (shift + bit) & 1) << bit);
+            if (utils::bits::ExtractBits(value, shift, count) != expected) __debugbreak();
+        }
+    }
+}
+
+// Sample values of every width: all single bits, their neighbours and
+// random ones.
+template <typename T>
+void CheckAllBits(std::mt19937_64& random) {
+    CheckBits<T>(0);
+    CheckBits<T>(static_cast<T>(~T(0)));
+    for (int bit = 0; bit < static_cast<int>(sizeof(T) * 8); ++bit) {
+        const T power = static_cast<T>(T(1) << bit);
+        CheckBits<T>(power);
+        CheckBits<T>(static_cast<T>(power - 1));
+        CheckBits<T>(static_cast<T>(power + 1));
+    }
+    for (int i = 0; i < 200; ++i) CheckBits<T>(static_cast<T>(random()));
+}
+
+// Everything folds into a constant.
+static_assert(utils::bits::PopCount(0xF0F0u) == 8, "");
+static_assert(utils::bits::CountLeadingZeroBits(uint8_t(1)) == 7, "");
+static_assert(utils::bits::CountLeadingZeroBits(uint64_t(0)) == 64, "");
+static_assert(utils::bits::CountTrailingZeroBits(uint16_t(0x100)) == 8, "");
+static_assert(utils::bits::Log2Floor(0u) == -1 && utils::bits::Log2Floor(1u) == 0 && utils::bits::Log2Floor(1000u) == 9, "");
+static_assert(utils::bits::Log2Ceiling(0u) == -1 && utils::bits::Log2Ceiling(1u) == 0 && utils::bits::Log2Ceiling(1000u) == 10, "");
+static_assert(Log2Floor(4096) == 12 && Log2Ceiling(4097) == 13, "");
+static_assert(utils::bits::NextPowerOfTwo(0u) == 1 && utils::bits::NextPowerOfTwo(5u) == 8, "");
+static_assert(utils::bits::NextPowerOfTwo(uint8_t(129)) == 0 && utils::bits::PreviousPowerOfTwo(uint8_t(129)) == 128, "");
+static_assert(utils::bits::ByteSwap(uint32_t(0x12345678)) == 0x78563412u, "");
+static_assert(utils::bits::ByteSwap(uint64_t(0x0102030405060708ULL)) == 0x0807060504030201ULL, "");
+static_assert(utils::bits::RotateLeft(uint8_t(0x81), 1) == 0x03 && utils::bits::RotateRight(0x1u, 1) == 0x80000000u, "");
+static_assert(utils::bits::ExtractBits(0xABCDu, 4, 8) == 0xBC && utils::bits::ExtractBits(0xABCDu, 12, 32) == 0xA, "");
+
+}  // namespace
+
+int BITS_TEST(void) {
+    std::mt19937_64 random(19);
+    CheckAllBits<uint8_t>(random);
+    CheckAllBits<uint16_t>(random);
+    CheckAllBits<uint32_t>(random);
+    CheckAllBits<uint64_t>(random);
+    CheckAllBits<unsigned long>(random);
+
+    // The basictypes.h functions route through bits.h.
+    for (uint32 n = 0; n < 5000; ++n) {
+        if (Log2Floor(n) != ReferenceLog2Floor(n)) __debugbreak();
+        if (Log2Ceiling(n) != (n == 0 ? -1 : ReferenceLog2Floor(n - 1) + 1)) __debugbreak();
+    }
+
+    // The smallest power of two above a value, as test.cpp computes for an
+    // enum's last value.
+    for (uintptr_t value : { uintptr_t(0), uintptr_t(3), uintptr_t(4), uintptr_t(1000) }) {
+        uintptr_t smeared = value;
+        for (size_t i = 1; i < sizeof(uintptr_t) * 8; i <<= 1) smeared |= smeared >> i;
+        if (utils::bits::NextPowerOfTwo(value + 1) != smeared + 1) __debugbreak();
+    }
+    return 0;
+}
+
+// Runs Log2Floor, next power of two and popcount over 10M random values with
+// the shift loops they replace and with bits.h, and prints the time each
+// takes.
+int BITS_BENCHMARK(void) {
+    const size_t kValues = 10000000;
+    std::mt19937 random(7);
+    std::vector<uint32> values(kValues);
+    for (uint32& value : values) value = static_cast<uint32>(random()) >> (1 + random() % 31);
+
+    long long loop_sum = 0, bits_sum = 0;
+    auto loop_log = TimeMicroseconds([&]() {
+        for (uint32 n : values) {
+            int log = -1;
+            if (n != 0) {
+                log = 0;
+                for (int i = 4; i >= 0; --i) {
+                    const int shift = 1 << i;
+                    if (n >> shift) {
+                        n >>= shift;
+                        log += shift;
+                    }
+                }
+            }
+            loop_sum += log;
+        }
+    });
+    auto bits_log = TimeMicroseconds([&]() {
+        for (uint32 n : values) bits_sum += utils::bits::Log2Floor(n);
+    });
+    auto loop_power = TimeMicroseconds([&]() {
+        for (uint32 n : values) {
+            for (int i = 1; i < 32; i <<= 1) n |= n >> i;
+            loop_sum += n + 1;
+        }
+    });
+    auto bits_power = TimeMicroseconds([&]() {
+        for (uint32 n : values) bits_sum += utils::bits::NextPowerOfTwo(n + 1);
+    });
+    auto loop_count = TimeMicroseconds([&]() {
+        for (uint32 n : values) {
+            for (; n; n &= n - 1) ++loop_sum;
+        }
+    });
+    auto bits_count = TimeMicroseconds([&]() {
+        for (uint32 n : values) bits_sum += utils::bits::PopCount(n);
+    });
+
+    std::cout << "Log2Floor: loop " << loop_log << "us, bits " << bits_log << "us" << std::endl;
+    std::cout << "Next power of two: loop " << loop_power << "us, bits " << bits_power << "us" << std::endl;
+    std::cout << "PopCount: loop " << loop_count << "us, bits " << bits_count << "us" << std::endl;
+    return loop_sum == bits_sum ? 0 : 1;
+}
+
+#endif // TEST
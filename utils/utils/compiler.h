@@ -14,6 +14,8 @@
 #if defined(_WIN32)
 #define OS_WIN 1
 #define TOOLKIT_VIEWS 1
+#elif defined(__linux__) || defined(__APPLE__) || defined(__unix__)
+#define OS_POSIX 1
 #else
 #error Please add support for your platform
 #endif
@@ -41,6 +43,15 @@
 #error Please add support for your compiler in build/config.h
 #endif
 
+// Processor architecture detection.
+#if defined(_M_X64) || defined(__x86_64__)
+#define ARCH_CPU_X86_FAMILY 1
+#define ARCH_CPU_X86_64 1
+#elif defined(_M_IX86) || defined(__i386__)
+#define ARCH_CPU_X86_FAMILY 1
+#define ARCH_CPU_X86 1
+#endif
+
 #ifdef COMPILER_MSVC
 #define GG_LONGLONG(x) x##I64
 #define GG_ULONGLONG(x) x##UI64
@@ -127,6 +138,17 @@
 #define ALIGNOF(type) __alignof__(type)
 #endif
 
+// Annotate a function whose body uses instructions beyond the baseline ISA,
+// such as an AVX2 kernel picked at runtime after a CPU check. MSVC accepts
+// the intrinsics without a switch, GCC and clang need the target attribute.
+// Use like:
+//   TARGET_ISA("avx2") size_t FindAVX2(const char* s, size_t n);
+#if defined(COMPILER_GCC)
+#define TARGET_ISA(isa) __attribute__((target(isa)))
+#else
+#define TARGET_ISA(isa)
+#endif
+
 // Annotate a virtual method indicating it must be overriding a virtual
 // method in the parent class.
 // Use like:
@@ -186,7 +208,6 @@
 // Disable: 4251 4275
 #if defined(COMPILER_MSVC)
 #pragma warning(disable:4251 4275)
-#elif
 #endif
 
 #endif  // !#define (UTILS_COMPILER_INCLUDE_H_ )
\ No newline at end of file
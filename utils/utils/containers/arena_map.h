@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_ARENA_MAP_INCLUDE_H_
+#define UTILS_CONTAINERS_ARENA_MAP_INCLUDE_H_
+
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
+
+#include "utils/arena.h"
+
+namespace utils {
+
+// A std::map whose nodes, keys and values included, are allocated from an
+// Arena it holds, for the std::map<K, V*> plus DeletePairPointers() pattern:
+// the values live in the nodes, insertion costs no heap call, and the
+// destructor frees everything with one heap call per arena block. When both
+// |Key| and |Value| are trivially destructible the nodes are not even walked.
+// Erased nodes are destroyed but their memory is only reclaimed by clear()
+// or the destructor, so the map suits tables that mostly grow.
+// Example:
+//   utils::ArenaMap<int, Record> records;
+//   records[id].count++;
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class ArenaMap {
+public:
+    typedef std::map<Key, Value, Compare, ArenaAllocator<std::pair<const Key, Value>>> Map;
+    typedef typename Map::value_type value_type;
+    typedef typename Map::iterator iterator;
+    typedef typename Map::const_iterator const_iterator;
+
+    explicit ArenaMap(size_t block_size = Arena::kDefaultBlockSize) : arena_(block_size) { Create(); }
+    ~ArenaMap() { Destroy(); }
+
+    Value& operator[](const Key& key) { return (*map_)[key]; }
+    Value& operator[](Key&& key) { return (*map_)[std::move(key)]; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return map_->emplace(std::forward<Args>(args)...); }
+    std::pair<iterator, bool> insert(const value_type& value) { return map_->insert(value); }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return map_->try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    iterator find(const Key& key) { return map_->find(key); }
+    const_iterator find(const Key& key) const { return map_->find(key); }
+    size_t count(const Key& key) const { return map_->count(key); }
+    iterator lower_bound(const Key& key) { return map_->lower_bound(key); }
+    const_iterator lower_bound(const Key& key) const { return map_->lower_bound(key); }
+
+    iterator erase(const_iterator position) { return map_->erase(position); }
+    size_t erase(const Key& key) { return map_->erase(key); }
+
+    // Destroys every element and frees the arena blocks.
+    void clear() {
+        Destroy();
+        arena_.Reset();
+        Create();
+    }
+
+    iterator begin() { return map_->begin(); }
+    iterator end() { return map_->end(); }
+    const_iterator begin() const { return map_->begin(); }
+    const_iterator end() const { return map_->end(); }
+    size_t size() const { return map_->size(); }
+    bool empty() const { return map_->empty(); }
+
+    const Map& map() const { return *map_; }
+    const Arena& arena() const { return arena_; }
+
+private:
+    void Create() {
+        map_ = new (arena_.Allocate(sizeof(Map), alignof(Map))) Map(ArenaAllocator<value_type>(&arena_));
+    }
+
+    // The map's destructor would visit every node just to call destructors
+    // that do nothing and a deallocate() that does nothing, so it is skipped
+    // when the elements are trivially destructible.
+    void Destroy() {
+        if (std::is_trivially_destructible<Key>::value && std::is_trivially_destructible<Value>::value) return;
+        map_->~Map();
+    }
+
+    Arena arena_;
+    Map* map_;
+
+    DISALLOW_COPY_AND_ASSIGN(ArenaMap);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_ARENA_MAP_INCLUDE_H_
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_ARENA_VECTOR_INCLUDE_H_
+#define UTILS_CONTAINERS_ARENA_VECTOR_INCLUDE_H_
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utils/arena.h"
+
+namespace utils {
+
+// A vector of pointers to objects it owns, for the std::vector<T*> plus
+// DeletePointer() pattern. The objects are constructed in an Arena the
+// vector holds, so adding one is a pointer bump rather than a heap call, and
+// the destructor frees them all with one heap call per arena block. Their
+// destructors are run first, in reverse order of creation, unless |T| is
+// trivially destructible, in which case nothing is visited at all.
+//
+// Iterating gives the T* pointers, like the std::vector<T*> it replaces. The
+// objects never move, so the pointers stay valid until the object is erased
+// or the vector is cleared or destroyed.
+// Example:
+//   utils::ArenaVector<Node> nodes;
+//   Node* root = nodes.emplace_back("root");
+//   for (Node* node : nodes) ...
+template <typename T>
+class ArenaVector {
+public:
+    typedef T* value_type;
+    typedef typename std::vector<T*>::const_iterator iterator;
+    typedef typename std::vector<T*>::const_iterator const_iterator;
+    typedef typename std::vector<T*>::const_reverse_iterator reverse_iterator;
+    typedef typename std::vector<T*>::const_reverse_iterator const_reverse_iterator;
+
+    explicit ArenaVector(size_t block_size = Arena::kDefaultBlockSize) : arena_(block_size) {}
+    ~ArenaVector() { DestroyAll(); }
+
+    template <typename... Args>
+    T* emplace_back(Args&&... args) {
+        T* object = new (arena_.Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        elements_.push_back(object);
+        return object;
+    }
+    T* push_back(const T& value) { return emplace_back(value); }
+    T* push_back(T&& value) { return emplace_back(std::move(value)); }
+
+    // Destroys the object at |position|. Its memory is reclaimed only by
+    // clear() or the destructor.
+    iterator erase(const_iterator position) {
+        (*position)->~T();
+        return elements_.erase(position);
+    }
+
+    // Destroys every object and frees the arena blocks.
+    void clear() {
+        DestroyAll();
+        elements_.clear();
+        arena_.Reset();
+    }
+
+    void reserve(size_t capacity) { elements_.reserve(capacity); }
+
+    const_iterator begin() const { return elements_.begin(); }
+    const_iterator end() const { return elements_.end(); }
+    const_reverse_iterator rbegin() const { return elements_.rbegin(); }
+    const_reverse_iterator rend() const { return elements_.rend(); }
+    T* operator[](size_t i) const { return elements_[i]; }
+    T* front() const { return elements_.front(); }
+    T* back() const { return elements_.back(); }
+    size_t size() const { return elements_.size(); }
+    bool empty() const { return elements_.empty(); }
+
+    const Arena& arena() const { return arena_; }
+
+private:
+    void DestroyAll() {
+        if (std::is_trivially_destructible<T>::value) return;
+        for (auto it = elements_.rbegin(); it != elements_.rend(); ++it) (*it)->~T();
+    }
+
+    Arena arena_;
+    std::vector<T*> elements_;
+
+    DISALLOW_COPY_AND_ASSIGN(ArenaVector);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_ARENA_VECTOR_INCLUDE_H_
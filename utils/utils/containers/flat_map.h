@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_FLAT_MAP_INCLUDE_H_
+#define UTILS_CONTAINERS_FLAT_MAP_INCLUDE_H_
+
+#include <stdexcept>
+#include <tuple>
+
+#include "utils/containers/flat_tree.h"
+
+namespace utils {
+
+namespace internal {
+
+struct GetKeyFromValuePairFirst {
+    template <typename Key, typename Mapped>
+    const Key& operator()(const std::pair<Key, Mapped>& value) const { return value.first; }
+};
+
+} // namespace internal
+
+// A std::map-like container over a sorted std::vector of pairs; see
+// flat_tree.h for the costs. Unlike std::map the key of an element is not
+// const, since the vector moves elements around, and iterators and
+// references are invalidated by every insertion and erasure.
+// Example:
+//   utils::flat_map<int, std::string> names({ { 404, "Not Found" }, { 200, "OK" } });
+//   auto it = names.find(status);
+template <typename Key, typename Mapped, typename Compare = std::less<>>
+class flat_map : public internal::flat_tree<Key, std::pair<Key, Mapped>, internal::GetKeyFromValuePairFirst, Compare> {
+    typedef internal::flat_tree<Key, std::pair<Key, Mapped>, internal::GetKeyFromValuePairFirst, Compare> tree;
+
+public:
+    typedef Mapped mapped_type;
+    typedef typename tree::value_type value_type;
+    typedef typename tree::iterator iterator;
+
+    using tree::tree;
+
+    Mapped& operator[](const Key& key) { return try_emplace(key).first->second; }
+    Mapped& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    Mapped& at(const Key& key) { return CheckedMapped(tree::Find(key)); }
+    const Mapped& at(const Key& key) const { return CheckedMapped(tree::Find(key)); }
+    template <typename K, typename C = Compare, typename = internal::TransparentCompare<C>>
+    Mapped& at(const K& key) { return CheckedMapped(tree::Find(key)); }
+    template <typename K, typename C = Compare, typename = internal::TransparentCompare<C>>
+    const Mapped& at(const K& key) const { return CheckedMapped(tree::Find(key)); }
+
+    // Constructs the mapped value from |args| only if |key| is absent.
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return TryEmplace(key, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return TryEmplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& mapped) {
+        return InsertOrAssign(key, std::forward<M>(mapped));
+    }
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& mapped) {
+        return InsertOrAssign(std::move(key), std::forward<M>(mapped));
+    }
+
+    void swap(flat_map& other) { tree::swap(other); }
+
+private:
+    Mapped& CheckedMapped(iterator it) {
+        if (it == tree::end()) throw std::out_of_range("flat_map::at");
+        return it->second;
+    }
+    const Mapped& CheckedMapped(typename tree::const_iterator it) const {
+        if (it == tree::end()) throw std::out_of_range("flat_map::at");
+        return it->second;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+        iterator it = tree::LowerBound(key);
+        if (it != tree::end() && !tree::compare_(key, it->first)) return std::make_pair(it, false);
+        it = tree::elements_.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::make_pair(it, true);
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> InsertOrAssign(K&& key, M&& mapped) {
+        auto result = TryEmplace(std::forward<K>(key), std::forward<M>(mapped));
+        if (!result.second) result.first->second = std::forward<M>(mapped);
+        return result;
+    }
+};
+
+template <typename Key, typename Mapped, typename Compare>
+void swap(flat_map<Key, Mapped, Compare>& a, flat_map<Key, Mapped, Compare>& b) { a.swap(b); }
+
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_FLAT_MAP_INCLUDE_H_
@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_FLAT_SET_INCLUDE_H_
+#define UTILS_CONTAINERS_FLAT_SET_INCLUDE_H_
+
+#include "utils/containers/flat_tree.h"
+
+namespace utils {
+
+namespace internal {
+
+struct GetKeyFromValueIdentity {
+    template <typename Key>
+    const Key& operator()(const Key& key) const { return key; }
+};
+
+} // namespace internal
+
+// A std::set-like container over a sorted std::vector; see flat_tree.h for
+// the costs. Iterators and references are invalidated by every insertion and
+// erasure. The default std::less<> lets std::string sets be searched with a
+// string_view or a literal.
+// Example:
+//   const utils::flat_set<std::string> kReservedNames = { "CON", "PRN", "AUX", "NUL" };
+//   if (ContainsKey(kReservedNames, name)) ...
+template <typename Key, typename Compare = std::less<>>
+class flat_set : public internal::flat_tree<Key, Key, internal::GetKeyFromValueIdentity, Compare> {
+    typedef internal::flat_tree<Key, Key, internal::GetKeyFromValueIdentity, Compare> tree;
+
+public:
+    using tree::tree;
+
+    void swap(flat_set& other) { tree::swap(other); }
+};
+
+template <typename Key, typename Compare>
+void swap(flat_set<Key, Compare>& a, flat_set<Key, Compare>& b) { a.swap(b); }
+
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_FLAT_SET_INCLUDE_H_
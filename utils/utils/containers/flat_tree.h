@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_FLAT_TREE_INCLUDE_H_
+#define UTILS_CONTAINERS_FLAT_TREE_INCLUDE_H_
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Passed to the flat_map and flat_set constructors that adopt elements the
+// caller already knows are sorted and free of duplicate keys.
+struct sorted_unique_t {
+    constexpr sorted_unique_t() = default;
+};
+constexpr sorted_unique_t sorted_unique;
+
+namespace internal {
+
+// Returns the first position in [first, first + count) whose element is not
+// less than |key|. The loop halves the range with a conditional move instead
+// of a branch on the comparison, so it costs the same log2(n) steps for every
+// key and never mispredicts.
+template <typename Iterator, typename Key, typename Compare>
+Iterator BranchlessLowerBound(Iterator first, size_t count, const Key& key, const Compare& compare) {
+    while (count > 1) {
+        const size_t half = count / 2;
+        first = compare(first[half - 1], key) ? first + half : first;
+        count -= half;
+    }
+    return first + (count == 1 && compare(*first, key));
+}
+
+// Names the is_transparent member of |Compare|. The lookups that take keys of
+// another type default a template argument to it, so they drop out of
+// overload resolution for a Compare that has none.
+template <typename Compare>
+using TransparentCompare = typename Compare::is_transparent;
+
+// The sorted vector behind flat_map and flat_set. |GetKey| returns the key of
+// a |Value|. Lookups are binary searches over contiguous memory, so a read
+// touches log2(n) cache lines at most, against one node per level for
+// std::map; inserting or erasing shifts the elements after the position, so
+// the containers suit tables that are built once and then mostly read.
+template <typename Key, typename Value, typename GetKey, typename Compare>
+class flat_tree {
+public:
+    typedef Key key_type;
+    typedef Value value_type;
+    typedef Compare key_compare;
+    typedef std::vector<Value> container_type;
+    typedef typename container_type::size_type size_type;
+    typedef typename container_type::difference_type difference_type;
+    typedef typename container_type::reference reference;
+    typedef typename container_type::const_reference const_reference;
+    typedef typename container_type::iterator iterator;
+    typedef typename container_type::const_iterator const_iterator;
+    typedef typename container_type::reverse_iterator reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+    // Orders values by their keys.
+    struct value_compare {
+        bool operator()(const Value& a, const Value& b) const { return compare(GetKey()(a), GetKey()(b)); }
+        Compare compare;
+    };
+
+    flat_tree() = default;
+    explicit flat_tree(const Compare& compare) : compare_(compare) {}
+
+    // Bulk construction: the elements are sorted once and duplicates dropped,
+    // keeping the first of each key, instead of being inserted one by one.
+    // Input that is already sorted is detected and not sorted again.
+    template <typename InputIterator>
+    flat_tree(InputIterator first, InputIterator last, const Compare& compare = Compare())
+        : elements_(first, last), compare_(compare) {
+        SortAndUnique();
+    }
+    flat_tree(container_type elements, const Compare& compare = Compare())
+        : elements_(std::move(elements)), compare_(compare) {
+        SortAndUnique();
+    }
+    flat_tree(std::initializer_list<Value> list, const Compare& compare = Compare())
+        : flat_tree(list.begin(), list.end(), compare) {}
+    flat_tree(sorted_unique_t, container_type elements, const Compare& compare = Compare())
+        : elements_(std::move(elements)), compare_(compare) {}
+
+    flat_tree& operator=(std::initializer_list<Value> list) {
+        elements_.assign(list.begin(), list.end());
+        SortAndUnique();
+        return *this;
+    }
+
+    iterator begin() { return elements_.begin(); }
+    iterator end() { return elements_.end(); }
+    const_iterator begin() const { return elements_.begin(); }
+    const_iterator end() const { return elements_.end(); }
+    const_iterator cbegin() const { return elements_.cbegin(); }
+    const_iterator cend() const { return elements_.cend(); }
+    reverse_iterator rbegin() { return elements_.rbegin(); }
+    reverse_iterator rend() { return elements_.rend(); }
+    const_reverse_iterator rbegin() const { return elements_.rbegin(); }
+    const_reverse_iterator rend() const { return elements_.rend(); }
+
+    bool empty() const { return elements_.empty(); }
+    size_type size() const { return elements_.size(); }
+    size_type capacity() const { return elements_.capacity(); }
+    void reserve(size_type capacity) { elements_.reserve(capacity); }
+    void shrink_to_fit() { elements_.shrink_to_fit(); }
+    void clear() { elements_.clear(); }
+
+    key_compare key_comp() const { return compare_; }
+    value_compare value_comp() const { return value_compare{ compare_ }; }
+
+    // The sorted elements. Handing them out with extract() leaves the tree
+    // empty; replace() adopts a vector that must be sorted and unique.
+    const container_type& elements() const { return elements_; }
+    container_type extract() && { return std::move(elements_); }
+    void replace(container_type&& elements) { elements_ = std::move(elements); }
+
+    // The lookups take a key_type. When |Compare| is transparent, as the
+    // default std::less<> is, they also take any |K| it can order against the
+    // keys, like std::map does, so a flat_map<std::string, T> is searched with
+    // a string_view without building a std::string. Any other |Compare| sees
+    // only keys, and an argument of another type converts once up front.
+    iterator lower_bound(const key_type& key) { return LowerBound(key); }
+    const_iterator lower_bound(const key_type& key) const { return LowerBound(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    iterator lower_bound(const K& key) { return LowerBound(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    const_iterator lower_bound(const K& key) const { return LowerBound(key); }
+
+    iterator upper_bound(const key_type& key) { return UpperBound(key); }
+    const_iterator upper_bound(const key_type& key) const { return UpperBound(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    iterator upper_bound(const K& key) { return UpperBound(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    const_iterator upper_bound(const K& key) const { return UpperBound(key); }
+
+    iterator find(const key_type& key) { return Find(key); }
+    const_iterator find(const key_type& key) const { return Find(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    iterator find(const K& key) { return Find(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    const_iterator find(const K& key) const { return Find(key); }
+
+    std::pair<iterator, iterator> equal_range(const key_type& key) { return EqualRange(key); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const { return EqualRange(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    std::pair<iterator, iterator> equal_range(const K& key) { return EqualRange(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const { return EqualRange(key); }
+
+    size_type count(const key_type& key) const { return Find(key) != end() ? 1 : 0; }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    size_type count(const K& key) const { return Find(key) != end() ? 1 : 0; }
+    bool contains(const key_type& key) const { return Find(key) != end(); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    bool contains(const K& key) const { return Find(key) != end(); }
+
+    // Inserts |value| unless its key is present. Returns the position of the
+    // element with the key and whether |value| was inserted.
+    std::pair<iterator, bool> insert(const Value& value) { return Emplace(value); }
+    std::pair<iterator, bool> insert(Value&& value) { return Emplace(std::move(value)); }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return Emplace(Value(std::forward<Args>(args)...)); }
+
+    // Appends the range, sorts just the new elements and merges the two runs,
+    // which costs O(n + m log m) rather than a shift per element. Keys already
+    // present win over the new ones.
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        const size_type old_size = elements_.size();
+        elements_.insert(elements_.end(), first, last);
+        const iterator middle = elements_.begin() + old_size;
+        const value_compare compare = value_comp();
+        std::stable_sort(middle, elements_.end(), compare);
+        std::inplace_merge(elements_.begin(), middle, elements_.end(), compare);
+        Unique();
+    }
+    void insert(std::initializer_list<Value> list) { insert(list.begin(), list.end()); }
+
+    iterator erase(iterator position) { return elements_.erase(position); }
+    iterator erase(const_iterator position) { return elements_.erase(position); }
+    iterator erase(const_iterator first, const_iterator last) { return elements_.erase(first, last); }
+    size_type erase(const key_type& key) { return Erase(key); }
+    template <typename K, typename C = Compare, typename = TransparentCompare<C>>
+    size_type erase(const K& key) { return Erase(key); }
+
+    void swap(flat_tree& other) {
+        elements_.swap(other.elements_);
+        std::swap(compare_, other.compare_);
+    }
+
+    friend bool operator==(const flat_tree& a, const flat_tree& b) { return a.elements_ == b.elements_; }
+    friend bool operator!=(const flat_tree& a, const flat_tree& b) { return a.elements_ != b.elements_; }
+    friend bool operator<(const flat_tree& a, const flat_tree& b) { return a.elements_ < b.elements_; }
+
+protected:
+    // Compares an element against a bare key in either order.
+    struct KeyValueCompare {
+        bool operator()(const Value& a, const Value& b) const { return compare(GetKey()(a), GetKey()(b)); }
+        template <typename K>
+        bool operator()(const Value& value, const K& key) const { return compare(GetKey()(value), key); }
+        template <typename K>
+        bool operator()(const K& key, const Value& value) const { return compare(key, GetKey()(value)); }
+        Compare compare;
+    };
+
+    KeyValueCompare key_value_comp() const { return KeyValueCompare{ compare_ }; }
+
+    template <typename K>
+    iterator LowerBound(const K& key) {
+        return BranchlessLowerBound(elements_.begin(), elements_.size(), key, key_value_comp());
+    }
+    template <typename K>
+    const_iterator LowerBound(const K& key) const {
+        return BranchlessLowerBound(elements_.begin(), elements_.size(), key, key_value_comp());
+    }
+    template <typename K>
+    iterator UpperBound(const K& key) {
+        return std::upper_bound(elements_.begin(), elements_.end(), key, key_value_comp());
+    }
+    template <typename K>
+    const_iterator UpperBound(const K& key) const {
+        return std::upper_bound(elements_.begin(), elements_.end(), key, key_value_comp());
+    }
+    template <typename K>
+    iterator Find(const K& key) {
+        iterator it = LowerBound(key);
+        return it != end() && !compare_(key, GetKey()(*it)) ? it : end();
+    }
+    template <typename K>
+    const_iterator Find(const K& key) const {
+        const_iterator it = LowerBound(key);
+        return it != end() && !compare_(key, GetKey()(*it)) ? it : end();
+    }
+    template <typename K>
+    std::pair<iterator, iterator> EqualRange(const K& key) {
+        iterator it = LowerBound(key);
+        return std::make_pair(it, it == end() || compare_(key, GetKey()(*it)) ? it : std::next(it));
+    }
+    template <typename K>
+    std::pair<const_iterator, const_iterator> EqualRange(const K& key) const {
+        const_iterator it = LowerBound(key);
+        return std::make_pair(it, it == end() || compare_(key, GetKey()(*it)) ? it : std::next(it));
+    }
+    template <typename K>
+    size_type Erase(const K& key) {
+        const_iterator it = Find(key);
+        if (it == end()) return 0;
+        elements_.erase(it);
+        return 1;
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> Emplace(V&& value) {
+        iterator it = lower_bound(GetKey()(value));
+        if (it != end() && !compare_(GetKey()(value), GetKey()(*it))) return std::make_pair(it, false);
+        return std::make_pair(elements_.insert(it, std::forward<V>(value)), true);
+    }
+
+    void SortAndUnique() {
+        const value_compare compare = value_comp();
+        if (!std::is_sorted(elements_.begin(), elements_.end(), compare))
+            std::stable_sort(elements_.begin(), elements_.end(), compare);
+        Unique();
+    }
+
+    // Drops all but the first of each run of equal keys in the sorted
+    // elements.
+    void Unique() {
+        const value_compare compare = value_comp();
+        elements_.erase(std::unique(elements_.begin(), elements_.end(),
+                                    [&compare](const Value& a, const Value& b) { return !compare(a, b); }),
+                        elements_.end());
+    }
+
+    container_type elements_;
+    Compare compare_;
+};
+
+} // namespace internal
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_FLAT_TREE_INCLUDE_H_
@@ -0,0 +1,141 @@
+#include <Windows.h>
+#include "utils/containers/flat_map.h"
+#include "utils/containers/flat_set.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+#ifdef TEST
+
+namespace {
+
+// Orders std::strings and fails on anything else, to check that the lookups
+// of a tree whose Compare is not transparent hand it only keys.
+struct KeysOnlyLess {
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+    template <typename A, typename B>
+    bool operator()(const A&, const B&) const {
+        __debugbreak();
+        return false;
+    }
+};
+
+}  // namespace
+
+int FLAT_TREE_TEST(void) {
+    // Bulk construction sorts and keeps the first of each key.
+    utils::flat_map<int, std::string> codes({ { 404, "Not Found" }, { 200, "OK" }, { 404, "Missing" }, { 500, "Error" } });
+    if (codes.size() != 3 || codes.begin()->first != 200 || codes.at(404) != "Not Found") __debugbreak();
+    if (!codes.try_emplace(301, "Moved").second || codes.try_emplace(301, "Other").second) __debugbreak();
+    codes.insert_or_assign(500, "Internal Server Error");
+    codes[418] = "Teapot";
+    if (codes.size() != 5 || codes[500] != "Internal Server Error" || codes.find(302) != codes.end()) __debugbreak();
+    if (codes.erase(301) != 1 || codes.erase(301) != 0 || codes.lower_bound(300)->first != 404) __debugbreak();
+    if (codes.equal_range(405).first != codes.equal_range(405).second || codes.equal_range(404).second->first != 418)
+        __debugbreak();
+
+    // Lookups with the default std::less<> take views without a std::string.
+    utils::flat_set<std::string> names = { "PRN", "CON", "AUX", "NUL", "CON" };
+    const std::string_view aux = "AUX";
+    if (names.size() != 4 || !names.contains(aux) || names.count("LPT1") || *names.begin() != "AUX") __debugbreak();
+    names.insert({ "COM1", "NUL", "LPT1" });
+    if (names.size() != 6 || !std::is_sorted(names.begin(), names.end())) __debugbreak();
+
+    // Any other Compare sees only keys; a literal converts once per lookup.
+    utils::flat_map<std::string, int, KeysOnlyLess> ports({ { "http", 80 }, { "https", 443 } });
+    if (ports.at("https") != 443 || ports.count("ftp") || !ports.contains("http") || ports.find("gopher") != ports.end())
+        __debugbreak();
+    if (ports.lower_bound("httpa")->first != "https" || ports.upper_bound("http")->first != "https") __debugbreak();
+    if (!ports.try_emplace("ftp", 21).second || ports.equal_range("ftp").first->second != 21) __debugbreak();
+    ports.insert_or_assign("ftp", 20);
+    if (ports["ftp"] != 20 || ports.erase("ftp") != 1 || ports.size() != 2) __debugbreak();
+
+    // The branchless search against std::lower_bound at every size and key.
+    for (int size = 0; size < 40; ++size) {
+        std::vector<int> values;
+        for (int i = 0; i < size; ++i) values.push_back(i * 3);
+        const utils::flat_set<int> set(utils::sorted_unique, values);
+        for (int key = -1; key <= size * 3 + 1; ++key) {
+            if (set.lower_bound(key) - set.begin() != std::lower_bound(values.begin(), values.end(), key) - values.begin())
+                __debugbreak();
+            if (set.contains(key) != (key >= 0 && key % 3 == 0 && key < size * 3)) __debugbreak();
+        }
+    }
+
+    // Random inserts, erases and range inserts against std::map.
+    std::mt19937 random(14);
+    std::map<int, int> reference;
+    utils::flat_map<int, int> flat;
+    for (int i = 0; i < 5000; ++i) {
+        const int key = random() % 500;
+        switch (random() % 3) {
+        case 0: if (flat.insert(std::make_pair(key, i)).second != reference.insert(std::make_pair(key, i)).second) __debugbreak(); break;
+        case 1: if (flat.erase(key) != reference.erase(key)) __debugbreak(); break;
+        case 2: {
+            std::vector<std::pair<int, int>> batch = { { key, i }, { key + 7, i }, { key, -i } };
+            flat.insert(batch.begin(), batch.end());
+            reference.insert(batch.begin(), batch.end());
+        }
+        }
+    }
+    if (flat.elements() != std::vector<std::pair<int, int>>(reference.begin(), reference.end())) __debugbreak();
+
+    // The stl_util helpers.
+    const utils::flat_set<int> a = { 1, 2, 3, 5, 8, 13 };
+    const utils::flat_set<int> b = { 2, 3, 4, 13 };
+    if (!std::ContainsKey(a, 8) || std::ContainsKey(b, 8) || !std::Sorted(a)) __debugbreak();
+    if (std::Difference<utils::flat_set<int>>(a, b) != utils::flat_set<int>({ 1, 5, 8 })) __debugbreak();
+    if (std::Difference<std::set<int>>(a, b) != std::set<int>({ 1, 5, 8 })) __debugbreak();
+    if (*std::Next(codes, 200) != *codes.find(404) || std::Next(codes, 500) != codes.begin()) __debugbreak();
+    return 0;
+}
+
+// Looks up 4M random keys in a table of 100000 and takes the difference of
+// two 1M-element sets, with std::map/std::set and with flat_map/flat_set, and
+// prints the time each takes.
+int FLAT_TREE_BENCHMARK(void) {
+    const int kKeys = 100000;
+    const int kLookups = 4000000;
+    std::mt19937 random(7);
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < kKeys; ++i) pairs.push_back(std::make_pair(static_cast<int>(random()), i));
+    const std::map<int, int> tree(pairs.begin(), pairs.end());
+    const utils::flat_map<int, int> flat(pairs.begin(), pairs.end());
+    std::vector<int> keys;
+    for (int i = 0; i < kLookups; ++i) keys.push_back(i % 2 ? pairs[random() % kKeys].first : static_cast<int>(random()));
+
+    long long found = 0;
+    auto tree_lookup = TimeMicroseconds([&]() {
+        for (int key : keys) {
+            auto it = tree.find(key);
+            if (it != tree.end()) found += it->second;
+        }
+    });
+    auto flat_lookup = TimeMicroseconds([&]() {
+        for (int key : keys) {
+            auto it = flat.find(key);
+            if (it != flat.end()) found -= it->second;
+        }
+    });
+
+    std::vector<int> left, right;
+    for (int i = 0; i < 1000000; ++i) {
+        left.push_back(i * 2);
+        right.push_back(i * 3);
+    }
+    const std::set<int> tree_left(left.begin(), left.end()), tree_right(right.begin(), right.end());
+    const utils::flat_set<int> flat_left(left), flat_right(right);
+    size_t size = 0;
+    auto tree_difference = TimeMicroseconds([&]() { size += std::Difference<std::set<int>>(tree_left, tree_right).size(); });
+    auto flat_difference = TimeMicroseconds([&]() { size -= std::Difference<utils::flat_set<int>>(flat_left, flat_right).size(); });
+
+    std::cout << "Lookup: std::map " << tree_lookup << "us, flat_map " << flat_lookup << "us" << std::endl;
+    std::cout << "Difference: std::set " << tree_difference << "us, flat_set " << flat_difference << "us" << std::endl;
+    return found == 0 && size == 0 ? 0 : 1;
+}
+
+#endif // TEST
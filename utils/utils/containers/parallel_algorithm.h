@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CONTAINERS_PARALLEL_ALGORITHM_INCLUDE_H_
+#define UTILS_CONTAINERS_PARALLEL_ALGORITHM_INCLUDE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "utils/thread_pool.h"
+
+// Sorted-range algorithms split over a ThreadPool, for inputs of millions of
+// elements. All of them take random-access iterators and the same |compare|
+// the ranges are sorted by, and give the same result as the std algorithm
+// they are named after. Below kParallelMinimum elements they run on the
+// calling thread.
+namespace utils {
+
+const size_t kParallelMinimum = 1 << 16;
+
+namespace internal {
+
+// Calls |chunk|(begin, end) for |pieces| contiguous pieces of [0, |size|).
+template <typename Chunk>
+void ForEachChunk(ThreadPool& pool, size_t size, size_t pieces, const Chunk& chunk) {
+    pool.ParallelFor(pieces, [&](size_t i) { chunk(size * i / pieces, size * (i + 1) / pieces); });
+}
+
+// Returns how many of the first |diagonal| elements of the stable merge of
+// [a, a + a_size) and [b, b + b_size) come from |a|; ties go to |a| first.
+// This is the "merge path" split: cutting both ranges there lets the two
+// halves be merged independently.
+template <typename Iterator1, typename Iterator2, typename Compare>
+size_t MergePathSplit(Iterator1 a, size_t a_size, Iterator2 b, size_t b_size, size_t diagonal,
+                      const Compare& compare) {
+    size_t low = diagonal > b_size ? diagonal - b_size : 0;
+    size_t high = std::min(diagonal, a_size);
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (!compare(b[diagonal - middle - 1], a[middle])) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// The set operations also need equal elements of both ranges on the same side
+// of every cut, so the merge path split is moved back to the first element
+// equal to the one it lands on, in both ranges.
+template <typename Iterator1, typename Iterator2, typename Compare>
+std::pair<size_t, size_t> SetSplit(Iterator1 a, size_t a_size, Iterator2 b, size_t b_size, size_t diagonal,
+                                   const Compare& compare) {
+    const size_t i = MergePathSplit(a, a_size, b, b_size, diagonal, compare);
+    const size_t j = diagonal - i;
+    if (i < a_size && (j == b_size || !compare(b[j], a[i]))) {
+        return std::make_pair(std::lower_bound(a, a + i, a[i], compare) - a,
+                              std::lower_bound(b + j, b + b_size, a[i], compare) - b);
+    }
+    if (j < b_size) {
+        return std::make_pair(std::lower_bound(a, a + i, b[j], compare) - a,
+                              std::lower_bound(b, b + j, b[j], compare) - b);
+    }
+    return std::make_pair(a_size, b_size);
+}
+
+// Runs |operation|(first1, last1, first2, last2, output) over matching pieces
+// of the two ranges and concatenates the pieces into |*out|.
+template <typename Iterator1, typename Iterator2, typename T, typename Operation, typename Compare>
+void ParallelSetOperation(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2, std::vector<T>* out,
+                          const Operation& operation, const Compare& compare, ThreadPool& pool) {
+    const size_t a_size = last1 - first1;
+    const size_t b_size = last2 - first2;
+    out->clear();
+    if (a_size + b_size < kParallelMinimum || pool.size() == 1) {
+        operation(first1, last1, first2, last2, std::back_inserter(*out));
+        return;
+    }
+
+    const size_t pieces = pool.size();
+    std::vector<std::pair<size_t, size_t>> splits(pieces + 1);
+    std::vector<std::vector<T>> results(pieces);
+    pool.ParallelFor(pieces + 1, [&](size_t i) {
+        splits[i] = SetSplit(first1, a_size, first2, b_size, (a_size + b_size) * i / pieces, compare);
+    });
+    pool.ParallelFor(pieces, [&](size_t i) {
+        operation(first1 + splits[i].first, first1 + splits[i + 1].first, first2 + splits[i].second,
+                  first2 + splits[i + 1].second, std::back_inserter(results[i]));
+    });
+
+    std::vector<size_t> offsets(pieces + 1, 0);
+    for (size_t i = 0; i < pieces; ++i) offsets[i + 1] = offsets[i] + results[i].size();
+    out->resize(offsets[pieces]);
+    pool.ParallelFor(pieces, [&](size_t i) {
+        std::move(results[i].begin(), results[i].end(), out->begin() + offsets[i]);
+    });
+}
+
+} // namespace internal
+
+// Returns std::is_sorted(first, last, compare), checking pieces of the range
+// on the pool. Each piece also compares its last element with the next one.
+template <typename Iterator, typename Compare = std::less<>>
+bool ParallelIsSorted(Iterator first, Iterator last, Compare compare = Compare(),
+                      ThreadPool& pool = ThreadPool::Default()) {
+    const size_t size = last - first;
+    if (size < kParallelMinimum || pool.size() == 1) return std::is_sorted(first, last, compare);
+
+    // More pieces than threads, so an unsorted range stops early.
+    std::atomic<bool> sorted(true);
+    internal::ForEachChunk(pool, size, pool.size() * 8, [&](size_t begin, size_t end) {
+        if (sorted && !std::is_sorted(first + begin, first + std::min(end + 1, size), compare)) sorted = false;
+    });
+    return sorted;
+}
+
+// Writes std::set_difference(), std::set_intersection() or std::set_union()
+// of the two sorted ranges to |*out|. The ranges are cut at merge path
+// splits into one piece per thread, so each thread does an equal share of
+// the merge, and the pieces are then moved into |*out| in parallel.
+template <typename Iterator1, typename Iterator2, typename T, typename Compare = std::less<>>
+void ParallelSetDifference(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2, std::vector<T>* out,
+                           Compare compare = Compare(), ThreadPool& pool = ThreadPool::Default()) {
+    internal::ParallelSetOperation(first1, last1, first2, last2, out,
+        [&compare](Iterator1 a, Iterator1 a_end, Iterator2 b, Iterator2 b_end, std::back_insert_iterator<std::vector<T>> output) {
+            std::set_difference(a, a_end, b, b_end, output, compare);
+        }, compare, pool);
+}
+
+template <typename Iterator1, typename Iterator2, typename T, typename Compare = std::less<>>
+void ParallelSetIntersection(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2, std::vector<T>* out,
+                             Compare compare = Compare(), ThreadPool& pool = ThreadPool::Default()) {
+    internal::ParallelSetOperation(first1, last1, first2, last2, out,
+        [&compare](Iterator1 a, Iterator1 a_end, Iterator2 b, Iterator2 b_end, std::back_insert_iterator<std::vector<T>> output) {
+            std::set_intersection(a, a_end, b, b_end, output, compare);
+        }, compare, pool);
+}
+
+template <typename Iterator1, typename Iterator2, typename T, typename Compare = std::less<>>
+void ParallelSetUnion(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2, std::vector<T>* out,
+                      Compare compare = Compare(), ThreadPool& pool = ThreadPool::Default()) {
+    internal::ParallelSetOperation(first1, last1, first2, last2, out,
+        [&compare](Iterator1 a, Iterator1 a_end, Iterator2 b, Iterator2 b_end, std::back_insert_iterator<std::vector<T>> output) {
+            std::set_union(a, a_end, b, b_end, output, compare);
+        }, compare, pool);
+}
+
+// Sorts |*values| and drops all but the first of each run of equal elements,
+// like the bulk construction of flat_set. One piece per thread is sorted,
+// the sorted runs are merged pairwise with every round split over all the
+// threads at merge path cuts, and the duplicates are dropped by counting the
+// survivors of each piece and then moving them to their place in parallel.
+template <typename T, typename Compare = std::less<>>
+void ParallelSortAndUnique(std::vector<T>* values, Compare compare = Compare(),
+                           ThreadPool& pool = ThreadPool::Default()) {
+    const size_t size = values->size();
+    const size_t pieces = pool.size();
+    if (size < kParallelMinimum || pieces == 1) {
+        std::stable_sort(values->begin(), values->end(), compare);
+        values->erase(std::unique(values->begin(), values->end(),
+                                  [&compare](const T& a, const T& b) { return !compare(a, b); }),
+                      values->end());
+        return;
+    }
+
+    std::vector<size_t> runs(pieces + 1);
+    for (size_t i = 0; i <= pieces; ++i) runs[i] = size * i / pieces;
+    pool.ParallelFor(pieces, [&](size_t i) {
+        std::stable_sort(values->begin() + runs[i], values->begin() + runs[i + 1], compare);
+    });
+
+    std::vector<T> buffer(size);
+    while (runs.size() > 2) {
+        // Each pair of runs [runs[2k], runs[2k + 1]) and [runs[2k + 1],
+        // runs[2k + 2]) is merged into the buffer in |pieces| parts; an odd
+        // run at the end is copied across. The merges move elements out of
+        // the runs, so every cut is found before any part is merged.
+        const size_t pairs = (runs.size() - 1) / 2;
+        std::vector<size_t> splits(pairs * (pieces + 1));
+        pool.ParallelFor(splits.size(), [&](size_t task) {
+            const size_t pair = task / (pieces + 1);
+            const size_t part = task % (pieces + 1);
+            const size_t a_size = runs[2 * pair + 1] - runs[2 * pair];
+            const size_t b_size = runs[2 * pair + 2] - runs[2 * pair + 1];
+            splits[task] = internal::MergePathSplit(values->begin() + runs[2 * pair], a_size,
+                                                    values->begin() + runs[2 * pair + 1], b_size,
+                                                    (a_size + b_size) * part / pieces, compare);
+        });
+        pool.ParallelFor(pairs * pieces + 1, [&](size_t task) {
+            if (task == pairs * pieces) {
+                if ((runs.size() - 1) % 2) {
+                    std::move(values->begin() + runs[runs.size() - 2], values->end(),
+                              buffer.begin() + runs[runs.size() - 2]);
+                }
+                return;
+            }
+            const size_t pair = task / pieces;
+            const size_t part = task % pieces;
+            const auto a = values->begin() + runs[2 * pair];
+            const auto b = values->begin() + runs[2 * pair + 1];
+            const size_t total = runs[2 * pair + 2] - runs[2 * pair];
+            const size_t begin = total * part / pieces;
+            const size_t end = total * (part + 1) / pieces;
+            const size_t a_begin = splits[pair * (pieces + 1) + part];
+            const size_t a_end = splits[pair * (pieces + 1) + part + 1];
+            std::merge(std::make_move_iterator(a + a_begin), std::make_move_iterator(a + a_end),
+                       std::make_move_iterator(b + (begin - a_begin)), std::make_move_iterator(b + (end - a_end)),
+                       buffer.begin() + runs[2 * pair] + begin, compare);
+        });
+        values->swap(buffer);
+
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < runs.size(); i += 2) merged.push_back(runs[i]);
+        if (merged.back() != size) merged.push_back(size);
+        runs.swap(merged);
+    }
+
+    // An element survives unless it equals the one before it. The last
+    // element of a piece is compared by the next piece too, so every flag is
+    // set before anything is moved.
+    std::vector<unsigned char> keep(size);
+    std::vector<size_t> offsets(pieces + 1, 0);
+    pool.ParallelFor(pieces, [&](size_t i) {
+        size_t kept = 0;
+        for (size_t k = size * i / pieces; k < size * (i + 1) / pieces; ++k) {
+            keep[k] = k == 0 || compare((*values)[k - 1], (*values)[k]);
+            kept += keep[k];
+        }
+        offsets[i + 1] = kept;
+    });
+    for (size_t i = 0; i < pieces; ++i) offsets[i + 1] += offsets[i];
+    buffer.resize(offsets[pieces]);
+    pool.ParallelFor(pieces, [&](size_t i) {
+        size_t out = offsets[i];
+        const size_t end = size * (i + 1) / pieces;
+        for (size_t k = size * i / pieces; k < end; ++k) {
+            if (keep[k]) buffer[out++] = std::move((*values)[k]);
+        }
+    });
+    values->swap(buffer);
+}
+
+} // namespace utils
+
+#endif  // !UTILS_CONTAINERS_PARALLEL_ALGORITHM_INCLUDE_H_
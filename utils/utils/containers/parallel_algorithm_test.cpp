@@ -0,0 +1,156 @@
+#include <Windows.h>
+#include "utils/containers/flat_set.h"
+#include "utils/containers/parallel_algorithm.h"
+#include "utils/stl_util_parallel.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// Sorted values in [0, |range|), with repeats when |range| is small.
+std::vector<int> SortedValues(std::mt19937& random, size_t size, int range) {
+    std::vector<int> values(size);
+    for (int& value : values) value = static_cast<int>(random() % range);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+}  // namespace
+
+int PARALLEL_ALGORITHM_TEST(void) {
+    utils::ThreadPool pool(4);
+    std::vector<std::atomic<int>> calls(1000);
+    pool.ParallelFor(calls.size(), [&calls](size_t i) { ++calls[i]; });
+    pool.ParallelFor(calls.size(), [&calls](size_t i) { ++calls[i]; });
+    for (const std::atomic<int>& count : calls) {
+        if (count != 2) __debugbreak();
+    }
+
+    // Sizes on both sides of kParallelMinimum, with and without repeats, so
+    // runs of equal elements straddle the cuts.
+    std::mt19937 random(15);
+    const size_t kSizes[] = { 0, 1, 1000, utils::kParallelMinimum, 300001 };
+    for (size_t a_size : kSizes) {
+        for (size_t b_size : kSizes) {
+            for (int range : { 50, 1 << 30 }) {
+                const std::vector<int> a = SortedValues(random, a_size, range);
+                const std::vector<int> b = SortedValues(random, b_size, range);
+                std::vector<int> expected, result;
+                std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                utils::ParallelSetDifference(a.begin(), a.end(), b.begin(), b.end(), &result, std::less<>(), pool);
+                if (result != expected) __debugbreak();
+                expected.clear();
+                std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                utils::ParallelSetIntersection(a.begin(), a.end(), b.begin(), b.end(), &result, std::less<>(), pool);
+                if (result != expected) __debugbreak();
+                expected.clear();
+                std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+                utils::ParallelSetUnion(a.begin(), a.end(), b.begin(), b.end(), &result, std::less<>(), pool);
+                if (result != expected) __debugbreak();
+            }
+        }
+    }
+
+    // One inversion anywhere, including across a piece boundary.
+    std::vector<int> sorted = SortedValues(random, 500000, 1 << 30);
+    if (!utils::ParallelIsSorted(sorted.begin(), sorted.end(), std::less<>(), pool)) __debugbreak();
+    for (size_t position : { size_t(0), size_t(15624), size_t(15625), size_t(250000), size_t(499998) }) {
+        std::vector<int> values = sorted;
+        values[position] = values[position + 1] + 1;
+        if (utils::ParallelIsSorted(values.begin(), values.end(), std::less<>(), pool)) __debugbreak();
+    }
+
+    // Sort-and-unique keeps the first of each key, like std::stable_sort()
+    // followed by std::unique().
+    auto by_key = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+    for (size_t size : { size_t(1000), size_t(200000), size_t(1000003) }) {
+        for (int range : { 1000, 1 << 30 }) {
+            std::vector<std::pair<int, int>> values(size);
+            for (size_t i = 0; i < size; ++i) values[i] = std::make_pair(static_cast<int>(random() % range), static_cast<int>(i));
+            std::vector<std::pair<int, int>> expected = values;
+            std::stable_sort(expected.begin(), expected.end(), by_key);
+            expected.erase(std::unique(expected.begin(), expected.end(),
+                                       [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first == b.first; }),
+                           expected.end());
+            utils::ParallelSortAndUnique(&values, by_key, pool);
+            if (values != expected) __debugbreak();
+        }
+    }
+
+    // Moving a string empties it, so a piece must not move out an element
+    // the next piece still compares against. 8 threads make short pieces
+    // and put many cuts inside runs of equal strings.
+    utils::ThreadPool wide_pool(8);
+    for (int range : { 300, 1 << 30 }) {
+        std::vector<std::string> strings(70000);
+        for (std::string& value : strings) value = "key-" + std::to_string(random() % range) + "-with-a-heap-buffer";
+        std::vector<std::string> expected = strings;
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        utils::ParallelSortAndUnique(&strings, std::less<>(), wide_pool);
+        if (strings != expected) __debugbreak();
+    }
+
+    // The stl_util helpers, on the default pool.
+    const utils::flat_set<int> a(SortedValues(random, 200000, 1 << 20));
+    const utils::flat_set<int> b(SortedValues(random, 200000, 1 << 20));
+    if (!std::ParallelSorted(a) || std::ParallelDifference<utils::flat_set<int>>(a, b) != std::Difference<utils::flat_set<int>>(a, b))
+        __debugbreak();
+    return 0;
+}
+
+// Checks, diffs and sort-uniques sets of 20M integers with the std algorithms
+// and with the parallel ones on pools of 1, 2, 4 and so on up to the number of
+// logical processors, and prints the time each takes.
+int PARALLEL_ALGORITHM_BENCHMARK(void) {
+    const size_t kSize = 20000000;
+    std::mt19937 random(7);
+    std::vector<int> unsorted(kSize);
+    for (int& value : unsorted) value = static_cast<int>(random() % (kSize * 4));
+    std::vector<int> a = unsorted, b(kSize);
+    for (int& value : b) value = static_cast<int>(random() % (kSize * 4));
+    std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    std::sort(b.begin(), b.end());
+    b.erase(std::unique(b.begin(), b.end()), b.end());
+
+    std::vector<int> expected, result;
+    bool ok = true;
+    auto check = TimeMicroseconds([&]() { ok &= std::is_sorted(a.begin(), a.end()); });
+    auto difference = TimeMicroseconds([&]() {
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    });
+    auto sort = TimeMicroseconds([&]() {
+        result = unsorted;
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    });
+    ok &= result == a;
+    std::cout << "std: is_sorted " << check << "us, set_difference " << difference << "us, sort+unique " << sort << "us"
+              << std::endl;
+
+    const size_t processors = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1;; threads = std::min(threads * 2, processors)) {
+        utils::ThreadPool pool(threads);
+        check = TimeMicroseconds([&]() { ok &= utils::ParallelIsSorted(a.begin(), a.end(), std::less<>(), pool); });
+        difference = TimeMicroseconds([&]() {
+            utils::ParallelSetDifference(a.begin(), a.end(), b.begin(), b.end(), &result, std::less<>(), pool);
+        });
+        ok &= result == expected;
+        sort = TimeMicroseconds([&]() {
+            result = unsorted;
+            utils::ParallelSortAndUnique(&result, std::less<>(), pool);
+        });
+        ok &= result == a;
+        std::cout << threads << " threads: is_sorted " << check << "us, set_difference " << difference
+                  << "us, sort+unique " << sort << "us" << std::endl;
+        if (threads == processors) break;
+    }
+    return ok ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/cpu.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#include <immintrin.h>  // For _xgetbv()
+#elif defined(COMPILER_GCC)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+void RunCpuid(int info[4], int leaf, int subleaf) {
+#if defined(COMPILER_MSVC)
+    __cpuidex(info, leaf, subleaf);
+#else
+    unsigned int regs[4] = { 0 };
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    for (int i = 0; i < 4; ++i) info[i] = static_cast<int>(regs[i]);
+#endif
+}
+
+// Reads the extended control register 0, which tells whether the OS saves
+// the XMM and YMM registers on a context switch.
+unsigned long long ReadXCR0() {
+#if defined(COMPILER_MSVC)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+}  // namespace
+
+utils::CPU::CPU() {
+    Initialize();
+}
+
+const utils::CPU& utils::CPU::Get() {
+    static const CPU cpu;
+    return cpu;
+}
+
+void utils::CPU::Initialize() {
+#if defined(ARCH_CPU_X86_FAMILY)
+    int info[4] = { 0 };
+    RunCpuid(info, 0, 0);
+    const int num_ids = info[0];
+
+    int info7[4] = { 0 };
+    if (num_ids >= 1) RunCpuid(info, 1, 0);
+    if (num_ids >= 7) RunCpuid(info7, 7, 0);
+
+    has_sse2_ = (info[3] & (1 << 26)) != 0;
+    has_sse3_ = (info[2] & (1 << 0)) != 0;
+    has_ssse3_ = (info[2] & (1 << 9)) != 0;
+    has_sse41_ = (info[2] & (1 << 19)) != 0;
+    has_sse42_ = (info[2] & (1 << 20)) != 0;
+    has_popcnt_ = (info[2] & (1 << 23)) != 0;
+
+    // AVX needs the OSXSAVE bit and the OS saving XMM|YMM, see
+    // "Detecting Availability and Support" in the Intel SDM.
+    const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 &&
+        (info[2] & (1 << 28)) != 0 && (ReadXCR0() & 6) == 6;
+    has_avx_ = os_saves_ymm;
+    has_avx2_ = os_saves_ymm && (info7[1] & (1 << 5)) != 0;
+    has_bmi1_ = (info7[1] & (1 << 3)) != 0;
+    has_bmi2_ = (info7[1] & (1 << 8)) != 0;
+
+    RunCpuid(info, 0x80000000, 0);
+    if (static_cast<unsigned int>(info[0]) >= 0x80000001) {
+        RunCpuid(info, 0x80000001, 0);
+        has_lzcnt_ = (info[2] & (1 << 5)) != 0;
+    }
+#endif  // ARCH_CPU_X86_FAMILY
+}
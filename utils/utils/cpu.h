@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_CPU_INCLUDE_H_
+#define UTILS_CPU_INCLUDE_H_
+
+#include "utils.h"
+#include "utils/compiler.h"
+
+namespace utils {
+
+// Query information about the processor. The vectorized string kernels use it
+// to pick the widest instruction set the machine really supports; everything
+// reports false on non-x86 builds so the scalar paths are taken.
+class UTILS_API CPU {
+public:
+    CPU();
+
+    bool has_sse2() const { return has_sse2_; }
+    bool has_sse3() const { return has_sse3_; }
+    bool has_ssse3() const { return has_ssse3_; }
+    bool has_sse41() const { return has_sse41_; }
+    bool has_sse42() const { return has_sse42_; }
+    bool has_popcnt() const { return has_popcnt_; }
+    // AVX and AVX2 are only reported when the OS saves the YMM state too.
+    bool has_avx() const { return has_avx_; }
+    bool has_avx2() const { return has_avx2_; }
+    bool has_bmi1() const { return has_bmi1_; }
+    bool has_bmi2() const { return has_bmi2_; }
+    bool has_lzcnt() const { return has_lzcnt_; }
+
+    // Returns the process-wide instance, detected once on first use.
+    static const CPU& Get();
+
+private:
+    void Initialize();
+
+    bool has_sse2_ = false;
+    bool has_sse3_ = false;
+    bool has_ssse3_ = false;
+    bool has_sse41_ = false;
+    bool has_sse42_ = false;
+    bool has_popcnt_ = false;
+    bool has_avx_ = false;
+    bool has_avx2_ = false;
+    bool has_bmi1_ = false;
+    bool has_bmi2_ = false;
+    bool has_lzcnt_ = false;
+};
+
+} // namespace utils
+
+#endif  // !UTILS_CPU_INCLUDE_H_
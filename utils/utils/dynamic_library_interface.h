@@ -9,9 +9,9 @@
 #ifndef UTILS_DYNAMIC_LIBRARY_INTERFACE_INCLUDE_H_
 #define UTILS_DYNAMIC_LIBRARY_INTERFACE_INCLUDE_H_
 
-#include <mutex>
-
 #include "utils/dynamic_library.h"
+#include "utils/scoped_ref_object.h"
+#include "utils/weak_ptr.h"
 
 namespace utils {
 
@@ -41,8 +41,11 @@ static void Destruct(const std::weak_ptr<DynamicLibrary>& library, const std::st
 }
 };
 
+// Owns an interface made by a library. Interface shares it by reference
+// count, and its weak handles point to it through a WeakPtr. The last
+// reference may go on any thread, and the weak handles with it.
 template<typename NativeInterface, typename DestructTraits>
-class NativeTraits {
+class NativeTraits : public AtomicRefObject<NativeTraits<NativeInterface, DestructTraits>> {
 public:
     using Destructor = std::function<void(NativeInterface**)>;
 
@@ -82,9 +85,14 @@ public:
 
     NativeInterface* get() const { return interface_; }
 
+    WeakPtr<NativeTraits> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
 protected:
     Destructor destructor_;
     NativeInterface* interface_ = nullptr;
+
+private:
+    WeakPtrFactory<NativeTraits> weak_factory_{ this };
 };
 
 template<typename NativeInterface>
@@ -93,24 +101,12 @@ using PointerTraits = NativeTraits<NativeInterface, Pointer<NativeInterface>>;
 template<typename NativeInterface>
 using DoublePointerTraits = NativeTraits<NativeInterface, DoublePointer<NativeInterface>>;
 
-class ThreadFlag {
-public:
-    ThreadFlag() : valid_thread_id_(::GetCurrentThreadId()) {}
-    virtual ~ThreadFlag() {}
-
-    bool CalledOnValidThread() const {
-        std::lock_guard<std::mutex> guard(lock_);
-        return valid_thread_id_ == ::GetCurrentThreadId();
-    }
-
-private:
-    mutable std::mutex lock_;
-    mutable DWORD valid_thread_id_ = 0;
-};
-
 } // namespace subtle
 
 
+// Handles may be copied and dropped on any thread. A weak handle from
+// AstWeakPtr() does not keep the interface alive, so its get() is only good
+// while a strong handle lives; AsRefPtr() takes one from it on any thread.
 template<typename NativeInterface, typename Traits = subtle::PointerTraits<NativeInterface>>
 class Interface {
 public:
@@ -121,17 +117,14 @@ public:
         interface_ = r.interface_;
         weak_interface_ = r.weak_interface_;
         library_name_ = r.library_name_;
-        if (!interface_) weak_flag_ = r.weak_flag_;
         return *this;
     }
 
     Interface AstWeakPtr() {
         Interface tmp;
         tmp.library_name_ = library_name_;
-        if (interface_) tmp.weak_interface_ = interface_;
+        if (interface_) tmp.weak_interface_ = interface_->AsWeakPtr();
         else tmp.weak_interface_ = weak_interface_;
-        if (!flag_) flag_ = new subtle::ThreadFlag();
-        tmp.weak_flag_ = flag_;
         return tmp;
     }
 
@@ -139,7 +132,7 @@ public:
         Interface tmp;
         tmp.library_name_ = library_name_;
         if (interface_) tmp.interface_ = interface_;
-        else tmp.interface_ = weak_interface_.lock();
+        else tmp.interface_ = weak_interface_.Lock();
         return tmp;
     }
 
@@ -176,11 +169,7 @@ public:
       if (!library_name_.empty() && !utils::WellKnownLibrary(library_name_))
         return nullptr;
         if (interface_) return interface_->get();
-        auto known_interface = weak_interface_.lock();
-        if (known_interface) {
-            auto flag = weak_flag_.lock();
-            if (flag) return known_interface->get();
-        }
+        if (weak_interface_) return weak_interface_->get();
         return nullptr;
     }
 
@@ -198,16 +187,14 @@ public:
 
     void reset() { interface_ = nullptr; weak_interface_ = nullptr; library_name_ = L""; }
 
-    void swap(Interface& r) { interface_.swap(r.interface_); weak_interface_.swap(r.weak_interface_); std::swap(libarary_name_, r.library_name_); }
+    void swap(Interface& r) { interface_.swap(r.interface_); weak_interface_.swap(r.weak_interface_); std::swap(library_name_, r.library_name_); }
 
     void SetLibraryName(const std::wstring& name) { library_name_ = name; }
 
 protected:
-    std::shared_ptr<Traits> interface_ = nullptr;
-    std::weak_ptr<Traits> weak_interface_;
+    scoped_refptr<Traits> interface_;
+    WeakPtr<Traits> weak_interface_;
     std::wstring library_name_;
-    std::shared_ptr<subtle::ThreadFlag> flag_;
-    std::weak_ptr<subtle::ThreadFlag> weak_flag_;
 };
 
 template<typename R, typename... P>
@@ -10,51 +10,365 @@
 #ifndef UTILS_ENUMERATE_INCLUDE_H_ 
 #define UTILS_ENUMERATE_INCLUDE_H_ 
 
-#include <algorithm>
+#include <array>
 #include <iostream>
 #include <map>
-#include <sstream>
-#include <vector>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "utils/basictypes.h"
-#include "utils/stl_util.h"
 
 
 namespace utils {
+namespace internal {
+
+// The name/value table of a DECLARE_ENUM, parsed from the stringized
+// enumerator list by constexpr functions, so it is constant-initialized and
+// no code runs at startup.
 
 template <typename Type>
-std::map<Type, std::string> parse(std::string input) {
-#ifdef _DEBUG
-    std::cout << "ready to parse enum: " << input << std::endl;
-#endif // _DEBUG
-
-    std::vector<std::string> tokens;
-    auto removed = utils::RemoveChars(input, " ()\r\t\n", &input);
-    auto size =
-        utils::Tokenize(input, ',', &tokens);  // Token: [Name | Name=EnumValue]
-#ifdef _DEBUG
-    std::cout << "parse enum: " << input << "->size:" << size;
-#endif // _DEBUG
-
-    Type index = 0;
-    std::map<Type, std::string> result;
-    for (auto iter = tokens.begin(); iter != tokens.end(); ++iter) {
-        std::string name = *iter;
-        if (iter->find('=') != std::string::npos) {
-            std::vector<std::string> pair;
-            auto size = utils::Tokenize(*iter, '=', &pair);
-#ifdef _DEBUG
-            if (size != 2) __debugbreak();
-#endif // _DEBUG
-            name = pair[0];                         // key = static_cast<Type>(pair[1]);
-            if (std::is_unsigned<Type>::value) index = static_cast<Type>(std::stoull(pair[1], 0, 0));
-            else index = static_cast<Type>(std::stoll(pair[1], 0, 0));
+struct EnumEntry {
+    Type value = Type();
+    std::string_view name;
+};
+
+constexpr bool IsEnumSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+constexpr std::string_view TrimEnumToken(std::string_view token) {
+    while (!token.empty() && IsEnumSpace(token.front())) token.remove_prefix(1);
+    while (!token.empty() && IsEnumSpace(token.back())) token.remove_suffix(1);
+    return token;
+}
+
+// Removes balanced parentheses around the whole of |token|, and the
+// whitespace inside them, as in "( -1 )".
+constexpr std::string_view StripEnumParens(std::string_view token) {
+    for (;;) {
+        if (token.size() < 2 || token.front() != '(' || token.back() != ')') return token;
+        size_t depth = 0;
+        for (size_t i = 0; i + 1 < token.size(); ++i) {
+            if (token[i] == '(') ++depth;
+            else if (token[i] == ')' && --depth == 0) return token;
         }
-        result[index++] = name;
+        token = TrimEnumToken(token.substr(1, token.size() - 2));
+    }
+}
+
+// Returns the number of enumerators in |list|; a trailing comma is allowed.
+constexpr size_t CountEnumerators(std::string_view list) {
+    size_t count = 0;
+    for (;;) {
+        const size_t comma = list.find(',');
+        if (!TrimEnumToken(list.substr(0, comma)).empty()) ++count;
+        if (comma == std::string_view::npos) return count;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+constexpr int EnumDigitValue(char c) {
+    return c >= '0' && c <= '9' ? c - '0'
+        : c >= 'a' && c <= 'z' ? c - 'a' + 10
+        : c >= 'A' && c <= 'Z' ? c - 'A' + 10 : 99;
+}
+
+// Parses the initializer of an enumerator: an integer literal in any base,
+// with an optional sign, digit separators and suffix, or the name of an
+// enumerator declared before it. Either may be wrapped in parentheses. Any
+// other initializer, such as an expression, fails to compile.
+template <typename Type>
+constexpr Type ParseEnumValue(std::string_view text, const EnumEntry<Type>* previous, size_t count) {
+    text = StripEnumParens(text);
+    for (size_t i = 0; i < count; ++i) {
+        if (previous[i].name == text) return previous[i].value;
+    }
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text = StripEnumParens(TrimEnumToken(text.substr(1)));
+    }
+    if (text.empty() || EnumDigitValue(text.front()) > 9) throw "DECLARE_ENUM: unsupported enumerator value";
+    unsigned long long base = 10;
+    if (text.size() > 1 && text[0] == '0') {
+        if (text[1] == 'x' || text[1] == 'X') base = 16, text.remove_prefix(2);
+        else if (text[1] == 'b' || text[1] == 'B') base = 2, text.remove_prefix(2);
+        else base = 8, text.remove_prefix(1);
+    }
+    unsigned long long value = 0;
+    for (; !text.empty(); text.remove_prefix(1)) {
+        if (text.front() == '\'') continue;
+        const int digit = EnumDigitValue(text.front());
+        if (digit >= static_cast<int>(base)) break;
+        value = value * base + digit;
+    }
+    for (char c : text) {
+        if (c != 'u' && c != 'U' && c != 'l' && c != 'L') throw "DECLARE_ENUM: unsupported enumerator value";
+    }
+    return static_cast<Type>(negative ? 0 - value : value);
+}
+
+// The parsed enumerators: all of them in declaration order, and ordered by
+// value with only the last of several names for one value kept.
+template <typename Type, size_t N>
+struct EnumEntries {
+    std::array<EnumEntry<Type>, N> declared;
+    std::array<EnumEntry<Type>, N> entries;
+    size_t size = 0;
+
+    // The width of the value range when it is small enough to index
+    // directly, otherwise 0.
+    constexpr size_t DenseSpan() const {
+        if (size == 0) return 0;
+        const unsigned long long span =
+            static_cast<unsigned long long>(entries[size - 1].value) - static_cast<unsigned long long>(entries[0].value) + 1;
+        return span != 0 && span <= 4 * N + 64 ? static_cast<size_t>(span) : 0;
+    }
+};
+
+template <typename Type, size_t N>
+constexpr EnumEntries<Type, N> ParseEnum(std::string_view list) {
+    EnumEntries<Type, N> result;
+    Type next = Type();
+    size_t count = 0;
+    for (;;) {
+        const size_t comma = list.find(',');
+        const std::string_view token = TrimEnumToken(list.substr(0, comma));
+        if (!token.empty()) {
+            const size_t equals = token.find('=');
+            EnumEntry<Type> entry;
+            entry.name = TrimEnumToken(token.substr(0, equals));
+            entry.value = equals == std::string_view::npos
+                ? next : ParseEnumValue<Type>(TrimEnumToken(token.substr(equals + 1)), result.declared.data(), count);
+            // Wraps rather than overflows after the largest value of Type;
+            // the compiler rejects the enum if an enumerator takes it.
+            next = static_cast<Type>(static_cast<unsigned long long>(entry.value) + 1);
+            result.declared[count] = entry;
+            result.entries[count++] = entry;
+        }
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+
+    // Stable insertion sort by value, then one entry per value.
+    for (size_t i = 1; i < count; ++i) {
+        const EnumEntry<Type> entry = result.entries[i];
+        size_t j = i;
+        for (; j > 0 && entry.value < result.entries[j - 1].value; --j) result.entries[j] = result.entries[j - 1];
+        result.entries[j] = entry;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (result.size && result.entries[result.size - 1].value == result.entries[i].value) --result.size;
+        result.entries[result.size++] = result.entries[i];
     }
     return result;
 }
 
+// Lookups by value. When the values span a small range, as in almost every
+// enum, a value indexes a table of positions directly; otherwise it is
+// binary searched.
+template <typename Type, size_t N, size_t Span>
+class EnumTable {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    constexpr explicit EnumTable(const EnumEntries<Type, N>& parsed)
+        : entries_(parsed.entries), size_(parsed.size), index_() {
+        for (size_t i = 0; i < Span; ++i) index_[i] = kNone;
+        for (size_t i = 0; i < size_ && Span; ++i) index_[Offset(entries_[i].value)] = static_cast<uint16>(i);
+    }
+
+    constexpr size_t size() const { return size_; }
+    constexpr const EnumEntry<Type>& operator[](size_t i) const { return entries_[i]; }
+
+    // Returns the position of |value| in value order, or npos.
+    constexpr size_t Find(Type value) const {
+        if (Span) {
+            const unsigned long long offset = Offset(value);
+            return offset < Span && index_[offset] != kNone ? index_[offset] : npos;
+        }
+        size_t low = 0, high = size_;
+        while (low < high) {
+            const size_t middle = low + (high - low) / 2;
+            if (entries_[middle].value < value) low = middle + 1;
+            else high = middle;
+        }
+        return low < size_ && entries_[low].value == value ? low : npos;
+    }
+
+    constexpr bool Contains(Type value) const { return Find(value) != npos; }
+
+    // Returns the name of |value|, or an empty string.
+    constexpr std::string_view NameOf(Type value) const {
+        const size_t i = Find(value);
+        return i == npos ? std::string_view() : entries_[i].name;
+    }
+
+    // Returns the value after |value|, wrapping from the last value, or
+    // from a value that is not in the table, to the first.
+    constexpr Type Next(Type value) const {
+        const size_t i = Find(value);
+        if (size_ == 0) return value;
+        return i != npos && i + 1 < size_ ? entries_[i + 1].value : entries_[0].value;
+    }
+
+private:
+    static const uint16 kNone = 0xFFFF;
+    static_assert(N < kNone, "too many enumerators");
+
+    constexpr unsigned long long Offset(Type value) const {
+        return static_cast<unsigned long long>(value) - static_cast<unsigned long long>(entries_[0].value);
+    }
+
+    std::array<EnumEntry<Type>, N> entries_;
+    size_t size_;
+    std::array<uint16, Span> index_;
+};
+
+constexpr char FoldEnumChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+constexpr bool EqualsEnumNameIgnoringCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (FoldEnumChar(a[i]) != FoldEnumChar(b[i])) return false;
+    }
+    return true;
+}
+
+// FNV-1a over the ASCII-lowercased name, started from |seed| and finished
+// with a multiply-xorshift so that the low bits used for the modulo mix in
+// every character.
+constexpr uint32 HashEnumName(std::string_view name, uint32 seed) {
+    uint32 hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char c : name) {
+        hash ^= static_cast<uint8>(FoldEnumChar(c));
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    return hash ^ (hash >> 12);
+}
+
+// Lookups by name through a minimal perfect hash built by the compiler with
+// hash-and-displace: every name falls into one of N / 2 + 1 buckets, and each
+// bucket, largest first, is given the first seed that sends all of its names
+// to free slots of a table with one slot per name. A lookup is then two
+// hashes, one slot and one string compare, whatever the number of names.
+//
+// The names are hashed lowercased so the one table serves both exact and
+// ASCII case-insensitive lookups. Names that differ only in case share a
+// slot, which holds the first of them; an exact lookup of the others scans
+// the names after it.
+//
+// MSVC stops constant evaluation after /constexpr:steps, 100000 by default;
+// enums with a few hundred enumerators need it raised, as utils.vcxproj does.
+template <typename Type, size_t N>
+class EnumNameTable {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    constexpr explicit EnumNameTable(const EnumEntries<Type, N>& parsed)
+        : names_(parsed.declared), seeds_(), slots_() {
+        for (size_t i = 0; i < N; ++i) slots_[i] = kEmpty;
+        Build();
+    }
+
+    // Returns the position in declaration order of the enumerator called
+    // |name|, or npos.
+    constexpr size_t Find(std::string_view name, bool case_sensitive) const {
+        if (N == 0) return npos;
+        const uint32 bucket = HashEnumName(name, 0) % kBuckets;
+        const uint16 slot = slots_[HashEnumName(name, seeds_[bucket]) % kSlots];
+        if (slot == kEmpty) return npos;
+        const size_t i = slot & kIndexMask;
+        if (!EqualsEnumNameIgnoringCase(names_[i].name, name)) return npos;
+        if (!case_sensitive || names_[i].name == name) return i;
+        if (slot & kCaseVariants) {
+            for (size_t j = i + 1; j < N; ++j) {
+                if (names_[j].name == name) return j;
+            }
+        }
+        return npos;
+    }
+
+    constexpr bool TryParse(std::string_view name, Type* value, bool case_sensitive) const {
+        const size_t i = Find(name, case_sensitive);
+        if (i == npos) return false;
+        *value = names_[i].value;
+        return true;
+    }
+
+    constexpr const EnumEntry<Type>& operator[](size_t i) const { return names_[i]; }
+
+private:
+    static const size_t kBuckets = N / 2 + 1;
+    static const size_t kSlots = N ? N : 1;
+    static const size_t kMaxBucket = 32;
+    static const uint16 kEmpty = 0xFFFF;
+    static const uint16 kCaseVariants = 0x8000;
+    static const uint16 kIndexMask = 0x7FFF;
+    static_assert(N <= kIndexMask, "too many enumerators");
+
+    constexpr void Build() {
+        std::array<uint16, kBuckets + 1> starts = {};
+        std::array<uint16, N> members = {};
+        for (size_t i = 0; i < N; ++i) ++starts[HashEnumName(names_[i].name, 0) % kBuckets + 1];
+        size_t largest = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            largest = starts[b + 1] > largest ? starts[b + 1] : largest;
+            starts[b + 1] += starts[b];
+        }
+        std::array<uint16, kBuckets + 1> next = starts;
+        for (size_t i = 0; i < N; ++i) members[next[HashEnumName(names_[i].name, 0) % kBuckets]++] = static_cast<uint16>(i);
+
+        for (size_t size = largest; size > 0; --size) {
+            for (size_t b = 0; b < kBuckets; ++b) {
+                if (static_cast<size_t>(starts[b + 1] - starts[b]) == size) Place(b, members.data() + starts[b], size);
+            }
+        }
+    }
+
+    // Finds the seed for bucket |b| holding |size| names, skipping names that
+    // equal an earlier one but for case.
+    constexpr void Place(size_t b, const uint16* members, size_t size) {
+        if (size > kMaxBucket) throw "DECLARE_ENUM: too many names hash alike";
+        std::array<uint16, kMaxBucket> keys = {};
+        std::array<bool, kMaxBucket> variants = {};
+        size_t count = 0;
+        for (size_t i = 0; i < size; ++i) {
+            bool variant = false;
+            for (size_t k = 0; k < count && !variant; ++k) {
+                if (EqualsEnumNameIgnoringCase(names_[keys[k]].name, names_[members[i]].name)) variants[k] = variant = true;
+            }
+            if (!variant) keys[count++] = members[i];
+        }
+
+        std::array<uint32, kMaxBucket> positions = {};
+        for (uint32 seed = 1; seed < (1u << 20); ++seed) {
+            bool placed = true;
+            for (size_t k = 0; k < count && placed; ++k) {
+                positions[k] = HashEnumName(names_[keys[k]].name, seed) % kSlots;
+                placed = slots_[positions[k]] == kEmpty;
+                for (size_t j = 0; j < k && placed; ++j) placed = positions[j] != positions[k];
+            }
+            if (!placed) continue;
+            seeds_[b] = seed;
+            for (size_t k = 0; k < count; ++k)
+                slots_[positions[k]] = static_cast<uint16>(keys[k] | (variants[k] ? kCaseVariants : 0));
+            return;
+        }
+        throw "DECLARE_ENUM: no perfect hash found";
+    }
+
+    std::array<EnumEntry<Type>, N> names_;
+    std::array<uint32, kBuckets> seeds_;
+    std::array<uint16, N> slots_;
+};
+
+} // namespace internal
 } // namespace utils
 
 #if _MSC_VER > 1910
@@ -67,7 +381,7 @@ auto enumerate_cast(Enumeration const value)-> typename std::underlying_type<Enu
 }
 
 template<typename Enumeration, typename Type>
-auto enumerate_cast(Type const value) -> typename Enumeration {
+auto enumerate_cast(Type const value) -> Enumeration {
     return static_cast<Enumeration>(value);
 }
 
@@ -79,7 +393,7 @@ auto enumerate_cast(Enumeration const value)-> int {
 }
 
 template<typename Enumeration>
-auto enumerate_cast(int const value) -> typename Enumeration {
+auto enumerate_cast(int const value) -> Enumeration {
     return static_cast<Enumeration>(value);
 }
 
@@ -88,25 +402,62 @@ auto enumerate_cast(int const value) -> typename Enumeration {
 
 // https://stackoverflow.com/questions/28828957/enum-to-string-in-modern-c11-c14-c17-and-future-c20
 // 
+// Name##EnumTable and Name##NameTable are built by the compiler; every
+// operator below is a lookup in one of them. Name##NamedMap() copies the
+// table into the std::map callers used to read, on first use. TryParse()
+// and FromString<Name>() map a name back to its enumerator, optionally
+// ignoring ASCII case.
 #define DECLARE_ENUM_WITH_TYPE(Name, Type, ...)                                             \
     enum class Name : Type {                                                                \
         __VA_ARGS__                                                                         \
     };                                                                                      \
-    static std::map<Type, std::string> Name##NamedMap(                                      \
-      utils::parse<Type>(#__VA_ARGS__));                                                    \
-    size_t enumeratesize(Name key) { (void)key; return TestEnumClassNamedMap.size(); }      \
-    std::string operator*(Name key) { return Name##NamedMap[static_cast<Type>(key)]; }      \
-    std::string operator+(std::string &&str, Name key) { return str + *key; }               \
-    std::string operator+(Name key, std::string &&str) { return *key + str; }               \
-    std::string &operator+=(std::string &str, Name key) { str += *key; return str; }        \
-    std::ostream &operator<<(std::ostream &os, Name key) { os << *key; return os; }         \
-    Name operator++(Name& key) {                                                            \
-        auto it = std::Next(Name##NamedMap, static_cast<Type>(key));                        \
-        if (it == Name##NamedMap.end()) return key;                                         \
-        key = enumerate_cast<Name>(it->first);                                              \
+    inline constexpr auto Name##EnumEntries = utils::internal::ParseEnum<Type,              \
+        utils::internal::CountEnumerators(#__VA_ARGS__)>(#__VA_ARGS__);                     \
+    inline constexpr utils::internal::EnumTable<Type, Name##EnumEntries.entries.size(),     \
+        Name##EnumEntries.DenseSpan()> Name##EnumTable(Name##EnumEntries);                  \
+    inline const std::map<Type, std::string>& Name##NamedMap() {                           \
+        static const std::map<Type, std::string> named = [] {                               \
+            std::map<Type, std::string> map;                                                \
+            for (size_t i = 0; i < Name##EnumTable.size(); ++i) {                           \
+                const auto& entry = Name##EnumTable[i];                                     \
+                map.emplace(entry.value, std::string(entry.name));                          \
+            }                                                                               \
+            return map;                                                                     \
+        }();                                                                                \
+        return named;                                                                       \
+    }                                                                                       \
+    inline size_t enumeratesize(Name key) { (void)key; return Name##EnumTable.size(); }     \
+    inline std::string operator*(Name key) {                                                \
+        return std::string(Name##EnumTable.NameOf(static_cast<Type>(key)));                 \
+    }                                                                                       \
+    inline std::string operator+(std::string &&str, Name key) { return str + *key; }        \
+    inline std::string operator+(Name key, std::string &&str) { return *key + str; }        \
+    inline std::string &operator+=(std::string &str, Name key) { str += *key; return str; } \
+    inline std::ostream &operator<<(std::ostream &os, Name key) {                           \
+        return os << Name##EnumTable.NameOf(static_cast<Type>(key));                        \
+    }                                                                                       \
+    inline Name operator++(Name& key) {                                                     \
+        key = static_cast<Name>(Name##EnumTable.Next(static_cast<Type>(key)));              \
         return key;                                                                         \
     }                                                                                       \
-    template<typename T = Name> bool ContainsKey(Type key) { return std::ContainsKey(Name##NamedMap, key); }
+    inline constexpr utils::internal::EnumNameTable<Type, Name##EnumEntries.entries.size()>  \
+        Name##NameTable(Name##EnumEntries);                                                 \
+    inline bool TryParse(std::string_view name, Name* key, bool case_sensitive = true) {    \
+        Type value = Type();                                                                \
+        if (!Name##NameTable.TryParse(name, &value, case_sensitive)) return false;          \
+        *key = static_cast<Name>(value);                                                    \
+        return true;                                                                        \
+    }                                                                                       \
+    template<typename T = Name>                                                             \
+    auto FromString(std::string_view name, T fallback = T(), bool case_sensitive = true)    \
+        -> typename std::enable_if<std::is_same<T, Name>::value, T>::type {                 \
+        TryParse(name, &fallback, case_sensitive);                                          \
+        return fallback;                                                                    \
+    }                                                                                       \
+    template<typename T = Name>                                                             \
+    auto ContainsKey(Type key) -> typename std::enable_if<std::is_same<T, Name>::value, bool>::type { \
+        return Name##EnumTable.Contains(key);                                               \
+    }
 
 #define DECLARE_ENUM(Name, ...) DECLARE_ENUM_WITH_TYPE(Name, int32_t, __VA_ARGS__)
 
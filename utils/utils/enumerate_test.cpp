@@ -1,10 +1,42 @@
 #include <Windows.h>
 #include "utils/enumerate.h"
 #include "utils/scoped_object.h"
+#include "utils/test_util.h"
+
+#include <vector>
 
 #ifdef TEST
 
 DECLARE_ENUM_WITH_TYPE(TestEnumClass, int32_t, ZERO = 0x00, TWO = 0x02, ONE = 0x01, THREE = 0x03, FOUR);
+DECLARE_ENUM_WITH_TYPE(SparseEnumClass, uint32_t, NONE, LOW = 010, HIGH = 0x8000'0000u, LAST = HIGH, MAX = 0xFFFFFFFF, );
+DECLARE_ENUM(SignedEnumClass, MINUS = -2, NEXT, ZERO_ALIAS = NEXT, ONE = 0b1);
+DECLARE_ENUM(CaseEnumClass, Ok, OK, ok_, Error);
+DECLARE_ENUM(ParenEnumClass, MINUS = ( -1 ), ONE = (1), TWO = ((0x2)), NEG_TWO = -(2), ALIAS = (ONE));
+DECLARE_ENUM(LimitEnumClass, A, MAX = 0x7FFFFFFF);
+DECLARE_ENUM_WITH_TYPE(Limit64EnumClass, int64_t, A, MAX = 0x7FFFFFFFFFFFFFFF);
+
+// 400 enumerators, Header_A00 to Header_D99. The list is expanded before
+// DECLARE_ENUM stringizes it.
+#define ENUM_TEN(prefix) prefix##0, prefix##1, prefix##2, prefix##3, prefix##4, \
+    prefix##5, prefix##6, prefix##7, prefix##8, prefix##9
+#define ENUM_HUNDRED(prefix) ENUM_TEN(prefix##0), ENUM_TEN(prefix##1), ENUM_TEN(prefix##2), \
+    ENUM_TEN(prefix##3), ENUM_TEN(prefix##4), ENUM_TEN(prefix##5), ENUM_TEN(prefix##6), \
+    ENUM_TEN(prefix##7), ENUM_TEN(prefix##8), ENUM_TEN(prefix##9)
+#define DECLARE_EXPANDED_ENUM(Name, ...) DECLARE_ENUM(Name, __VA_ARGS__)
+DECLARE_EXPANDED_ENUM(LargeEnumClass, ENUM_HUNDRED(Header_A), ENUM_HUNDRED(Header_B), ENUM_HUNDRED(Header_C),
+                      ENUM_HUNDRED(Header_D));
+
+// The tables are built by the compiler.
+static_assert(TestEnumClassEnumTable.size() == 5 && TestEnumClassEnumTable.NameOf(4) == "FOUR", "");
+static_assert(TestEnumClassEnumTable.Next(1) == 2 && TestEnumClassEnumTable.Next(4) == 0, "");
+static_assert(SparseEnumClassEnumTable.size() == 4 && SparseEnumClassEnumTable.NameOf(0x80000000u) == "LAST", "");
+static_assert(SparseEnumClassEnumTable.NameOf(8) == "LOW" && !SparseEnumClassEnumTable.Contains(9), "");
+static_assert(SignedEnumClassEnumTable.NameOf(-1) == "ZERO_ALIAS" && SignedEnumClassEnumTable[0].value == -2, "");
+static_assert(ParenEnumClassEnumTable.NameOf(-1) == "MINUS" && ParenEnumClassEnumTable.NameOf(1) == "ALIAS", "");
+static_assert(ParenEnumClassEnumTable.NameOf(2) == "TWO" && ParenEnumClassEnumTable.NameOf(-2) == "NEG_TWO", "");
+static_assert(LimitEnumClassEnumTable.NameOf(0x7FFFFFFF) == "MAX" && LimitEnumClassEnumTable.Next(0x7FFFFFFF) == 0, "");
+static_assert(Limit64EnumClassEnumTable.NameOf(0x7FFFFFFFFFFFFFFF) == "MAX", "");
+static_assert(LargeEnumClassNameTable.Find("Header_C42", true) == 242 && LargeEnumClassEnumTable.size() == 400, "");
 
 int ENUM_TEST(void) {
     TestEnumClass first, second;
@@ -27,8 +59,78 @@ int ENUM_TEST(void) {
     std::cout << "Enum count=" << *first << std::endl;
 
     bool has_key = ContainsKey<TestEnumClass>(100);
+    if (has_key || !ContainsKey<TestEnumClass>(3) || enumeratesize(first) != 5) __debugbreak();
+    if (strOne != "FOUR" || strTwo != "Enum-TWOTHREE-test" || strThree != "TestEnumClass: TWO") __debugbreak();
+
+    // ++ walks the values in order and wraps around.
+    std::string names;
+    TestEnumClass key = TestEnumClass::ZERO;
+    for (size_t i = 0; i < 6; ++i, ++key) names += *key;
+    if (names != "ZEROONETWOTHREEFOURZERO" || !(*static_cast<TestEnumClass>(7)).empty()) __debugbreak();
+    SparseEnumClass sparse = SparseEnumClass::LOW;
+    if (*++sparse != "LAST" || *++sparse != "MAX" || *++sparse != "NONE") __debugbreak();
+
+    // The name map for callers of the old interface.
+    if (TestEnumClassNamedMap().size() != 5 || TestEnumClassNamedMap().at(2) != "TWO") __debugbreak();
+
+    // Names back to enumerators, aliases included.
+    SparseEnumClass parsed = SparseEnumClass::NONE;
+    if (!TryParse("HIGH", &parsed) || parsed != SparseEnumClass::LAST || TryParse("high", &parsed)) __debugbreak();
+    if (!TryParse("high", &parsed, false) || TryParse("HIGHER", &parsed, false) || TryParse("", &parsed)) __debugbreak();
+    if (FromString<TestEnumClass>("THREE") != TestEnumClass::THREE ||
+        FromString<TestEnumClass>("three", TestEnumClass::ZERO) != TestEnumClass::ZERO ||
+        FromString<TestEnumClass>("three", TestEnumClass::ZERO, false) != TestEnumClass::THREE) __debugbreak();
+    CaseEnumClass status = CaseEnumClass::Error;
+    if (!TryParse("OK", &status) || status != CaseEnumClass::OK || !TryParse("Ok", &status) || status != CaseEnumClass::Ok)
+        __debugbreak();
+    if (TryParse("oK", &status) || !TryParse("oK", &status, false) || status != CaseEnumClass::Ok) __debugbreak();
+    if (!TryParse("OK_", &status, false) || status != CaseEnumClass::ok_) __debugbreak();
+    for (size_t i = 0; i < 400; ++i) {
+        LargeEnumClass large = LargeEnumClass::Header_A00;
+        const std::string name = *static_cast<LargeEnumClass>(i);
+        if (!TryParse(name, &large) || static_cast<size_t>(large) != i) __debugbreak();
+        if (TryParse(name + "x", &large) || TryParse(name.substr(1), &large)) __debugbreak();
+    }
 
     return 0;
 }
 
+// Parses 1M names of a 400-value enum by scanning the name table, as
+// callers had to with Name##NamedMap, and with TryParse(), exactly and
+// ignoring case, and prints the time each takes.
+int ENUM_BENCHMARK(void) {
+    const int kLookups = 1000000;
+    std::vector<std::string> names;
+    for (int i = 0; i < 400; i += 7) names.push_back(*static_cast<LargeEnumClass>(i));
+    names.push_back("Header_E00");
+
+    size_t found = 0, parsed = 0, folded = 0;
+    auto linear = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLookups; ++i) {
+            const std::string& name = names[i % names.size()];
+            for (size_t k = 0; k < LargeEnumClassEnumTable.size(); ++k) {
+                if (LargeEnumClassEnumTable[k].name == name) {
+                    found += static_cast<size_t>(LargeEnumClassEnumTable[k].value);
+                    break;
+                }
+            }
+        }
+    });
+    LargeEnumClass value = LargeEnumClass::Header_A00;
+    auto hashed = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLookups; ++i) {
+            if (TryParse(names[i % names.size()], &value)) parsed += static_cast<size_t>(value);
+        }
+    });
+    auto ignoring_case = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLookups; ++i) {
+            if (TryParse(names[i % names.size()], &value, false)) folded += static_cast<size_t>(value);
+        }
+    });
+
+    std::cout << "Enum parse: linear " << linear << "us, TryParse " << hashed << "us, ignoring case " << ignoring_case
+              << "us" << std::endl;
+    return found == parsed && parsed == folded ? 0 : 1;
+}
+
 #endif // _DEBUG
\ No newline at end of file
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/epoch.h"
+
+#include <assert.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A thread hands its list to the reclaimer when it reaches this many objects.
+const size_t kRetireBatch = 64;
+
+// How often the reclaimer takes the lists, and retries an epoch that readers
+// hold back, while anything is waiting.
+const std::chrono::milliseconds kReclaimInterval(5);
+
+struct RetiredObject {
+    const void* object;
+    void (*destruct)(const void*);
+};
+
+// The state of one thread. Records are reused after their thread exits and
+// never freed, so the reclaimer walks them without a lock.
+struct EpochRecord {
+    // The epoch the thread's outermost guard started in, or 0 outside one.
+    std::atomic<uint64> epoch{ 0 };
+    // Guards the thread is in. Only the thread touches it.
+    int nesting = 0;
+    std::mutex lock;
+    // What the thread retired since the last sweep. Guarded by |lock|.
+    std::vector<RetiredObject> retired;
+    std::atomic<bool> in_use{ false };
+    EpochRecord* next = nullptr;
+};
+
+// Objects swept together, destroyed once the epoch passes |epoch| + 1.
+struct RetiredBatch {
+    uint64 epoch;
+    uint64 sweep;
+    std::vector<RetiredObject> objects;
+};
+
+class Reclaimer {
+public:
+    // Never destroyed, so its thread is never joined while the loader lock is
+    // held at DLL unload.
+    static Reclaimer& Get() {
+        static Reclaimer* reclaimer = new Reclaimer;
+        return *reclaimer;
+    }
+
+    EpochRecord* AcquireRecord();
+    void ReleaseRecord(EpochRecord* record);
+
+    void Enter(EpochRecord* record);
+    void Leave(EpochRecord* record);
+    void Retire(EpochRecord* record, const RetiredObject& object);
+    void Flush();
+
+private:
+    Reclaimer() : thread_(&Reclaimer::ThreadMain, this) {}
+
+    void ThreadMain();
+    void Sweep(uint64 sweep, std::deque<RetiredBatch>* limbo);
+    bool TryAdvance();
+
+    std::atomic<uint64> epoch_{ 1 };
+    std::atomic<EpochRecord*> records_{ nullptr };
+    // Retired objects not yet destroyed.
+    std::atomic<size_t> waiting_{ 0 };
+
+    // Guards the fields below.
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::condition_variable reclaimed_;
+    bool batch_ready_ = false;
+    uint64 sweeps_ = 0;
+    // Every object swept up to this sweep has been destroyed.
+    uint64 reclaimed_sweep_ = 0;
+    // The sweep Flush() callers wait for.
+    uint64 flush_sweep_ = 0;
+
+    std::thread thread_;
+};
+
+thread_local EpochRecord* thread_record = nullptr;
+
+// Set once the thread's record has been given back. Guards and retirements
+// from later thread-local destructors take a record and give it back at once.
+thread_local bool thread_exiting = false;
+
+struct ThreadEpochRecord {
+    ~ThreadEpochRecord() {
+        thread_exiting = true;
+        if (!thread_record) return;
+        Reclaimer::Get().ReleaseRecord(thread_record);
+        thread_record = nullptr;
+    }
+};
+
+EpochRecord* CurrentEpochRecord() {
+    if (!thread_record) {
+        thread_record = Reclaimer::Get().AcquireRecord();
+        if (!thread_exiting) {
+            static thread_local ThreadEpochRecord thread_owner;
+            (void)thread_owner;
+        }
+    }
+    return thread_record;
+}
+
+void MaybeReleaseEpochRecord() {
+    if (!thread_exiting || thread_record->nesting != 0) return;
+    Reclaimer::Get().ReleaseRecord(thread_record);
+    thread_record = nullptr;
+}
+
+EpochRecord* Reclaimer::AcquireRecord() {
+    for (EpochRecord* record = records_.load(std::memory_order_acquire); record; record = record->next) {
+        bool in_use = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+    EpochRecord* record = new EpochRecord;
+    record->in_use.store(true, std::memory_order_relaxed);
+    record->next = records_.load(std::memory_order_relaxed);
+    while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {}
+    return record;
+}
+
+// What the record still holds is destroyed by later sweeps.
+void Reclaimer::ReleaseRecord(EpochRecord* record) {
+    assert(record->nesting == 0);
+    record->in_use.store(false, std::memory_order_release);
+}
+
+// A full barrier keeps the reads the guard protects from moving above the
+// store; the exchange is one, and cheaper than a fence after a store.
+void Reclaimer::Enter(EpochRecord* record) {
+    if (record->nesting++ != 0) return;
+    record->epoch.exchange(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void Reclaimer::Leave(EpochRecord* record) {
+    assert(record->nesting > 0);
+    if (--record->nesting == 0) record->epoch.store(0, std::memory_order_release);
+}
+
+void Reclaimer::Retire(EpochRecord* record, const RetiredObject& object) {
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(record->lock);
+        record->retired.push_back(object);
+        size = record->retired.size();
+    }
+    // The first waiting object starts the timed sweeps.
+    if (waiting_.fetch_add(1, std::memory_order_relaxed) != 0 && size != kRetireBatch) return;
+    std::lock_guard<std::mutex> lock(lock_);
+    batch_ready_ = true;
+    wake_.notify_one();
+}
+
+void Reclaimer::Flush() {
+    assert(!thread_record || thread_record->nesting == 0);
+    assert(std::this_thread::get_id() != thread_.get_id());
+    std::unique_lock<std::mutex> lock(lock_);
+    const uint64 sweep = sweeps_ + 1;
+    if (flush_sweep_ < sweep) flush_sweep_ = sweep;
+    wake_.notify_one();
+    reclaimed_.wait(lock, [this, sweep]() { return reclaimed_sweep_ >= sweep; });
+}
+
+void Reclaimer::ThreadMain() {
+    std::deque<RetiredBatch> limbo;
+    for (;;) {
+        uint64 sweep;
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            auto ready = [this]() { return batch_ready_ || flush_sweep_ > sweeps_; };
+            if (waiting_.load(std::memory_order_relaxed) == 0) {
+                wake_.wait(lock, [this, &ready]() { return ready() || waiting_.load(std::memory_order_relaxed) != 0; });
+            } else {
+                wake_.wait_for(lock, kReclaimInterval, ready);
+            }
+            batch_ready_ = false;
+            sweep = ++sweeps_;
+        }
+
+        Sweep(sweep, &limbo);
+        // Without readers in the way a batch is destroyed in the sweep that
+        // takes it.
+        for (int i = 0; i < 2 && !limbo.empty() && TryAdvance(); ++i) {}
+        const uint64 epoch = epoch_.load(std::memory_order_relaxed);
+        while (!limbo.empty() && limbo.front().epoch + 2 <= epoch) {
+            RetiredBatch batch = std::move(limbo.front());
+            limbo.pop_front();
+            for (const RetiredObject& object : batch.objects) object.destruct(object.object);
+            waiting_.fetch_sub(batch.objects.size(), std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(lock_);
+        reclaimed_sweep_ = limbo.empty() ? sweep : limbo.front().sweep - 1;
+        reclaimed_.notify_all();
+    }
+}
+
+// Takes every list, then reads the epoch: all of them were retired by then.
+void Reclaimer::Sweep(uint64 sweep, std::deque<RetiredBatch>* limbo) {
+    std::vector<RetiredObject> objects;
+    for (EpochRecord* record = records_.load(std::memory_order_acquire); record; record = record->next) {
+        std::lock_guard<std::mutex> lock(record->lock);
+        if (objects.empty()) {
+            objects.swap(record->retired);
+        } else {
+            objects.insert(objects.end(), record->retired.begin(), record->retired.end());
+            record->retired.clear();
+        }
+    }
+    if (objects.empty()) return;
+    limbo->push_back(RetiredBatch{ epoch_.load(std::memory_order_seq_cst), sweep, std::move(objects) });
+}
+
+// The epoch moves on once every thread in a guard has seen it. Only the
+// reclaimer thread changes it.
+bool Reclaimer::TryAdvance() {
+    const uint64 epoch = epoch_.load(std::memory_order_seq_cst);
+    for (EpochRecord* record = records_.load(std::memory_order_acquire); record; record = record->next) {
+        const uint64 pinned = record->epoch.load(std::memory_order_seq_cst);
+        if (pinned != 0 && pinned != epoch) return false;
+    }
+    epoch_.store(epoch + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+}  // namespace
+
+utils::EpochGuard::EpochGuard() {
+    Reclaimer::Get().Enter(CurrentEpochRecord());
+}
+
+utils::EpochGuard::~EpochGuard() {
+    Reclaimer::Get().Leave(thread_record);
+    MaybeReleaseEpochRecord();
+}
+
+void utils::RetireObject(const void* object, void (*destruct)(const void*)) {
+    Reclaimer::Get().Retire(CurrentEpochRecord(), RetiredObject{ object, destruct });
+    MaybeReleaseEpochRecord();
+}
+
+void utils::ReclaimRetired() {
+    Reclaimer::Get().Flush();
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_EPOCH_INCLUDE_H_
+#define UTILS_EPOCH_INCLUDE_H_
+
+#include <atomic>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+#include "utils/scoped_ref_object.h"
+
+// Epoch-based reclamation. Objects that no new reader can reach are retired
+// instead of destroyed, and a background thread destroys them once every
+// reader that might still see them has finished. Readers mark where they
+// look with an EpochGuard, which costs two stores and no lock.
+//
+// The process has one global epoch. A guard records the epoch it started in;
+// the reclaimer advances the epoch when every thread in a guard has seen the
+// current one, and destroys what was retired in epoch E once the epoch
+// reaches E + 2, when no guard from E or earlier can be left.
+//
+// Each thread collects what it retires in a list of its own. The reclaimer
+// takes the lists once one grows to a batch, or every few milliseconds while
+// anything is waiting, and destroys them in batches on its own thread.
+namespace utils {
+
+// Keeps what the calling thread can reach now from being destroyed until the
+// guard ends. Guards nest; keep them short, as they hold back every retired
+// object in the process.
+class UTILS_API EpochGuard {
+public:
+    EpochGuard();
+    ~EpochGuard();
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(EpochGuard);
+};
+
+// Calls |destruct| with |object| on the reclaimer thread once every
+// EpochGuard alive at the time of the call has ended. |object| must no longer
+// be reachable by readers that start later.
+UTILS_API void RetireObject(const void* object, void (*destruct)(const void*));
+
+template <typename T>
+void Retire(const T* object) {
+    RetireObject(object, [](const void* p) { delete static_cast<const T*>(p); });
+}
+
+// Returns once everything retired before the call, on any thread, has been
+// destroyed, for tests and shutdown. Not to be called inside an EpochGuard.
+UTILS_API void ReclaimRetired();
+
+// Moves the final delete of an AtomicRefObject off the releasing thread, so
+// that a latency-critical thread never runs a destructor, or the ones it
+// cascades into, after its last Release():
+//
+//   class Frame : public AtomicRefObject<Frame, utils::DeferredDestructionTraits<Frame>> {
+//       ...
+//   };
+template <typename T>
+struct DeferredDestructionTraits {
+    static void Destruct(const T* object) { RetireObject(object, &Delete); }
+
+private:
+    static void Delete(const void* object) {
+        AtomicRefObject<T, DeferredDestructionTraits>::DeleteInternal(static_cast<const T*>(object));
+    }
+};
+
+// Holds the current version of a ref-counted value, e.g. a configuration or
+// a routing table, that many threads read and one occasionally replaces.
+// Readers load it inside an EpochGuard without touching its count; Store()
+// installs a new version, and the reference to the old one is dropped on the
+// reclaimer thread once no reader that could have loaded it is left. |T|
+// must be counted atomically.
+//
+//   utils::EpochSnapshot<Routes> routes;
+//   ...
+//   {
+//       utils::EpochGuard guard;
+//       const Routes* current = routes.Load(guard);
+//       ...
+//   }
+template <typename T>
+class EpochSnapshot {
+public:
+    EpochSnapshot() {}
+    explicit EpochSnapshot(scoped_refptr<T> value) : ptr_(value.release()) {}
+
+    ~EpochSnapshot() {
+        if (T* value = ptr_.load(std::memory_order_relaxed)) RetireRef(value);
+    }
+
+    // Valid until the guard ends. The guard is only asked for to show the
+    // caller holds one.
+    T* Load(const EpochGuard& /* guard */) const { return ptr_.load(std::memory_order_acquire); }
+
+    // A reference for use after the guard; costs an atomic increment.
+    scoped_refptr<T> Get() const {
+        EpochGuard guard;
+        return scoped_refptr<T>(Load(guard));
+    }
+
+    void Store(scoped_refptr<T> value) {
+        if (T* old = ptr_.exchange(value.release(), std::memory_order_acq_rel)) RetireRef(old);
+    }
+
+private:
+    static void RetireRef(T* value) {
+        RetireObject(value, [](const void* p) { static_cast<const T*>(p)->Release(); });
+    }
+
+    std::atomic<T*> ptr_{ nullptr };
+
+    DISALLOW_COPY_AND_ASSIGN(EpochSnapshot);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_EPOCH_INCLUDE_H_
@@ -17,6 +17,7 @@
 #include "utils.h"
 #include "utils/basictypes.h"
 #include "utils/scoped_object.h"
+#include "utils/files/scoped_file.h"
 
 namespace utils {
 
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/files/memory_mapped_file.h"
+
+#include <algorithm>
+
+#if defined(OS_POSIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+#if defined(OS_WIN)
+
+// PrefetchVirtualMemory() is Windows 8 and later, so it is looked up rather
+// than linked.
+struct MemoryRangeEntry {
+    PVOID VirtualAddress;
+    SIZE_T NumberOfBytes;
+};
+
+typedef BOOL(WINAPI* PrefetchVirtualMemoryFunction)(HANDLE, ULONG_PTR, MemoryRangeEntry*, ULONG);
+
+PrefetchVirtualMemoryFunction GetPrefetchVirtualMemory() {
+    static PrefetchVirtualMemoryFunction prefetch = reinterpret_cast<PrefetchVirtualMemoryFunction>(
+        ::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+    return prefetch;
+}
+
+#endif  // OS_WIN
+
+}  // namespace
+
+const size_t utils::MemoryMappedFile::kWholeFile = static_cast<size_t>(-1);
+
+utils::MemoryMappedFile::MemoryMappedFile()
+    : access_(READ_ONLY),
+      huge_pages_(false),
+      file_length_(0),
+      offset_(0),
+      data_(nullptr),
+      length_(0),
+      mapped_(false) {}
+
+utils::MemoryMappedFile::~MemoryMappedFile() {
+    Close();
+}
+
+bool utils::MemoryMappedFile::Initialize(const PathString& path, Access access) {
+    return Open(path, access) && MapRegion(0);
+}
+
+bool utils::MemoryMappedFile::Open(const PathString& path, Access access) {
+    Close();
+    access_ = access;
+#if defined(OS_WIN)
+    const DWORD desired_access = access == READ_WRITE ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    HANDLE file = ::CreateFileW(path.c_str(), desired_access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    file_.reset(file);
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file_.get(), &size)) {
+        Close();
+        return false;
+    }
+    file_length_ = size.QuadPart;
+
+    // A mapping of an empty file cannot be made; such files map no window.
+    if (file_length_ > 0) {
+        mapping_.reset(::CreateFileMappingW(file_.get(), nullptr, access == READ_WRITE ? PAGE_READWRITE : PAGE_READONLY,
+                                            0, 0, nullptr));
+        if (!mapping_.is_valid()) {
+            Close();
+            return false;
+        }
+    }
+#else
+    file_.reset(::open(path.c_str(), (access == READ_WRITE ? O_RDWR : O_RDONLY) | O_CLOEXEC));
+    if (!file_.is_valid()) return false;
+
+    struct stat info;
+    if (::fstat(file_.get(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        Close();
+        return false;
+    }
+    file_length_ = info.st_size;
+#endif
+    return true;
+}
+
+bool utils::MemoryMappedFile::MapRegion(int64 offset, size_t length) {
+    region_.reset();
+    mapped_ = false;
+    data_ = nullptr;
+    length_ = 0;
+    offset_ = 0;
+    if (!file_.is_valid() || offset < 0 || offset > file_length_) return false;
+
+    // length_ and offset_ describe the window only once it is mapped.
+    const uint64 available = static_cast<uint64>(file_length_ - offset);
+    const size_t window_length = static_cast<size_t>(std::min<uint64>(length, available));
+
+    if (window_length == 0) {
+        offset_ = offset;
+        mapped_ = true;
+        return true;
+    }
+
+    // The mapping starts at the granularity boundary below |offset|.
+    const int64 start = offset - offset % static_cast<int64>(GetAllocationGranularity());
+    const size_t slack = static_cast<size_t>(offset - start);
+    const size_t map_length = window_length + slack;
+
+#if defined(OS_WIN)
+    void* address = ::MapViewOfFile(mapping_.get(), access_ == READ_WRITE ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                    static_cast<DWORD>(static_cast<uint64>(start) >> 32),
+                                    static_cast<DWORD>(start & 0xFFFFFFFF), map_length);
+    if (!address) return false;
+#else
+    const int protection = access_ == READ_WRITE ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* address = ::mmap(nullptr, map_length, protection, MAP_SHARED, file_.get(), start);
+    if (address == MAP_FAILED) return false;
+#if defined(MADV_HUGEPAGE)
+    // Best effort: kernels without huge pages for files refuse it.
+    if (huge_pages_) ::madvise(address, map_length, MADV_HUGEPAGE);
+#endif
+#endif
+
+    MappedRegion region;
+    region.address = address;
+    region.length = map_length;
+    region_.reset(region);
+    data_ = static_cast<uint8*>(address) + slack;
+    length_ = window_length;
+    offset_ = offset;
+    mapped_ = true;
+    return true;
+}
+
+bool utils::MemoryMappedFile::Advise(Advice advice) {
+    if (!mapped_) return false;
+    if (!region_.is_valid()) return true;
+    const MappedRegion& region = region_.get();
+#if defined(OS_WIN)
+    if (advice != WILL_NEED) return true;
+    PrefetchVirtualMemoryFunction prefetch = GetPrefetchVirtualMemory();
+    if (!prefetch) return false;
+    MemoryRangeEntry entry = { region.address, region.length };
+    return !!prefetch(::GetCurrentProcess(), 1, &entry, 0);
+#else
+    int hint = MADV_NORMAL;
+    switch (advice) {
+        case NORMAL:
+            hint = MADV_NORMAL;
+            break;
+        case SEQUENTIAL:
+            hint = MADV_SEQUENTIAL;
+            break;
+        case RANDOM:
+            hint = MADV_RANDOM;
+            break;
+        case WILL_NEED:
+            hint = MADV_WILLNEED;
+            break;
+    }
+    return ::madvise(region.address, region.length, hint) == 0;
+#endif
+}
+
+void utils::MemoryMappedFile::Close() {
+    region_.reset();
+#if defined(OS_WIN)
+    mapping_.reset();
+#endif
+    file_.reset();
+    file_length_ = 0;
+    offset_ = 0;
+    data_ = nullptr;
+    length_ = 0;
+    mapped_ = false;
+}
+
+size_t utils::MemoryMappedFile::GetAllocationGranularity() {
+#if defined(OS_WIN)
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+}
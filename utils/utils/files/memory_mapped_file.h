@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_FILES_MEMORY_MAPPED_FILE_INCLUDE_H_
+#define UTILS_FILES_MEMORY_MAPPED_FILE_INCLUDE_H_
+
+#include <stddef.h>
+#include <string>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+#include "utils/files/scoped_file.h"
+
+#if defined(OS_WIN)
+#include "utils/files/file_util.h"
+#endif
+
+namespace utils {
+
+// Maps a file, or a window of it, into memory, so that reads go straight to
+// the page cache without a copy into a buffer of the caller's.
+//
+//   utils::MemoryMappedFile file;
+//   if (!file.Initialize(path, utils::MemoryMappedFile::READ_ONLY)) return false;
+//   file.Advise(utils::MemoryMappedFile::SEQUENTIAL);
+//   Parse(file.data(), file.length());
+//
+// A file larger than the address space the caller wants to spend is opened
+// with Open() and walked one window at a time with MapRegion(); each call
+// unmaps the previous window.
+class UTILS_API MemoryMappedFile {
+public:
+#if defined(OS_WIN)
+    typedef std::wstring PathString;
+#else
+    typedef std::string PathString;
+#endif
+
+    enum Access {
+        READ_ONLY,
+        // Writes to data() reach the file. The file's length is not changed.
+        READ_WRITE,
+    };
+
+    // How the mapped window will be read, passed to madvise(). Windows has
+    // only WILL_NEED, which prefetches the window; the others are ignored.
+    enum Advice {
+        NORMAL,
+        SEQUENTIAL,
+        RANDOM,
+        WILL_NEED,
+    };
+
+    // Maps from the offset to the end of the file.
+    static const size_t kWholeFile;
+
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    // Opens |path| and maps the whole of it.
+    bool Initialize(const PathString& path, Access access);
+
+    // Opens |path| without mapping anything.
+    bool Open(const PathString& path, Access access);
+
+    // Maps |length| bytes from |offset|, clamped to the end of the file,
+    // in place of the current window. |offset| need not be aligned. On
+    // failure nothing is mapped, and length() and offset() are 0.
+    bool MapRegion(int64 offset, size_t length = kWholeFile);
+
+    // Asks Linux to back the windows mapped later with transparent huge
+    // pages, which saves TLB misses on large random reads. Ignored elsewhere.
+    void set_huge_pages(bool huge_pages) { huge_pages_ = huge_pages; }
+
+    // Returns false if the hint was refused; the mapping is usable anyway.
+    bool Advise(Advice advice);
+
+    void Close();
+
+    bool IsValid() const { return mapped_; }
+
+    // The current window. |data| is null for an empty window.
+    const uint8* data() const { return data_; }
+    uint8* data() { return data_; }
+    size_t length() const { return length_; }
+    int64 offset() const { return offset_; }
+
+    int64 file_length() const { return file_length_; }
+
+    // What mapping offsets must be a multiple of.
+    static size_t GetAllocationGranularity();
+
+private:
+#if defined(OS_WIN)
+    ScopedHANDLE file_;
+    ScopedHANDLE mapping_;
+#else
+    ScopedFD file_;
+#endif
+    ScopedMappedRegion region_;
+
+    Access access_;
+    bool huge_pages_;
+    int64 file_length_;
+    int64 offset_;
+    uint8* data_;
+    size_t length_;
+    bool mapped_;
+
+    DISALLOW_COPY_AND_ASSIGN(MemoryMappedFile);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_FILES_MEMORY_MAPPED_FILE_INCLUDE_H_
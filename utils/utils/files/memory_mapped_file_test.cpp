@@ -0,0 +1,150 @@
+#include <Windows.h>
+#include "utils/files/memory_mapped_file.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(OS_POSIX)
+#include <sys/resource.h>
+#endif
+
+#ifdef TEST
+
+namespace {
+
+std::filesystem::path WriteTestFile(const char* name, size_t size) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (size_t i = 0; i < size; ++i) file.put(static_cast<char>(i * 7 % 251));
+    return path;
+}
+
+}  // namespace
+
+int MEMORY_MAPPED_FILE_TEST(void) {
+    const size_t kSize = 3 * utils::MemoryMappedFile::GetAllocationGranularity() + 123;
+    const std::filesystem::path path = WriteTestFile("memory_mapped_file_test.bin", kSize);
+
+    // The whole file, read in place.
+    {
+        utils::MemoryMappedFile file;
+        if (!file.Initialize(path.native(), utils::MemoryMappedFile::READ_ONLY)) __debugbreak();
+        if (!file.IsValid() || file.length() != kSize || file.file_length() != static_cast<int64>(kSize)) __debugbreak();
+        for (size_t i = 0; i < kSize; ++i) {
+            if (file.data()[i] != i * 7 % 251) __debugbreak();
+        }
+        if (!file.Advise(utils::MemoryMappedFile::SEQUENTIAL)) __debugbreak();
+        file.Advise(utils::MemoryMappedFile::WILL_NEED);
+    }
+
+    // Windows at unaligned offsets, clamped to the end of the file.
+    {
+        utils::MemoryMappedFile file;
+        file.set_huge_pages(true);
+        if (!file.Open(path.native(), utils::MemoryMappedFile::READ_ONLY) || file.IsValid()) __debugbreak();
+        const int64 offsets[] = { 0, 1, 4097, static_cast<int64>(kSize) - 10 };
+        for (int64 offset : offsets) {
+            if (!file.MapRegion(offset, 100)) __debugbreak();
+            if (file.offset() != offset || file.length() != std::min<size_t>(100, kSize - offset)) __debugbreak();
+            for (size_t i = 0; i < file.length(); ++i) {
+                if (file.data()[i] != (offset + i) * 7 % 251) __debugbreak();
+            }
+        }
+        if (!file.MapRegion(kSize) || file.length() != 0 || file.data()) __debugbreak();
+        if (file.MapRegion(kSize + 1) || file.MapRegion(-1) || file.IsValid()) __debugbreak();
+    }
+
+    // Writes through a read-write window reach the file.
+    {
+        utils::MemoryMappedFile file;
+        if (!file.Initialize(path.native(), utils::MemoryMappedFile::READ_WRITE)) __debugbreak();
+        file.data()[5] = 'x';
+        if (!file.MapRegion(kSize - 1, 1)) __debugbreak();
+        file.data()[0] = 'y';
+        file.Close();
+        if (file.IsValid() || file.data()) __debugbreak();
+
+        std::ifstream stream(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        if (contents.size() != kSize || contents[5] != 'x' || contents[kSize - 1] != 'y') __debugbreak();
+    }
+
+#if defined(OS_POSIX)
+    // A window the address space limit cannot hold fails and leaves nothing
+    // mapped. The 64GB file is sparse.
+    {
+        const std::filesystem::path sparse = WriteTestFile("memory_mapped_file_test.sparse", 0);
+        std::filesystem::resize_file(sparse, 64ull << 30);
+        utils::MemoryMappedFile file;
+        if (!file.Open(sparse.native(), utils::MemoryMappedFile::READ_ONLY) || !file.MapRegion(5, 10)) __debugbreak();
+        struct rlimit limit;
+        ::getrlimit(RLIMIT_AS, &limit);
+        struct rlimit lowered = limit;
+        lowered.rlim_cur = 32ull << 30;
+        ::setrlimit(RLIMIT_AS, &lowered);
+        const bool mapped = file.MapRegion(1);
+        ::setrlimit(RLIMIT_AS, &limit);
+        if (mapped || file.IsValid() || file.data() || file.length() != 0 || file.offset() != 0) __debugbreak();
+        file.Close();
+        std::filesystem::remove(sparse);
+    }
+#endif
+
+    // An empty file maps an empty window; a missing one fails.
+    {
+        const std::filesystem::path empty = WriteTestFile("memory_mapped_file_test.empty", 0);
+        utils::MemoryMappedFile file;
+        if (!file.Initialize(empty.native(), utils::MemoryMappedFile::READ_ONLY)) __debugbreak();
+        if (file.length() != 0 || file.data()) __debugbreak();
+        file.Close();
+        std::filesystem::remove(empty);
+        if (file.Initialize(empty.native(), utils::MemoryMappedFile::READ_ONLY)) __debugbreak();
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
+
+// Sums a 256MB file five times, read with fread() into a 64KB buffer and
+// mapped whole, and prints the time each takes. The file is in the page
+// cache after the first pass, so this measures the copy the mapping saves.
+int MEMORY_MAPPED_FILE_BENCHMARK(void) {
+    const size_t kSize = 256 << 20;
+    const int kPasses = 5;
+    const std::filesystem::path path = WriteTestFile("memory_mapped_file_benchmark.bin", kSize);
+    unsigned long long read_sum = 0, mapped_sum = 0;
+
+    auto read_time = TimeMicroseconds([&]() {
+        std::vector<unsigned char> buffer(64 << 10);
+        for (int pass = 0; pass < kPasses; ++pass) {
+            FILE* file = std::fopen(path.string().c_str(), "rb");
+            size_t read;
+            while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) != 0) {
+                for (size_t i = 0; i < read; ++i) read_sum += buffer[i];
+            }
+            std::fclose(file);
+        }
+    });
+    auto mapped_time = TimeMicroseconds([&]() {
+        for (int pass = 0; pass < kPasses; ++pass) {
+            utils::MemoryMappedFile file;
+            file.Initialize(path.native(), utils::MemoryMappedFile::READ_ONLY);
+            file.Advise(utils::MemoryMappedFile::SEQUENTIAL);
+            const uint8* data = file.data();
+            for (size_t i = 0; i < file.length(); ++i) mapped_sum += data[i];
+        }
+    });
+    std::filesystem::remove(path);
+
+    std::cout << "Sum 256MB x" << kPasses << ": fread " << read_time << "us, MemoryMappedFile " << mapped_time << "us"
+              << std::endl;
+    return read_sum == mapped_sum ? 0 : 1;
+}
+
+#endif // TEST
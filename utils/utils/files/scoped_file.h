@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_FILES_SCOPED_FILE_INCLUDE_H_
+#define UTILS_FILES_SCOPED_FILE_INCLUDE_H_
+
+#include <stddef.h>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+#include "utils/scoped_generic.h"
+
+#if defined(OS_WIN)
+#include <Windows.h>
+#elif defined(OS_POSIX)
+#include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace utils {
+
+// A range of a file mapped into memory, as mmap() or MapViewOfFile() made it.
+struct MappedRegion {
+    void* address = nullptr;
+    size_t length = 0;
+
+    bool operator==(const MappedRegion& other) const { return address == other.address && length == other.length; }
+    bool operator!=(const MappedRegion& other) const { return !(*this == other); }
+};
+
+namespace internal {
+
+#if defined(OS_POSIX)
+
+// close() is not retried on EINTR: Linux releases the descriptor either way,
+// and a retry could close one another thread has just opened.
+struct ScopedFDCloseTraits {
+    static int InvalidValue() { return -1; }
+    static void Free(int fd) { ::close(fd); }
+};
+
+struct ScopedDIRCloseTraits {
+    static DIR* InvalidValue() { return nullptr; }
+    static void Free(DIR* dir) { ::closedir(dir); }
+};
+
+#endif  // OS_POSIX
+
+struct ScopedMappedRegionTraits {
+    static MappedRegion InvalidValue() { return MappedRegion(); }
+    static void Free(const MappedRegion& region) {
+#if defined(OS_WIN)
+        ::UnmapViewOfFile(region.address);
+#elif defined(OS_POSIX)
+        ::munmap(region.address, region.length);
+#endif
+    }
+};
+
+} // namespace internal
+
+#if defined(OS_POSIX)
+using ScopedFD = ScopedGeneric<int, internal::ScopedFDCloseTraits>;
+using ScopedDIR = ScopedGeneric<DIR*, internal::ScopedDIRCloseTraits>;
+#endif
+
+using ScopedMappedRegion = ScopedGeneric<MappedRegion, internal::ScopedMappedRegionTraits>;
+
+} // namespace utils
+
+#endif  // !UTILS_FILES_SCOPED_FILE_INCLUDE_H_
@@ -15,10 +15,10 @@
 
 #include "scoped_ref_object.h"
 
-template<class Interface, bool RefCounted = false, const IID* id = &__uuidof(Interface)>
-class ScopedComObject : public scoped_refptr<Interface, RefCounted> {
+template<class Interface, const IID* id = &__uuidof(Interface)>
+class ScopedComObject : public scoped_refptr<Interface> {
 public:
-    using Parent = scoped_refptr<Interface, RefCounted>;
+    using Parent = scoped_refptr<Interface>;
     class IUnknownMethods : public Interface {
     private:
         STDMETHOD(QueryInterface)(REFIID iid, void** object) = 0;
@@ -31,9 +31,15 @@ public:
 
     explicit ScopedComObject(Interface* p) : Parent(p) {}
 
+    // Takes over the reference |p| holds, e.g. one an API returned.
+    ScopedComObject(Interface* p, AdoptRefTag) : Parent(p, kAdoptRef) {}
+
     ScopedComObject(const ScopedComObject<Interface>& p)
         : Parent(p) {}
 
+    ScopedComObject(ScopedComObject<Interface>&& p) noexcept
+        : Parent(std::move(p)) {}
+
     virtual ~ScopedComObject() {}
 
     ScopedComObject& operator=(std::nullptr_t) {
@@ -59,6 +65,11 @@ public:
         return *this;
     }
 
+    ScopedComObject& operator=(ScopedComObject&& p) noexcept {
+        ScopedComObject(std::move(p)).swap(*this);
+        return *this;
+    }
+
     template<class U>
     ScopedComObject& operator=(const ScopedComObject<U>& p) {
         ScopedComObject(other).swap(*this);
@@ -139,7 +150,7 @@ public:
         return reinterpret_cast<IUnknownMethods*>(ptr_);
     }
 
-    using scoped_refptr<Interface, RefCounted>::operator=;
+    using scoped_refptr<Interface>::operator=;
 
     static const IID& iid() {
         return *interface_id;
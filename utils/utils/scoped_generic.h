@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_SCOPED_GENERIC_INCLUDE_H_
+#define UTILS_SCOPED_GENERIC_INCLUDE_H_
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Owns a value of |T| and frees it with |Traits|, which provides
+// static T InvalidValue() and void Free(T). It has no platform dependencies,
+// so handle types of every platform build on it; see utils/files/scoped_file.h
+// and ScopedHANDLE in utils/files/file_util.h.
+template <typename T, typename Traits>
+class ScopedGeneric {
+  private:
+    // This must be first since it's used inline below.
+    struct Data : public Traits {
+        explicit Data(const T &in) : generic(in) {}
+        Data(const T &in, const Traits &other) : Traits(other), generic(in) {}
+        T generic;
+    };
+
+  public:
+    typedef T element_type;
+    typedef Traits traits_type;
+
+    ScopedGeneric() : data_(traits_type::InvalidValue()) {}
+    explicit ScopedGeneric(const element_type &value) : data_(value) {}
+    ScopedGeneric(const element_type &value, const traits_type &traits)
+        : data_(value, traits) {}
+    ScopedGeneric(ScopedGeneric<T, Traits> &&rvalue)
+        : data_(rvalue.release(), rvalue.get_traits()) {}
+
+    ~ScopedGeneric() { FreeIfNecessary(); }
+    ScopedGeneric &operator=(ScopedGeneric<T, Traits> &&rvalue) {
+        reset(rvalue.release());
+        return *this;
+    }
+    void reset(const element_type &value = traits_type::InvalidValue()) {
+        if (data_.generic != traits_type::InvalidValue() && data_.generic == value)
+            abort();
+        FreeIfNecessary();
+        data_.generic = value;
+    }
+    void swap(ScopedGeneric &other) {
+        if (&other == this) return;
+        std::swap(static_cast<Traits &>(data_), static_cast<Traits &>(other.data_));
+        std::swap(data_.generic, other.data_.generic);
+    }
+
+    element_type release() WARN_UNUSED_RESULT {
+        element_type old_generic = data_.generic;
+        data_.generic = traits_type::InvalidValue();
+        return old_generic;
+    }
+    class Receiver {
+      public:
+        explicit Receiver(ScopedGeneric &parent) : scoped_generic_(&parent) {
+            scoped_generic_->receiving_ = true;
+        }
+
+        ~Receiver() {
+            if (scoped_generic_)  {
+                scoped_generic_->reset(value_);
+                scoped_generic_->receiving_ = false;
+            }
+        }
+
+        Receiver(Receiver &&move) {
+            scoped_generic_ = move.scoped_generic_;
+            move.scoped_generic_ = nullptr;
+        }
+
+        Receiver &operator=(Receiver &&move) {
+            scoped_generic_ = move.scoped_generic_;
+            move.scoped_generic_ = nullptr;
+        }
+
+        // We hand out a pointer to a field in Receiver instead of directly to
+        // ScopedGeneric's internal storage in order to make it so that users can't
+        // accidentally silently break ScopedGeneric's invariants. This way, an
+        // incorrect use-after-scope-exit is more detectable by ASan or static
+        // analysis tools, as the pointer is only valid for the lifetime of the
+        // Receiver, not the ScopedGeneric.
+        T *get() {
+            used_ = true;
+            return &value_;
+        }
+
+      private:
+        T value_ = Traits::InvalidValue();
+        ScopedGeneric *scoped_generic_;
+        bool used_ = false;
+        DISALLOW_COPY_AND_ASSIGN(Receiver);
+    };
+    const element_type &get() const { return data_.generic; }
+    bool is_valid() const { return data_.generic != traits_type::InvalidValue(); }
+    bool operator==(const element_type &value) const { return data_.generic == value; }
+    bool operator!=(const element_type &value) const { return data_.generic != value; }
+    Traits &get_traits() { return data_; }
+    const Traits &get_traits() const { return data_; }
+
+  private:
+    void FreeIfNecessary() {
+        if (data_.generic != traits_type::InvalidValue()) {
+            data_.Free(data_.generic);
+            data_.generic = traits_type::InvalidValue();
+        }
+    }
+
+    template <typename T2, typename Traits2>
+    bool operator==(
+        const ScopedGeneric<T2, Traits2> &p2) const;
+    template <typename T2, typename Traits2>
+    bool operator!=(
+        const ScopedGeneric<T2, Traits2> &p2) const;
+
+    Data data_;
+    bool receiving_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedGeneric);
+};
+
+template <class T, class Traits>
+void swap(const ScopedGeneric<T, Traits> &a, const ScopedGeneric<T, Traits> &b) {
+    a.swap(b);
+}
+
+template <class T, class Traits>
+bool operator==(const T &value, const ScopedGeneric<T, Traits> &scoped) {
+    return value == scoped.get();
+}
+
+template <class T, class Traits>
+bool operator!=(const T &value, const ScopedGeneric<T, Traits> &scoped) {
+    return value != scoped.get();
+}
+
+#endif  // !UTILS_SCOPED_GENERIC_INCLUDE_H_
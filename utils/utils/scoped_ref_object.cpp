@@ -8,7 +8,9 @@
 
 #include "scoped_ref_object.h"
 
-#include <windows.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 #if defined(COMPILER_MSVC)
 // We usually use the _CrtDumpMemoryLeaks() with the DEBUGER and CRT library to
@@ -24,21 +26,82 @@
 #endif // VC++ DEBUG
 #endif // defined(COMPILER_MSVC)
 
+struct subtle::BiasedRefOwner {
+    std::mutex lock;
+    // Objects whose shared count went negative. Guarded by |lock|.
+    std::vector<const BiasedRefCounted*> queued;
+    std::atomic<bool> has_queued{ false };
+    // Set, under |lock|, once the thread has merged its queue for the last
+    // time; releases then merge for it.
+    bool exited = true;
+};
+
 namespace {
 
-inline auto AtomicIncrement(volatile int* ptr, int increment) {
-    return InterlockedExchangeAdd(
-        reinterpret_cast<volatile LONG*>(ptr),
-        static_cast<LONG>(increment)) + increment;
+// Records of exited threads, handed to new ones. A record outlives its
+// thread because objects keep pointing at it; a new thread simply takes
+// over the unmerged objects of the old one.
+struct BiasedRefOwnerPool {
+    std::mutex lock;
+    std::vector<subtle::BiasedRefOwner*> free;
+};
+
+BiasedRefOwnerPool& OwnerPool() {
+    static BiasedRefOwnerPool* pool = new BiasedRefOwnerPool;
+    return *pool;
 }
 
-inline bool AtomicIsOne(volatile int* ptr) {
-    auto value = *ptr;
-    return 1 == value;
+// The owner of merged objects. It stays exited and no thread has it.
+subtle::BiasedRefOwner* MergedOwner() {
+    static subtle::BiasedRefOwner* merged = new subtle::BiasedRefOwner;
+    return merged;
 }
 
+// Set once the thread's record has been given back; objects it claims after
+// that, from other thread-local destructors, start out merged.
+thread_local bool thread_exiting = false;
+
+// Gives the record back when the thread exits.
+struct ThreadBiasedRefOwner {
+    ~ThreadBiasedRefOwner() {
+        subtle::BiasedRefOwner* const owner = subtle::CurrentBiasedRefOwner();
+        if (!owner) return;
+        // Other threads may queue more until |exited| is set.
+        for (bool exited = false; !exited;) {
+            subtle::BiasedRefCounted::MergeQueued();
+            std::lock_guard<std::mutex> lock(owner->lock);
+            exited = owner->exited = owner->queued.empty();
+        }
+        subtle::CurrentBiasedRefOwner() = nullptr;
+        thread_exiting = true;
+        BiasedRefOwnerPool& pool = OwnerPool();
+        std::lock_guard<std::mutex> lock(pool.lock);
+        pool.free.push_back(owner);
+    }
+};
+
+// Returns the record of the calling thread, taking one on first use, or null
+// while the thread exits.
+subtle::BiasedRefOwner* AcquireBiasedRefOwner() {
+    subtle::BiasedRefOwner*& owner = subtle::CurrentBiasedRefOwner();
+    if (owner || thread_exiting) return owner;
+    static thread_local ThreadBiasedRefOwner thread_owner;
+    BiasedRefOwnerPool& pool = OwnerPool();
+    {
+        std::lock_guard<std::mutex> lock(pool.lock);
+        if (!pool.free.empty()) {
+            owner = pool.free.back();
+            pool.free.pop_back();
+        }
+    }
+    if (!owner) owner = new subtle::BiasedRefOwner;
+    std::lock_guard<std::mutex> lock(owner->lock);
+    owner->exited = false;
+    return owner;
 }
 
+}  // namespace
+
 subtle::RefCounted::RefCounted() {
 
 }
@@ -67,14 +130,122 @@ subtle::AtomicRefCounted::~AtomicRefCounted() {
 
 }
 
-void subtle::AtomicRefCounted::AddRef() const {
-    AtomicIncrement(&ref_count_, 1);
+subtle::BiasedRefCounted::BiasedRefCounted() {
+
+}
+
+subtle::BiasedRefCounted::~BiasedRefCounted() {
+
+}
+
+bool subtle::BiasedRefCounted::OneRef() const {
+    BiasedRefOwner* const owner = owner_.load(std::memory_order_acquire);
+    const int64_t shared = shared_count_.load(std::memory_order_acquire);
+    if (shared & kMerged) return (shared >> kCountShift) == 1;
+    if (owner == CurrentBiasedRefOwner() && owner != nullptr) return biased_count_ + (shared >> kCountShift) == 1;
+    return false;
+}
+
+void subtle::BiasedRefCounted::MergeQueued() {
+    BiasedRefOwner* const owner = CurrentBiasedRefOwner();
+    if (!owner) return;
+    // One at a time: freeing an object can release others in the queue,
+    // which then merge and leave it themselves.
+    for (;;) {
+        const BiasedRefCounted* object;
+        {
+            std::lock_guard<std::mutex> lock(owner->lock);
+            if (owner->queued.empty()) {
+                owner->has_queued.store(false, std::memory_order_relaxed);
+                return;
+            }
+            object = owner->queued.back();
+            owner->queued.pop_back();
+        }
+        if (object->MergeOnOwner()) delete object;
+    }
+}
+
+void subtle::BiasedRefCounted::ClaimAndAddRef() const {
+    BiasedRefOwner* const current = AcquireBiasedRefOwner();
+    if (current && current->has_queued.load(std::memory_order_relaxed)) MergeQueued();
+    BiasedRefOwner* expected = nullptr;
+    if (owner_.compare_exchange_strong(expected, current ? current : MergedOwner(), std::memory_order_acq_rel)) {
+        if (current) {
+            ++biased_count_;
+            return;
+        }
+        shared_count_.fetch_add(kMerged, std::memory_order_relaxed);
+    }
+    // Another thread claimed it first, or this one is exiting.
+    shared_count_.fetch_add(kOne, std::memory_order_relaxed);
+}
+
+// Runs on the owning thread, whose count is folded into the shared one.
+// Once the add publishes kMerged another thread's release can free the
+// object, so |owner_| and |biased_count_| are written before it.
+bool subtle::BiasedRefCounted::MergeOnOwner() const {
+    BiasedRefOwner* const owner = owner_.load(std::memory_order_relaxed);
+    const int64_t add = biased_count_ * kOne + kMerged;
+    biased_count_ = 0;
+    owner_.store(MergedOwner(), std::memory_order_release);
+    const int64_t shared = shared_count_.fetch_add(add, std::memory_order_acq_rel) + add;
+    if (shared & kQueued) {
+        // The queueing thread held the lock from setting kQueued to pushing.
+        // |this| is only compared with the queued pointers, never read.
+        std::lock_guard<std::mutex> lock(owner->lock);
+        owner->queued.erase(std::remove(owner->queued.begin(), owner->queued.end(), this), owner->queued.end());
+    }
+    return (shared >> kCountShift) == 0;
 }
 
-bool subtle::AtomicRefCounted::Release() const {
-    return (0 == AtomicIncrement(&ref_count_, -1));
+bool subtle::BiasedRefCounted::ReleaseShared() const {
+    int64_t shared = shared_count_.load(std::memory_order_relaxed);
+    for (;;) {
+        if (shared & kMerged)
+            return ((shared_count_.fetch_sub(kOne, std::memory_order_acq_rel) - kOne) >> kCountShift) == 0;
+        // The owner holds the rest, or will once it merges.
+        if (shared - kOne < 0 && !(shared & kQueued)) return ReleaseToOwner();
+        if (shared_count_.compare_exchange_weak(shared, shared - kOne, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+            return false;
+        }
+    }
 }
 
-bool subtle::AtomicRefCounted::OneRef() const {
-    return AtomicIsOne(&ref_count_);
+// The shared count is going negative: queue the object for its owner, or
+// merge it here if the owner has exited.
+bool subtle::BiasedRefCounted::ReleaseToOwner() const {
+    BiasedRefOwner* const owner = owner_.load(std::memory_order_acquire);
+    if (owner == MergedOwner()) {
+        // A merge has written |owner_| and may not have added its count yet;
+        // whichever of the two operations comes second sees the final count.
+        const int64_t shared = shared_count_.fetch_sub(kOne, std::memory_order_acq_rel) - kOne;
+        return (shared & kMerged) && (shared >> kCountShift) == 0;
+    }
+    std::lock_guard<std::mutex> lock(owner->lock);
+    int64_t shared = shared_count_.load(std::memory_order_relaxed);
+    if (owner->exited && !(shared & kMerged)) {
+        // The owner's last write to |biased_count_| came before it set
+        // |exited| under the lock, and while the lock is held no thread takes
+        // the record over or merges the object elsewhere.
+        const int64_t add = biased_count_ * kOne + kMerged - kOne;
+        biased_count_ = 0;
+        owner_.store(MergedOwner(), std::memory_order_release);
+        return ((shared_count_.fetch_add(add, std::memory_order_acq_rel) + add) >> kCountShift) == 0;
+    }
+    for (;;) {
+        if (shared & kMerged)
+            return ((shared_count_.fetch_sub(kOne, std::memory_order_acq_rel) - kOne) >> kCountShift) == 0;
+        int64_t next = shared - kOne;
+        const bool queue = next < 0 && !(shared & kQueued);
+        if (queue) next |= kQueued;
+        if (!shared_count_.compare_exchange_weak(shared, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+            continue;
+        if (queue) {
+            owner->queued.push_back(this);
+            owner->has_queued.store(true, std::memory_order_relaxed);
+        }
+        return false;
+    }
 }
@@ -10,6 +10,15 @@
 #ifndef DIRECTX_SCOPED_REF_OBJECT_INCLUDE_H_ 
 #define DIRECTX_SCOPED_REF_OBJECT_INCLUDE_H_ 
 
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <utility>
+
+#include "utils.h"
+
 namespace subtle {
 
 class RefCounted {
@@ -29,23 +38,110 @@ private:
     void operator=(const RefCounted&) = delete;
 };
 
+// Taking a reference only needs the count to change atomically, so AddRef()
+// is a relaxed increment. The last Release() must see every write the other
+// threads made to the object before their own Release(), so decrements are
+// acquire-release.
 class AtomicRefCounted {
 public:
-    bool OneRef() const;
+    bool OneRef() const { return ref_count_.load(std::memory_order_acquire) == 1; }
 
 protected:
     explicit AtomicRefCounted();
     virtual ~AtomicRefCounted();
 
-    void AddRef() const;
-    bool Release() const;
+    void AddRef() const { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+    bool Release() const { return ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    // Takes a reference unless the last one has already gone, for a weak
+    // pointer that races with the last Release().
+    bool TryAddRef() const {
+        int count = ref_count_.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (ref_count_.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
 
 private:
-    mutable int ref_count_ = 0;
+    mutable std::atomic<int> ref_count_{ 0 };
     AtomicRefCounted(const AtomicRefCounted&) = delete;
     void operator=(const AtomicRefCounted&) = delete;
 };
 
+// The per-thread side of BiasedRefCounted, defined in the .cpp.
+struct BiasedRefOwner;
+
+// The record of the calling thread, or null before it first claims a biased
+// object.
+inline BiasedRefOwner*& CurrentBiasedRefOwner() {
+    static thread_local BiasedRefOwner* owner = nullptr;
+    return owner;
+}
+
+// A count for objects that one thread references far more often than the
+// others, after "Biased Reference Counting" (Choi et al., PACT 2018). The
+// first thread to take a reference owns the object and counts its own
+// references in a plain integer; the other threads count theirs in an atomic
+// one, which goes negative when they release references the owner took.
+//
+// The two counts are merged, and the object is counted atomically from then
+// on, when the owner's count drops to zero, or, once the shared count has
+// gone negative, when the owner next claims an object, calls MergeQueued() or
+// exits; objects whose owner has exited are merged by the thread that
+// releases them. Only a merge can free the object.
+class UTILS_API BiasedRefCounted {
+public:
+    // Exact on the owning thread and after the merge; false on other threads
+    // before it.
+    bool OneRef() const;
+
+    // Merges the objects other threads queued for the calling thread and
+    // frees those with no references left.
+    static void MergeQueued();
+
+protected:
+    explicit BiasedRefCounted();
+    virtual ~BiasedRefCounted();
+
+    void AddRef() const {
+        BiasedRefOwner* const owner = owner_.load(std::memory_order_relaxed);
+        if (owner == CurrentBiasedRefOwner() && owner != nullptr) ++biased_count_;
+        else if (owner == nullptr) ClaimAndAddRef();
+        else shared_count_.fetch_add(kOne, std::memory_order_relaxed);
+    }
+
+    bool Release() const {
+        BiasedRefOwner* const owner = owner_.load(std::memory_order_relaxed);
+        if (owner == CurrentBiasedRefOwner() && owner != nullptr) {
+            if (--biased_count_ > 0) return false;
+            return MergeOnOwner();
+        }
+        return ReleaseShared();
+    }
+
+private:
+    // |shared_count_| holds the count of the other threads above two flags.
+    static const int64_t kMerged = 1;
+    static const int64_t kQueued = 2;
+    static const int kCountShift = 2;
+    static const int64_t kOne = 1 << kCountShift;
+
+    void ClaimAndAddRef() const;
+    bool MergeOnOwner() const;
+    bool ReleaseShared() const;
+    bool ReleaseToOwner() const;
+
+    // Null until claimed, then the owner's record, and a shared record with
+    // no thread once merged.
+    mutable std::atomic<BiasedRefOwner*> owner_{ nullptr };
+    mutable int64_t biased_count_ = 0;
+    mutable std::atomic<int64_t> shared_count_{ 0 };
+
+    BiasedRefCounted(const BiasedRefCounted&) = delete;
+    void operator=(const BiasedRefCounted&) = delete;
+};
+
 } // subtle
 
 template <typename T>
@@ -53,7 +149,7 @@ class RefObject : public subtle::RefCounted {
 public:
     RefObject() {}
 
-    void AddRef() const override {
+    void AddRef() const {
         subtle::RefCounted::AddRef();
     }
 
@@ -71,37 +167,97 @@ private:
     void operator=(const RefObject<T>&) = delete;
 };
 
-template<typename T>
+template <typename T, typename Traits>
+class AtomicRefObject;
+
+// Deletes an AtomicRefObject as soon as its last reference goes. Traits with a
+// static Destruct(const T*) may do it later or elsewhere instead, e.g.
+// utils::DeferredDestructionTraits in utils/epoch.h, and call the object's
+// AtomicRefObject::DeleteInternal() when they do.
+template <typename T>
+struct DefaultAtomicRefObjectTraits {
+    static void Destruct(const T* object) {
+        AtomicRefObject<T, DefaultAtomicRefObjectTraits>::DeleteInternal(object);
+    }
+};
+
+template<typename T, typename Traits = DefaultAtomicRefObjectTraits<T>>
 class AtomicRefObject : public subtle::AtomicRefCounted {
 public:
     AtomicRefObject() {}
 
     void AddRef() const {
-        subtle::RefCountedThreadSafeBase::AddRef();
+        subtle::AtomicRefCounted::AddRef();
+    }
+
+    bool TryAddRef() const {
+        return subtle::AtomicRefCounted::TryAddRef();
     }
 
     void Release() const {
-        if (subtle::RefCountedThreadSafeBase::Release()) {
-            delete static_cast<const T*>(this);
+        if (subtle::AtomicRefCounted::Release()) {
+            Traits::Destruct(static_cast<const T*>(this));
         }
     }
 protected:
     virtual ~AtomicRefObject() {}
 
 private:
-    AtomicRefObject<T>(const AtomicRefObject<T>&) = delete;
-    void operator=(const AtomicRefObject<T>&) = delete;
+    friend Traits;
+    static void DeleteInternal(const T* object) { delete object; }
+
+    AtomicRefObject(const AtomicRefObject&) = delete;
+    void operator=(const AtomicRefObject&) = delete;
+};
+
+// An AtomicRefObject whose owning thread counts without atomics; see
+// subtle::BiasedRefCounted. Suits objects that one thread creates, copies
+// and drops references to in a loop while others hold a few.
+template<typename T>
+class BiasedRefObject : public subtle::BiasedRefCounted {
+public:
+    BiasedRefObject() {}
+
+    void AddRef() const {
+        subtle::BiasedRefCounted::AddRef();
+    }
+
+    void Release() const {
+        if (subtle::BiasedRefCounted::Release()) {
+            delete static_cast<const T*>(this);
+        }
+    }
+protected:
+    virtual ~BiasedRefObject() {}
+
+private:
+    BiasedRefObject<T>(const BiasedRefObject<T>&) = delete;
+    void operator=(const BiasedRefObject<T>&) = delete;
 };
 
-template<typename T, bool RefCounted = false>
+// Passed with a pointer to take over the reference it already holds, such as
+// one a COM factory returned, instead of adding one.
+struct AdoptRefTag {};
+constexpr AdoptRefTag kAdoptRef = AdoptRefTag();
+
+// Holds a reference to |T|. Moving hands the reference over, so returning one
+// or growing a container of them never touches the count; nor do swap() and
+// release().
+template<typename T>
 class scoped_refptr {
 public:
+    typedef T element_type;
+
     scoped_refptr() {}
 
+    scoped_refptr(std::nullptr_t) {}
+
     scoped_refptr(T* p) : ptr_(p) {
-        if (ptr_ && !RefCounted) ptr_->AddRef();
+        if (ptr_) ptr_->AddRef();
     }
 
+    scoped_refptr(T* p, AdoptRefTag) : ptr_(p) {}
+
     scoped_refptr(const scoped_refptr<T>& r) : ptr_(r.ptr_) {
         if (ptr_) ptr_->AddRef();
     }
@@ -111,6 +267,13 @@ public:
         if (ptr_) ptr_->AddRef();
     }
 
+    scoped_refptr(scoped_refptr<T>&& r) noexcept : ptr_(r.ptr_) {
+        r.ptr_ = nullptr;
+    }
+
+    template <typename U>
+    scoped_refptr(scoped_refptr<U>&& r) noexcept : ptr_(r.release()) {}
+
     ~scoped_refptr() {
         if (ptr_) ptr_->Release();
     }
@@ -139,6 +302,30 @@ public:
         return *this = r.get();
     }
 
+    scoped_refptr<T>& operator=(scoped_refptr<T>&& r) noexcept {
+        scoped_refptr<T>(std::move(r)).swap(*this);
+        return *this;
+    }
+
+    template <typename U>
+    scoped_refptr<T>& operator=(scoped_refptr<U>&& r) noexcept {
+        scoped_refptr<T>(std::move(r)).swap(*this);
+        return *this;
+    }
+
+    // Drops the reference, if any.
+    void reset() {
+        scoped_refptr<T>().swap(*this);
+    }
+
+    // Returns the pointer with the reference it holds, which the caller must
+    // Release(), and leaves this empty.
+    T* release() {
+        T* p = ptr_;
+        ptr_ = nullptr;
+        return p;
+    }
+
     void swap(T** pp) {
         T* p = ptr_;
         ptr_ = *pp;
@@ -156,5 +343,24 @@ scoped_refptr<T> make_scoped_refptr(T* t) {
     return scoped_refptr<T>(t);
 }
 
+// Constructs a |T| and returns the first reference to it.
+// Example:
+//   scoped_refptr<Texture> texture = MakeRefCounted<Texture>(width, height);
+template <typename T, typename... Args>
+scoped_refptr<T> MakeRefCounted(Args&&... args) {
+    return scoped_refptr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Takes over the reference |t| holds.
+template <typename T>
+scoped_refptr<T> AdoptRef(T* t) {
+    return scoped_refptr<T>(t, kAdoptRef);
+}
+
+template <typename T>
+void swap(scoped_refptr<T>& a, scoped_refptr<T>& b) {
+    a.swap(b);
+}
+
 
 #endif  // !#define (DIRECTX_SCOPED_REF_OBJECT_INCLUDE_H_ )
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include <Windows.h>
+#include "utils/scoped_ref_object.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifdef TEST
+
+namespace {
+
+std::atomic<int> destroyed(0);
+
+class Plain : public RefObject<Plain> {
+public:
+    ~Plain() { ++destroyed; }
+};
+
+class Atomic : public AtomicRefObject<Atomic> {
+public:
+    ~Atomic() { ++destroyed; }
+};
+
+class Biased : public BiasedRefObject<Biased> {
+public:
+    ~Biased() { ++destroyed; }
+};
+
+// Counts every AddRef() and Release() scoped_refptr makes.
+long long count_operations = 0;
+
+class Counted : public AtomicRefObject<Counted> {
+public:
+    explicit Counted(int value = 0) : value(value) {}
+    ~Counted() { ++destroyed; }
+
+    void AddRef() const {
+        ++count_operations;
+        AtomicRefObject<Counted>::AddRef();
+    }
+
+    void Release() const {
+        ++count_operations;
+        AtomicRefObject<Counted>::Release();
+    }
+
+    const int value;
+};
+
+class Derived : public Counted {
+public:
+    Derived() : Counted(1) {}
+};
+
+// scoped_refptr as it was: the copy constructor hides the move, so a
+// growing vector copies each element and then drops the old one.
+template <typename T>
+class CopyingRefptr : public scoped_refptr<T> {
+public:
+    explicit CopyingRefptr(T* p) : scoped_refptr<T>(p) {}
+    CopyingRefptr(const CopyingRefptr& r) : scoped_refptr<T>(r) {}
+};
+
+// Grows a vector to |size| references to |object| and returns the number of
+// reallocations.
+template <typename Pointer, typename T>
+int Grow(std::vector<Pointer>* pointers, T* object, size_t size) {
+    int reallocations = 0;
+    for (size_t i = 0; i < size; ++i) {
+        reallocations += pointers->size() == pointers->capacity();
+        pointers->push_back(Pointer(object));
+    }
+    return reallocations;
+}
+
+// Takes and drops |count| references to |object| from each of |threads|
+// threads at once.
+template <typename T>
+void CopyOnThreads(const scoped_refptr<T>& object, int threads, int count) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&object, count]() {
+            for (int k = 0; k < count; ++k) scoped_refptr<T> copy(object);
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+// AddRef()/Release() pairs on |object| from the calling thread.
+template <typename T>
+void Hammer(const T* object, int count) {
+    for (int i = 0; i < count; ++i) {
+        object->AddRef();
+        object->Release();
+    }
+}
+
+}  // namespace
+
+int SCOPED_REF_OBJECT_TEST(void) {
+    {
+        scoped_refptr<Plain> plain(new Plain);
+        scoped_refptr<Plain> copy(plain);
+        if (plain->OneRef()) __debugbreak();
+        copy = nullptr;
+        if (!plain->OneRef()) __debugbreak();
+    }
+    if (destroyed != 1) __debugbreak();
+
+    // The atomic count from several threads at once.
+    {
+        scoped_refptr<Atomic> atomic(new Atomic);
+        CopyOnThreads(atomic, 4, 100000);
+        if (!atomic->OneRef() || destroyed != 1) __debugbreak();
+    }
+    if (destroyed != 2) __debugbreak();
+
+    // The owner counts alone until other threads copy too; it is freed when
+    // the owner drops the last reference.
+    {
+        scoped_refptr<Biased> biased(new Biased);
+        scoped_refptr<Biased> copy(biased);
+        if (biased->OneRef()) __debugbreak();
+        copy = nullptr;
+        if (!biased->OneRef()) __debugbreak();
+        CopyOnThreads(biased, 4, 100000);
+        if (!biased->OneRef() || destroyed != 2) __debugbreak();
+    }
+    if (destroyed != 3) __debugbreak();
+
+    // References the owner took and another thread dropped send the shared
+    // count negative; the object waits in the owner's queue.
+    Biased* migrated = new Biased;
+    for (int i = 0; i < 3; ++i) migrated->AddRef();
+    std::thread([migrated]() {
+        for (int i = 0; i < 3; ++i) migrated->Release();
+    }).join();
+    if (destroyed != 3) __debugbreak();
+    subtle::BiasedRefCounted::MergeQueued();
+    if (destroyed != 4) __debugbreak();
+
+    // Once the owner has exited, the thread releasing the last reference
+    // merges and frees it.
+    Biased* orphan = nullptr;
+    std::thread([&orphan]() {
+        orphan = new Biased;
+        orphan->AddRef();
+        orphan->AddRef();
+    }).join();
+    orphan->Release();
+    if (destroyed != 4) __debugbreak();
+    orphan->Release();
+    if (destroyed != 5) __debugbreak();
+
+    // Threads own objects and hand references they took to each other, so
+    // every path runs at once; each object is freed exactly once.
+    const int kThreads = 4;
+    const int kObjects = 2000;
+    std::mutex lock;
+    std::vector<Biased*> handed;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 random(t);
+            std::vector<Biased*> held;
+            for (int i = 0; i < kObjects; ++i) {
+                Biased* object = new Biased;
+                object->AddRef();
+                for (int k = random() % 4; k > 0; --k) {
+                    object->AddRef();
+                    std::lock_guard<std::mutex> guard(lock);
+                    handed.push_back(object);
+                }
+                held.push_back(object);
+                std::vector<Biased*> taken;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    for (int k = random() % 4; k > 0 && !handed.empty(); --k) {
+                        taken.push_back(handed.back());
+                        handed.pop_back();
+                    }
+                }
+                for (Biased* other : taken) other->Release();
+                if (random() % 2) {
+                    held.back()->Release();
+                    held.pop_back();
+                }
+            }
+            for (Biased* object : held) object->Release();
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    for (Biased* object : handed) object->Release();
+    handed.clear();
+    if (destroyed != 5 + kThreads * kObjects) __debugbreak();
+
+    // An owner hands three references to each object to three consumers and
+    // keeps one, merging what they queue as it goes, then exits with objects
+    // still out, which the consumers merge. The merging thread and the one
+    // that frees the object race at every hand-off.
+    const int kRounds = 40;
+    const int kHandOffs = 500;
+    std::atomic<bool> done(false);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&]() {
+            for (;;) {
+                Biased* object = nullptr;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!handed.empty()) {
+                        object = handed.back();
+                        handed.pop_back();
+                    }
+                }
+                if (object) object->Release();
+                else if (done) return;
+                else std::this_thread::yield();
+            }
+        });
+    }
+    for (int round = 0; round < kRounds; ++round) {
+        std::thread([&, round]() {
+            std::mt19937 random(round);
+            std::vector<Biased*> held;
+            for (int i = 0; i < kHandOffs; ++i) {
+                Biased* object = new Biased;
+                for (int k = 0; k < 4; ++k) object->AddRef();
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    for (int k = 0; k < 3; ++k) handed.push_back(object);
+                }
+                if (random() % 2) object->Release();
+                else held.push_back(object);
+                if (random() % 8 == 0) subtle::BiasedRefCounted::MergeQueued();
+            }
+            for (Biased* object : held) object->Release();
+        }).join();
+    }
+    done = true;
+    for (std::thread& consumer : consumers) consumer.join();
+    if (destroyed != 5 + kThreads * kObjects + kRounds * kHandOffs) __debugbreak();
+    destroyed = 0;
+
+    // Moving, swapping and releasing hand the reference over untouched.
+    {
+        scoped_refptr<Counted> counted = MakeRefCounted<Counted>(7);
+        if (counted->value != 7 || count_operations != 1) __debugbreak();
+        scoped_refptr<Counted> moved(std::move(counted));
+        scoped_refptr<Counted> assigned;
+        assigned = std::move(moved);
+        if (counted || moved || !assigned->OneRef() || count_operations != 1) __debugbreak();
+        scoped_refptr<Counted> other = MakeRefCounted<Counted>();
+        swap(assigned, other);
+        if (assigned->value != 0 || other->value != 7 || count_operations != 2) __debugbreak();
+        assigned = std::move(other);
+        if (destroyed != 1 || assigned->value != 7 || other || count_operations != 3) __debugbreak();
+        scoped_refptr<Counted> self(assigned);
+        self = std::move(self);
+        self = self;
+        if (!self || assigned->OneRef()) __debugbreak();
+        self.reset();
+        if (self || !assigned->OneRef()) __debugbreak();
+        Counted* raw = assigned.release();
+        if (assigned || !raw->OneRef()) __debugbreak();
+        scoped_refptr<Counted> adopted(raw, kAdoptRef);
+        Counted* fresh = new Counted(3);
+        fresh->AddRef();
+        scoped_refptr<Counted> adopted_too = AdoptRef(fresh);
+        if (!adopted->OneRef() || !adopted_too->OneRef()) __debugbreak();
+        count_operations = 0;
+        scoped_refptr<Counted> base = MakeRefCounted<Derived>();
+        scoped_refptr<Counted> base_too;
+        base_too = scoped_refptr<Derived>(new Derived);
+        if (base->value != 1 || base_too->value != 1 || count_operations != 2) __debugbreak();
+    }
+    if (destroyed != 5) __debugbreak();
+
+    // Growing a vector moves each element.
+    {
+        scoped_refptr<Counted> counted = MakeRefCounted<Counted>();
+        std::vector<scoped_refptr<Counted>> pointers;
+        count_operations = 0;
+        if (Grow(&pointers, counted.get(), 1000) < 2 || count_operations != 1000) __debugbreak();
+        pointers.clear();
+        if (!counted->OneRef() || count_operations != 2000) __debugbreak();
+    }
+    return 0;
+}
+
+// Times 20M AddRef()/Release() pairs on one thread for each count, then on
+// an object that three other threads keep copying at the same time, and
+// prints the time the main thread takes. Then counts the AddRef()/Release()
+// calls a growing vector of scoped_refptr makes per reallocation, copying
+// as before move support and moving now.
+int SCOPED_REF_OBJECT_BENCHMARK(void) {
+    const int kPairs = 20000000;
+    scoped_refptr<Plain> plain(new Plain);
+    scoped_refptr<Atomic> atomic(new Atomic);
+    scoped_refptr<Biased> biased(new Biased);
+    std::cout << "Uncontended: RefObject " << TimeMicroseconds([&]() { Hammer(plain.get(), kPairs); })
+              << "us, AtomicRefObject " << TimeMicroseconds([&]() { Hammer(atomic.get(), kPairs); })
+              << "us, BiasedRefObject " << TimeMicroseconds([&]() { Hammer(biased.get(), kPairs); }) << "us"
+              << std::endl;
+
+    auto contended = [kPairs](auto* object) {
+        std::atomic<bool> done(false);
+        std::vector<std::thread> others;
+        for (int i = 0; i < 3; ++i) {
+            others.emplace_back([object, &done]() {
+                while (!done) Hammer(object, 1000);
+            });
+        }
+        const long long time = TimeMicroseconds([&]() { Hammer(object, kPairs); });
+        done = true;
+        for (std::thread& other : others) other.join();
+        return time;
+    };
+    std::cout << "With 3 threads copying: AtomicRefObject " << contended(atomic.get()) << "us, BiasedRefObject "
+              << contended(biased.get()) << "us" << std::endl;
+
+    // Count operations each vector reallocation makes, growing 100 vectors
+    // to 100000 references, with copies and with moves.
+    const size_t kSize = 100000;
+    scoped_refptr<Counted> counted = MakeRefCounted<Counted>();
+    long long operations[2] = {};
+    long long times[2] = {};
+    int reallocations = 0;
+    for (int moving = 0; moving < 2; ++moving) {
+        times[moving] = TimeMicroseconds([&]() {
+            for (int i = 0; i < 100; ++i) {
+                count_operations = 0;
+                if (moving) {
+                    std::vector<scoped_refptr<Counted>> pointers;
+                    reallocations = Grow(&pointers, counted.get(), kSize);
+                } else {
+                    std::vector<CopyingRefptr<Counted>> pointers;
+                    reallocations = Grow(&pointers, counted.get(), kSize);
+                }
+                // Less the AddRef() and Release() of each element itself.
+                operations[moving] += count_operations - 2 * kSize;
+            }
+        });
+    }
+    std::cout << "Count operations per reallocation: copying " << operations[0] / (100 * reallocations) << " ("
+              << times[0] << "us), moving " << operations[1] / (100 * reallocations) << " (" << times[1] << "us)"
+              << std::endl;
+    return plain->OneRef() && atomic->OneRef() && biased->OneRef() && counted->OneRef() ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_SIMD_INCLUDE_H_
+#define UTILS_SIMD_INCLUDE_H_
+
+// Thin SSE2/AVX2 lane helpers shared by the vectorized string kernels. They
+// are overloaded on the code unit type so a single kernel body serves both
+// char and 16-bit char16 strings. Only include this from .cpp files that pick
+// a kernel at runtime with utils::CPU; the AVX2 helpers must never run on a
+// machine without AVX2. An AVX2 kernel that hands its tail to an SSE2 one
+// calls _mm256_zeroupper() first, or the switch costs more than the tail.
+
+#include <type_traits>
+
+#include "utils/basictypes.h"
+#include "utils/bits.h"
+#include "utils/compiler.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#include <immintrin.h>
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+namespace utils {
+namespace simd {
+
+// Returns the index of the lowest set bit of |mask|, which must not be 0.
+inline uint32 LowestSetBit(uint32 mask) {
+    return bits::CountTrailingZeroBits(mask);
+}
+
+// Returns the index of the highest set bit of |mask|, which must not be 0.
+inline uint32 HighestSetBit(uint32 mask) {
+    return bits::Log2Floor(mask);
+}
+
+// Number of code units per register. The movemask of a compare has one bit
+// per byte, so a 16-bit lane shows up as two bits; divide bit offsets by
+// sizeof(Char) to get character offsets.
+template <typename Char>
+struct Lanes {
+    static const size_t k128 = sizeof(__m128i) / sizeof(Char);
+    static const size_t k256 = sizeof(__m256i) / sizeof(Char);
+};
+
+TARGET_ISA("sse2") inline __m128i Load128(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+TARGET_ISA("sse2") inline void Store128(void* p, __m128i v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+TARGET_ISA("sse2") inline uint32 MoveMask128(__m128i v) { return static_cast<uint32>(_mm_movemask_epi8(v)); }
+
+TARGET_ISA("sse2") inline __m128i Broadcast128(char c) { return _mm_set1_epi8(c); }
+TARGET_ISA("sse2") inline __m128i Broadcast128(char16 c) { return _mm_set1_epi16(static_cast<short>(c)); }
+TARGET_ISA("sse2") inline __m128i Equal128(__m128i a, __m128i b, char) { return _mm_cmpeq_epi8(a, b); }
+TARGET_ISA("sse2") inline __m128i Equal128(__m128i a, __m128i b, char16) { return _mm_cmpeq_epi16(a, b); }
+TARGET_ISA("sse2") inline __m128i Add128(__m128i a, __m128i b, char) { return _mm_add_epi8(a, b); }
+TARGET_ISA("sse2") inline __m128i Add128(__m128i a, __m128i b, char16) { return _mm_add_epi16(a, b); }
+// Signed compare; see InRange128() for the unsigned range trick.
+TARGET_ISA("sse2") inline __m128i Less128(__m128i a, __m128i b, char) { return _mm_cmplt_epi8(a, b); }
+TARGET_ISA("sse2") inline __m128i Less128(__m128i a, __m128i b, char16) { return _mm_cmplt_epi16(a, b); }
+
+// Returns all-ones in the lanes of |v| that lie in [lo, lo + count). SSE has
+// no unsigned compare, so the range is shifted to start at the lowest signed
+// value and tested with a single signed less-than.
+template <typename Char>
+TARGET_ISA("sse2") inline __m128i InRange128(__m128i v, Char lo, Char count) {
+    typedef typename std::make_unsigned<Char>::type Unsigned;
+    const Unsigned sign = static_cast<Unsigned>(Unsigned(1) << (sizeof(Char) * 8 - 1));
+    const __m128i shifted = Add128(v, Broadcast128(static_cast<Char>(sign - static_cast<Unsigned>(lo))), Char());
+    return Less128(shifted, Broadcast128(static_cast<Char>(sign + static_cast<Unsigned>(count))), Char());
+}
+
+TARGET_ISA("avx2") inline __m256i Load256(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+TARGET_ISA("avx2") inline void Store256(void* p, __m256i v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+TARGET_ISA("avx2") inline uint32 MoveMask256(__m256i v) { return static_cast<uint32>(_mm256_movemask_epi8(v)); }
+
+TARGET_ISA("avx2") inline __m256i Broadcast256(char c) { return _mm256_set1_epi8(c); }
+TARGET_ISA("avx2") inline __m256i Broadcast256(char16 c) { return _mm256_set1_epi16(static_cast<short>(c)); }
+TARGET_ISA("avx2") inline __m256i Equal256(__m256i a, __m256i b, char) { return _mm256_cmpeq_epi8(a, b); }
+TARGET_ISA("avx2") inline __m256i Equal256(__m256i a, __m256i b, char16) { return _mm256_cmpeq_epi16(a, b); }
+TARGET_ISA("avx2") inline __m256i Add256(__m256i a, __m256i b, char) { return _mm256_add_epi8(a, b); }
+TARGET_ISA("avx2") inline __m256i Add256(__m256i a, __m256i b, char16) { return _mm256_add_epi16(a, b); }
+TARGET_ISA("avx2") inline __m256i Less256(__m256i a, __m256i b, char) { return _mm256_cmpgt_epi8(b, a); }
+TARGET_ISA("avx2") inline __m256i Less256(__m256i a, __m256i b, char16) { return _mm256_cmpgt_epi16(b, a); }
+
+template <typename Char>
+TARGET_ISA("avx2") inline __m256i InRange256(__m256i v, Char lo, Char count) {
+    typedef typename std::make_unsigned<Char>::type Unsigned;
+    const Unsigned sign = static_cast<Unsigned>(Unsigned(1) << (sizeof(Char) * 8 - 1));
+    const __m256i shifted = Add256(v, Broadcast256(static_cast<Char>(sign - static_cast<Unsigned>(lo))), Char());
+    return Less256(shifted, Broadcast256(static_cast<Char>(sign + static_cast<Unsigned>(count))), Char());
+}
+
+} // namespace simd
+} // namespace utils
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+#endif  // !UTILS_SIMD_INCLUDE_H_
@@ -9,11 +9,32 @@
 #ifndef UTILS_STL_UTIL_INCLUDE_H_
 #define UTILS_STL_UTIL_INCLUDE_H_
 
+#include <assert.h>
+
 #include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "utils/basictypes.h"
 #include "utils/compiler.h"
+#include "utils/strings/ascii_case.h"
+#include "utils/strings/char_set.h"
+#include "utils/strings/string_builder.h"
+#include "utils/strings/string_search.h"
+#include "utils/strings/substring_replacer.h"
+#include "utils/strings/utf_string_conversions.h"
+#include "utils/strings/whitespace.h"
+
+// Difference() fills these with one merge pass when they are included; see
+// utils/containers/flat_set.h and utils/containers/flat_map.h.
+namespace utils {
+template <typename Key, typename Compare> class flat_set;
+template <typename Key, typename Mapped, typename Compare> class flat_map;
+} // namespace utils
 
 const char kUtf8ByteOrderMark[] = "\xEF\xBB\xBF";
 const wchar_t kWhitespaceWide[] = { WHITESPACE_UNICODE };
@@ -80,6 +101,8 @@ static bool IsAsciiDigit(Char c) {
     return c >= '0' && c <= '9';
 }
 
+// utils::HexEncode() and utils::HexDecode() in utils/strings/hex.h convert
+// whole buffers.
 template <typename Char>
 static bool IsHexDigit(Char c) {
     return (c >= '0' && c <= '9') ||
@@ -89,7 +112,7 @@ static bool IsHexDigit(Char c) {
 
 template <typename Char>
 static Char HexDigitToInt(Char c) {
-    DCHECK(IsHexDigit(c));
+    assert(IsHexDigit(c));
     if (c >= '0' && c <= '9')
         return c - '0';
     if (c >= 'A' && c <= 'F')
@@ -122,6 +145,58 @@ static bool CompareParameter(const ReplacementOffset& elem1, const ReplacementOf
     return elem1.parameter < elem2.parameter;
 }
 
+namespace internal {
+
+// Collects the output of a merge such as std::set_difference() into a new
+// |ResultType|. Node-based containers take one positioned insert per element;
+// the sorted-vector containers append the elements to their vector, which
+// they adopt with a single linear check that it is already in order.
+template <typename ResultType>
+struct MergeResult {
+    template <typename Merge>
+    static ResultType Build(Merge merge) {
+        ResultType result;
+        merge(std::inserter(result, result.end()));
+        return result;
+    }
+
+    // Takes the sorted output of a parallel merge.
+    template <typename T>
+    static ResultType Adopt(std::vector<T>&& elements) {
+        return ResultType(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+    }
+};
+
+template <typename Key, typename Compare>
+struct MergeResult<utils::flat_set<Key, Compare>> {
+    template <typename Merge>
+    static utils::flat_set<Key, Compare> Build(Merge merge) {
+        typename utils::flat_set<Key, Compare>::container_type elements;
+        merge(std::back_inserter(elements));
+        return utils::flat_set<Key, Compare>(std::move(elements));
+    }
+
+    static utils::flat_set<Key, Compare> Adopt(typename utils::flat_set<Key, Compare>::container_type&& elements) {
+        return utils::flat_set<Key, Compare>(std::move(elements));
+    }
+};
+
+template <typename Key, typename Mapped, typename Compare>
+struct MergeResult<utils::flat_map<Key, Mapped, Compare>> {
+    template <typename Merge>
+    static utils::flat_map<Key, Mapped, Compare> Build(Merge merge) {
+        typename utils::flat_map<Key, Mapped, Compare>::container_type elements;
+        merge(std::back_inserter(elements));
+        return utils::flat_map<Key, Mapped, Compare>(std::move(elements));
+    }
+
+    static utils::flat_map<Key, Mapped, Compare> Adopt(typename utils::flat_map<Key, Mapped, Compare>::container_type&& elements) {
+        return utils::flat_map<Key, Mapped, Compare>(std::move(elements));
+    }
+};
+
+} // namespace internal
+
 namespace std {
 
 template<typename Container, typename Elem>
@@ -137,6 +212,9 @@ void clear(T* obj) {
     obj->reserve(0);
 }
 
+// Deletes the objects the elements of [begin, end) point to, or both objects
+// of each pair. Containers that own their objects can be a utils::ArenaVector
+// or utils::ArenaMap instead, which free all of them at once.
 template<typename ForwardIterator>
 void DeletePointer(ForwardIterator begin, ForwardIterator end) {
     while (begin != end) {
@@ -195,12 +273,13 @@ bool Sorted(const Container& cont) {
 }
 
 // Returns a new ResultType containing the difference of two sorted containers.
+// A utils::flat_set or utils::flat_map result is filled with one merge pass
+// over the inputs and no per-element insert.
 template <typename ResultType, typename Arg1, typename Arg2>
 ResultType Difference(const Arg1& a1, const Arg2& a2) {
-    ResultType difference;
-    std::set_difference(a1.begin(), a1.end(), a2.begin(), a2.end(),
-        std::inserter(difference, difference.end()));
-    return difference;
+    return ::internal::MergeResult<ResultType>::Build([&a1, &a2](auto output) {
+        std::set_difference(a1.begin(), a1.end(), a2.begin(), a2.end(), output);
+    });
 }
 
 template<typename Collection, typename Key>
@@ -233,40 +312,61 @@ static size_t lcpyT(CHAR* dst, const CHAR* src, size_t dst_size) {
     return dst_size;
 }
 
+// Both passes scan with the precomputed |replace_chars| set, so the work is
+// linear in |input| however many characters the set holds.
 template<typename STR>
-bool ReplaceCharsT(const STR& input,
-    const typename STR::value_type replace_chars[],
-    const STR& replace_with,
+bool ReplaceCharsT(std::basic_string_view<typename STR::value_type> input,
+    const utils::CharSet<typename STR::value_type>& replace_chars,
+    std::basic_string_view<typename STR::value_type> replace_with,
     STR* output) {
-    bool removed = false;
-    size_t replace_length = replace_with.length();
-
-    *output = input;
+    const typename STR::value_type* data = input.data();
+    const size_t length = input.size();
 
-    size_t found = output->find_first_of(replace_chars);
-    while (found != STR::npos) {
-        removed = true;
-        output->replace(found, 1, replace_with);
-        found = output->find_first_of(replace_chars, found + replace_length);
+    size_t found = utils::internal::FindFirstOf(data, length, replace_chars);
+    if (found == length) {
+        // assign() copes with |input| viewing |*output|.
+        output->assign(data, length);
+        return false;
     }
 
-    return removed;
+    // The result is built apart from |*output|, which |input| may view, and
+    // allocated once: removing or replacing one for one never grows it, other
+    // replacements count the matches first.
+    size_t capacity = length;
+    if (replace_with.size() > 1) {
+        size_t matches = 0;
+        for (size_t i = found; i != length; i += 1 + utils::internal::FindFirstOf(data + i + 1, length - i - 1, replace_chars)) ++matches;
+        capacity += matches * (replace_with.size() - 1);
+    }
+    STR result;
+    result.reserve(capacity);
+
+    size_t start = 0;
+    while (found != length) {
+        result.append(data + start, found - start);
+        result.append(replace_with.data(), replace_with.size());
+        start = found + 1;
+        found = start + utils::internal::FindFirstOf(data + start, length - start, replace_chars);
+    }
+    result.append(data + start, length - start);
+    output->swap(result);
+    return true;
 }
 
-template<typename STR>
-TrimPositions TrimStringT(const STR& input, const typename STR::value_type trim_chars[], TrimPositions positions, STR* output) {
-    // Find the edges of leading/trailing whitespace as desired.
-    const typename STR::size_type last_char = input.length() - 1;
-    const typename STR::size_type first_good_char = (positions & TRIM_LEADING) ? input.find_first_not_of(trim_chars) : 0;
-    const typename STR::size_type last_good_char = (positions & TRIM_TRAILING) ? input.find_last_not_of(trim_chars) : last_char;
+// Cuts |input| down to [first_good_char, last_good_char] for TrimStringT() and
+// TrimWhitespaceT(); either edge is npos when |input| is all trim characters.
+// |output| views |input|, so nothing is copied.
+template<typename Char>
+TrimPositions TrimToT(std::basic_string_view<Char> input, size_t first_good_char, size_t last_good_char, TrimPositions positions, std::basic_string_view<Char>* output) {
+    typedef std::basic_string_view<Char> StringView;
+    const size_t last_char = input.length() - 1;
 
     // When the string was all whitespace, report that we stripped off whitespace
     // from whichever position the caller was interested in.  For empty input, we
     // stripped no whitespace, but we still need to clear |output|.
-    if (input.empty() || (first_good_char == STR::npos) || (last_good_char == STR::npos)) {
-        bool input_was_empty = input.empty();  // in case output == &input
-        output->clear();
-        return input_was_empty ? TRIM_NONE : positions;
+    if (input.empty() || (first_good_char == StringView::npos) || (last_good_char == StringView::npos)) {
+        *output = StringView();
+        return input.empty() ? TRIM_NONE : positions;
     }
 
     // Trim the whitespace.
@@ -276,54 +376,71 @@ TrimPositions TrimStringT(const STR& input, const typename STR::value_type trim_
     return static_cast<TrimPositions>(((first_good_char == 0) ? TRIM_NONE : TRIM_LEADING) | ((last_good_char == last_char) ? TRIM_NONE : TRIM_TRAILING));
 }
 
+template<typename Char>
+TrimPositions TrimStringT(std::basic_string_view<Char> input, std::basic_string_view<Char> trim_chars, TrimPositions positions, std::basic_string_view<Char>* output) {
+    // Find the edges of leading/trailing whitespace as desired.
+    const size_t first_good_char = (positions & TRIM_LEADING) ? input.find_first_not_of(trim_chars) : 0;
+    const size_t last_good_char = (positions & TRIM_TRAILING) ? input.find_last_not_of(trim_chars) : input.length() - 1;
+    return TrimToT(input, first_good_char, last_good_char, positions, output);
+}
+
+// TrimStringT() for the standard whitespace sets, found with the vectorized
+// scans in utils/strings/whitespace.h.
+template<typename Char>
+TrimPositions TrimWhitespaceT(std::basic_string_view<Char> input, TrimPositions positions, std::basic_string_view<Char>* output) {
+    typedef std::basic_string_view<Char> StringView;
+    const size_t length = input.length();
+    size_t first_good_char = 0;
+    size_t last_good_char = length - 1;
+    if (positions & TRIM_LEADING) {
+        first_good_char = utils::internal::FindFirstNonWhitespace(input.data(), length, utils::WHITESPACE_TRIM);
+        if (first_good_char == length) first_good_char = StringView::npos;
+    }
+    if ((positions & TRIM_TRAILING) && first_good_char != StringView::npos) {
+        last_good_char = utils::internal::FindLastNonWhitespace(input.data(), length, utils::WHITESPACE_TRIM);
+        if (last_good_char == length) last_good_char = StringView::npos;
+    }
+    return TrimToT(input, first_good_char, last_good_char, positions, output);
+}
+
 template<typename STR>
-STR CollapseWhitespaceT(const STR& text, bool trim_sequences_with_line_breaks) {
+STR CollapseWhitespaceT(std::basic_string_view<typename STR::value_type> text, bool trim_sequences_with_line_breaks) {
+    // The result is never longer than |text|, so one allocation is enough.
     STR result;
+    if (text.empty()) return result;
     result.resize(text.size());
+    result.resize(utils::internal::CollapseWhitespace(text.data(), text.size(), trim_sequences_with_line_breaks, &result[0]));
+    return result;
+}
 
-    // Set flags to pretend we're already in a trimmed whitespace sequence, so we
-    // will trim any leading whitespace.
-    bool in_whitespace = true;
-    bool already_trimmed = true;
-
-    int chars_written = 0;
-    for (typename STR::const_iterator i(text.begin()); i != text.end(); ++i) {
-        if (IsWhitespace(*i)) {
-            if (!in_whitespace) {
-                // Reduce all whitespace sequences to a single space.
-                in_whitespace = true;
-                result[chars_written++] = L' ';
-            }
-            if (trim_sequences_with_line_breaks && !already_trimmed &&
-                ((*i == '\n') || (*i == '\r'))) {
-                // Whitespace sequences containing CR or LF are eliminated entirely.
-                already_trimmed = true;
-                --chars_written;
-            }
-        } else {
-            // Non-whitespace chracters are copied straight across.
-            in_whitespace = false;
-            already_trimmed = false;
-            result[chars_written++] = *i;
-        }
-    }
-
-    if (in_whitespace && !already_trimmed) {
-        // Any trailing whitespace is eliminated.
-        --chars_written;
-    }
+template<typename Char>
+static bool ContainsOnlyCharsT(std::basic_string_view<Char> input, const utils::CharSet<Char>& characters) {
+    return utils::internal::FindFirstNotOf(input.data(), input.size(), characters) == input.size();
+}
 
-    result.resize(chars_written);
-    return result;
+// Case folding for StringToLowerASCII()/StringToUpperASCII(). char and char16
+// strings go to the vectorized kernels in utils/strings/ascii_case.h, other
+// code unit types take these scalar loops.
+template <typename Char>
+inline void CopyToLowerASCIIT(const Char* src, size_t length, Char* dst) {
+    for (size_t i = 0; i < length; ++i) dst[i] = ToLowerASCII(src[i]);
+}
+inline void CopyToLowerASCIIT(const char* src, size_t length, char* dst) {
+    utils::CopyToLowerASCII(src, length, dst);
+}
+inline void CopyToLowerASCIIT(const char16* src, size_t length, char16* dst) {
+    utils::CopyToLowerASCII(src, length, dst);
 }
 
-template<typename STR>
-static bool ContainsOnlyCharsT(const STR& input, const STR& characters) {
-    for (typename STR::const_iterator iter = input.begin(); iter != input.end(); ++iter) {
-        if (characters.find(*iter) == STR::npos)
-            return false;
-    }
-    return true;
+template <typename Char>
+inline void CopyToUpperASCIIT(const Char* src, size_t length, Char* dst) {
+    for (size_t i = 0; i < length; ++i) dst[i] = ToUpperASCII(src[i]);
+}
+inline void CopyToUpperASCIIT(const char* src, size_t length, char* dst) {
+    utils::CopyToUpperASCII(src, length, dst);
+}
+inline void CopyToUpperASCIIT(const char16* src, size_t length, char16* dst) {
+    utils::CopyToUpperASCII(src, length, dst);
 }
 
 template<typename Iter>
@@ -337,22 +454,22 @@ static inline bool DoLowerCaseEqualsASCII(Iter a_begin,
     return *b == 0;
 }
 
-template <typename STR>
-bool StartsWithT(const STR& str, const STR& search, bool case_sensitive) {
+template <typename Char>
+bool StartsWithT(std::basic_string_view<Char> str, std::basic_string_view<Char> search, bool case_sensitive) {
     if (case_sensitive) {
         return str.compare(0, search.length(), search) == 0;
     } else {
         if (search.size() > str.size())
             return false;
         return std::equal(search.begin(), search.end(), str.begin(),
-            CaseInsensitiveCompare<typename STR::value_type>());
+            CaseInsensitiveCompare<Char>());
     }
 }
 
-template <typename STR>
-bool EndsWithT(const STR& str, const STR& search, bool case_sensitive) {
-    typename STR::size_type str_length = str.length();
-    typename STR::size_type search_length = search.length();
+template <typename Char>
+bool EndsWithT(std::basic_string_view<Char> str, std::basic_string_view<Char> search, bool case_sensitive) {
+    size_t str_length = str.length();
+    size_t search_length = search.length();
     if (search_length > str_length)
         return false;
     if (case_sensitive) {
@@ -361,42 +478,70 @@ bool EndsWithT(const STR& str, const STR& search, bool case_sensitive) {
     else {
         return std::equal(search.begin(), search.end(),
             str.begin() + (str_length - search_length),
-            CaseInsensitiveCompare<typename STR::value_type>());
+            CaseInsensitiveCompare<Char>());
     }
 }
 
+// Replaces the first or every non-overlapping occurrence of |find_this| after
+// |start_offset|. Every search runs on the original text, and when replacing
+// all with a different length, the result is built once instead of moving the
+// tail of |*str| for each match.
 template<class StringType>
 void DoReplaceSubstringsAfterOffset(StringType* str,
     typename StringType::size_type start_offset,
-    const StringType& find_this,
-    const StringType& replace_with,
+    const utils::SubstringSearcher<typename StringType::value_type>& find_this,
+    std::basic_string_view<typename StringType::value_type> replace_with,
     bool replace_all) {
-    if ((start_offset == StringType::npos) || (start_offset >= str->length()))
+    typedef std::basic_string_view<typename StringType::value_type> StringView;
+    if ((start_offset == StringType::npos) || (start_offset >= str->length()) || !find_this.size())
         return;
 
-    for (typename StringType::size_type offs(str->find(find_this, start_offset));
-        offs != StringType::npos; offs = str->find(find_this, offs)) {
-        str->replace(offs, find_this.length(), replace_with);
-        offs += replace_with.length();
+    const size_t find_length = find_this.size();
+    size_t offs = find_this.Find(*str, start_offset);
+    if (offs == StringView::npos)
+        return;
+    if (!replace_all || find_length == replace_with.size()) {
+        for (; offs != StringView::npos; offs = find_this.Find(*str, offs + find_length)) {
+            str->replace(offs, find_length, replace_with.data(), replace_with.size());
+            if (!replace_all)
+                break;
+        }
+        return;
+    }
 
-        if (!replace_all)
-            break;
+    // |replace_with| may view |*str|, so the result is built apart from it.
+    std::vector<size_t> matches;
+    for (; offs != StringView::npos; offs = find_this.Find(*str, offs + find_length))
+        matches.push_back(offs);
+    StringType result;
+    result.reserve(str->size() - matches.size() * find_length + matches.size() * replace_with.size());
+    size_t copied_up_to = 0;
+    for (size_t match : matches) {
+        result.append(str->data() + copied_up_to, match - copied_up_to);
+        result.append(replace_with.data(), replace_with.size());
+        copied_up_to = match + find_length;
     }
+    result.append(str->data() + copied_up_to, str->size() - copied_up_to);
+    str->swap(result);
 }
 
-template<typename STR>
-static size_t TokenizeT(const STR& str, const STR& delimiters, std::vector<STR>* tokens) {
+// |STR| is a string, or a string view for tokens that point into |str|.
+template<typename STR, typename Alloc>
+static size_t TokenizeT(std::basic_string_view<typename STR::value_type> str,
+    std::basic_string_view<typename STR::value_type> delimiters,
+    std::vector<STR, Alloc>* tokens) {
+    typedef std::basic_string_view<typename STR::value_type> StringView;
     tokens->clear();
 
-    typename STR::size_type start = str.find_first_not_of(delimiters);
-    while (start != STR::npos) {
-        typename STR::size_type end = str.find_first_of(delimiters, start + 1);
-        if (end == STR::npos) {
-            tokens->push_back(str.substr(start));
+    size_t start = str.find_first_not_of(delimiters);
+    while (start != StringView::npos) {
+        size_t end = str.find_first_of(delimiters, start + 1);
+        if (end == StringView::npos) {
+            tokens->emplace_back(str.substr(start));
             break;
         }
         else {
-            tokens->push_back(str.substr(start, end - start));
+            tokens->emplace_back(str.substr(start, end - start));
             start = str.find_first_not_of(delimiters, end + 1);
         }
     }
@@ -404,20 +549,11 @@ static size_t TokenizeT(const STR& str, const STR& delimiters, std::vector<STR>*
     return tokens->size();
 }
 
-template<typename STR>
-static STR JoinStringT(const std::vector<STR>& parts, const STR& sep) {
-    if (parts.empty())
-        return STR();
-
-    STR result(parts[0]);
-    typename std::vector<STR>::const_iterator iter = parts.begin();
-    ++iter;
-
-    for (; iter != parts.end(); ++iter) {
-        result += sep;
-        result += *iter;
-    }
-
+// Joins the strings or views in [begin, end), sizing the result up front.
+template<typename STR, typename Iter>
+static STR JoinStringT(Iter begin, Iter end, std::basic_string_view<typename STR::value_type> sep) {
+    STR result;
+    utils::internal::AppendJoined(&result, begin, end, sep);
     return result;
 }
 
@@ -513,6 +649,8 @@ static int strncmp16(const char16* s1, const char16* s2, size_t count) {
 // Wrapper for vsnprintf that always null-terminates and always returns the
 // number of characters that would be in an untruncated formatted
 // string, even when truncation occurs.
+// New code should prefer utils::FormatTo() from utils/strings/format.h, which
+// checks its format string at compile time and does not go through the CRT.
 static inline int vsnprintf(char* buffer, size_t size, const char* format, va_list arguments) PRINTF_FORMAT(3, 0) {
     int length = _vsprintf_p(buffer, size, format, arguments);
     if (length < 0) {
@@ -627,37 +765,72 @@ static bool IsWprintfFormatPortable(const wchar_t* format) {
 }
 
 
+// The string helpers below take std::string_view / std::wstring_view, so
+// literals, substrings and strings are all passed without building a
+// temporary. Memory is only allocated for the output they produce, and the
+// overloads that return views into their input allocate nothing at all.
+
 // Replaces characters in |replace_chars| from anywhere in |input| with
 // |replace_with|.  Each character in |replace_chars| will be replaced with
 // the |replace_with| string.  Returns true if any characters were replaced.
-// |replace_chars| must be null-terminated.
 // NOTE: Safe to use the same variable for both |input| and |output|.
-static bool ReplaceChars(const std::wstring& input, const char16 replace_chars[], const std::wstring& replace_with, std::wstring* output) {
+// Callers that use the same characters repeatedly can build a utils::CharSet
+// once and pass that instead.
+static bool ReplaceChars(std::wstring_view input, const utils::CharSet<wchar_t>& replace_chars, std::wstring_view replace_with, std::wstring* output) {
     return ::internal::ReplaceCharsT(input, replace_chars, replace_with, output);
 }
-static bool ReplaceChars(const std::string& input, const char replace_chars[], const std::string& replace_with, std::string* output) {
+static bool ReplaceChars(std::string_view input, const utils::CharSet<char>& replace_chars, std::string_view replace_with, std::string* output) {
     return ::internal::ReplaceCharsT(input, replace_chars, replace_with, output);
 }
+static bool ReplaceChars(std::wstring_view input, std::wstring_view replace_chars, std::wstring_view replace_with, std::wstring* output) {
+    return ReplaceChars(input, utils::CharSet<wchar_t>(replace_chars), replace_with, output);
+}
+static bool ReplaceChars(std::string_view input, std::string_view replace_chars, std::string_view replace_with, std::string* output) {
+    return ReplaceChars(input, utils::CharSet<char>(replace_chars), replace_with, output);
+}
 
 
 // Removes characters in |remove_chars| from anywhere in |input|.  Returns true
-// if any characters were removed.  |remove_chars| must be null-terminated.
+// if any characters were removed.
 // NOTE: Safe to use the same variable for both |input| and |output|.
-static bool RemoveChars(const std::wstring& input, const char16 remove_chars[], std::wstring* output) {
-    return ReplaceChars(input, remove_chars, std::wstring(), output);
+static bool RemoveChars(std::wstring_view input, const utils::CharSet<wchar_t>& remove_chars, std::wstring* output) {
+    return ReplaceChars(input, remove_chars, std::wstring_view(), output);
+}
+static bool RemoveChars(std::string_view input, const utils::CharSet<char>& remove_chars, std::string* output) {
+    return ReplaceChars(input, remove_chars, std::string_view(), output);
 }
-static bool RemoveChars(const std::string& input, const char remove_chars[], std::string* output) {
-    return ReplaceChars(input, remove_chars, std::string(), output);
+static bool RemoveChars(std::wstring_view input, std::wstring_view remove_chars, std::wstring* output) {
+    return ReplaceChars(input, utils::CharSet<wchar_t>(remove_chars), std::wstring_view(), output);
+}
+static bool RemoveChars(std::string_view input, std::string_view remove_chars, std::string* output) {
+    return ReplaceChars(input, utils::CharSet<char>(remove_chars), std::string_view(), output);
 }
 
 // Removes characters in |trim_chars| from the beginning and end of |input|.
-// |trim_chars| must be null-terminated.
 // NOTE: Safe to use the same variable for both |input| and |output|.
-static bool TrimString(const std::wstring& input, const char16 trim_chars[], std::wstring* output) {
-    return ::internal::TrimStringT(input, trim_chars, TRIM_ALL, output) != TRIM_NONE;
+static bool TrimString(std::wstring_view input, std::wstring_view trim_chars, std::wstring* output) {
+    std::wstring_view trimmed;
+    const bool result = ::internal::TrimStringT(input, trim_chars, TRIM_ALL, &trimmed) != TRIM_NONE;
+    output->assign(trimmed.data(), trimmed.size());
+    return result;
+}
+static bool TrimString(std::string_view input, std::string_view trim_chars, std::string* output) {
+    std::string_view trimmed;
+    const bool result = ::internal::TrimStringT(input, trim_chars, TRIM_ALL, &trimmed) != TRIM_NONE;
+    output->assign(trimmed.data(), trimmed.size());
+    return result;
+}
+
+// Same, but returns the trimmed part of |input| instead of copying it.
+static std::wstring_view TrimString(std::wstring_view input, std::wstring_view trim_chars, TrimPositions positions) {
+    std::wstring_view trimmed;
+    ::internal::TrimStringT(input, trim_chars, positions, &trimmed);
+    return trimmed;
 }
-static bool TrimString(const std::string& input, const char trim_chars[], std::string* output) {
-    return ::internal::TrimStringT(input, trim_chars, TRIM_ALL, output) != TRIM_NONE;
+static std::string_view TrimString(std::string_view input, std::string_view trim_chars, TrimPositions positions) {
+    std::string_view trimmed;
+    ::internal::TrimStringT(input, trim_chars, positions, &trimmed);
+    return trimmed;
 }
 
 // Trims any whitespace from either end of the input string.  Returns where
@@ -667,19 +840,37 @@ static bool TrimString(const std::string& input, const char trim_chars[], std::s
 //   This function is for ASCII strings and only looks for ASCII whitespace;
 // Please choose the best one according to your usage.
 // NOTE: Safe to use the same variable for both input and output.
-static TrimPositions TrimWhitespace(const std::wstring& input, TrimPositions positions, std::wstring* output) {
-    return ::internal::TrimStringT(input, kWhitespaceUTF16, positions, output);
+static TrimPositions TrimWhitespace(std::wstring_view input, TrimPositions positions, std::wstring* output) {
+    std::wstring_view trimmed;
+    const TrimPositions result = ::internal::TrimWhitespaceT(input, positions, &trimmed);
+    output->assign(trimmed.data(), trimmed.size());
+    return result;
 }
-static TrimPositions TrimWhitespaceASCII(const std::string& input, TrimPositions positions, std::string* output) {
-    return ::internal::TrimStringT(input, kWhitespaceASCII, positions, output);
+static TrimPositions TrimWhitespaceASCII(std::string_view input, TrimPositions positions, std::string* output) {
+    std::string_view trimmed;
+    const TrimPositions result = ::internal::TrimWhitespaceT(input, positions, &trimmed);
+    output->assign(trimmed.data(), trimmed.size());
+    return result;
 }
 
 // Deprecated. This function is only for backward compatibility and calls
 // TrimWhitespaceASCII().
-static TrimPositions TrimWhitespace(const std::string& input, TrimPositions positions, std::string* output) {
+static TrimPositions TrimWhitespace(std::string_view input, TrimPositions positions, std::string* output) {
     return TrimWhitespaceASCII(input, positions, output);
 }
 
+// Same, but return the trimmed part of |input| instead of copying it.
+static std::wstring_view TrimWhitespace(std::wstring_view input, TrimPositions positions) {
+    std::wstring_view trimmed;
+    ::internal::TrimWhitespaceT(input, positions, &trimmed);
+    return trimmed;
+}
+static std::string_view TrimWhitespaceASCII(std::string_view input, TrimPositions positions) {
+    std::string_view trimmed;
+    ::internal::TrimWhitespaceT(input, positions, &trimmed);
+    return trimmed;
+}
+
 // Searches  for CR or LF characters.  Removes all contiguous whitespace
 // strings that contain them.  This is useful when trying to deal with text
 // copied from terminals.
@@ -688,76 +879,71 @@ static TrimPositions TrimWhitespace(const std::string& input, TrimPositions posi
 // (2) If |trim_sequences_with_line_breaks| is true, any other whitespace
 //     sequences containing a CR or LF are trimmed.
 // (3) All other whitespace sequences are converted to single spaces.
-static std::wstring CollapseWhitespace(const std::wstring& text, bool trim_sequences_with_line_breaks) {
-    return ::internal::CollapseWhitespaceT(text, trim_sequences_with_line_breaks);
+static std::wstring CollapseWhitespace(std::wstring_view text, bool trim_sequences_with_line_breaks) {
+    return ::internal::CollapseWhitespaceT<std::wstring>(text, trim_sequences_with_line_breaks);
 }
-static std::string CollapseWhitespaceASCII(const std::string& text, bool trim_sequences_with_line_breaks) {
-    return ::internal::CollapseWhitespaceT(text, trim_sequences_with_line_breaks);
+static std::string CollapseWhitespaceASCII(std::string_view text, bool trim_sequences_with_line_breaks) {
+    return ::internal::CollapseWhitespaceT<std::string>(text, trim_sequences_with_line_breaks);
 }
 
 // Returns true if the passed string is empty or contains only white-space
 // characters.
-static bool ContainsOnlyWhitespaceASCII(const std::string& str) {
-    for (std::string::const_iterator i(str.begin()); i != str.end(); ++i) {
-        if (!IsAsciiWhitespace(*i))
-            return false;
-    }
-    return true;
+static bool ContainsOnlyWhitespaceASCII(std::string_view str) {
+    return utils::internal::FindFirstNonWhitespace(str.data(), str.size(), utils::WHITESPACE_ASCII) == str.size();
 }
-static bool ContainsOnlyWhitespace(const std::wstring& str) {
-    return str.find_first_not_of(kWhitespaceUTF16) == std::wstring::npos;
+static bool ContainsOnlyWhitespace(std::wstring_view str) {
+    return utils::internal::FindFirstNonWhitespace(str.data(), str.size(), utils::WHITESPACE_TRIM) == str.size();
 }
 
 // Returns true if |input| is empty or contains only characters found in
 // |characters|.
-static bool ContainsOnlyChars(const std::wstring& input, const std::wstring& characters) {
+static bool ContainsOnlyChars(std::wstring_view input, const utils::CharSet<wchar_t>& characters) {
     return ::internal::ContainsOnlyCharsT(input, characters);
 }
-
-static bool ContainsOnlyChars(const std::string& input, const std::string& characters) {
+static bool ContainsOnlyChars(std::string_view input, const utils::CharSet<char>& characters) {
     return ::internal::ContainsOnlyCharsT(input, characters);
 }
 
+static bool ContainsOnlyChars(std::wstring_view input, std::wstring_view characters) {
+    return ::internal::ContainsOnlyCharsT(input, utils::CharSet<wchar_t>(characters));
+}
+
+static bool ContainsOnlyChars(std::string_view input, std::string_view characters) {
+    return ::internal::ContainsOnlyCharsT(input, utils::CharSet<char>(characters));
+}
+
 // Converts the given wide string to the corresponding Latin1. This will fail
 // (return false) if any characters are more than 255.
-static bool WideToLatin1(const std::wstring& wide, std::string* latin1) {
-    std::string output;
-    output.resize(wide.size());
-    latin1->clear();
-    for (size_t i = 0; i < wide.size(); i++) {
-        if (wide[i] > 255)
-            return false;
-        output[i] = static_cast<char>(wide[i]);
-    }
-    latin1->swap(output);
-    return true;
+static bool WideToLatin1(std::wstring_view wide, std::string* latin1) {
+    return utils::WideToLatin1(wide, latin1);
 }
 
 // Converts the elements of the given string.  This version uses a pointer to
 // clearly differentiate it from the non-pointer variant.
 template <class str> inline void StringToLowerASCII(str* s) {
-    for (typename str::iterator i = s->begin(); i != s->end(); ++i)
-        *i = ToLowerASCII(*i);
+    if (!s->empty()) ::internal::CopyToLowerASCIIT(s->data(), s->size(), &(*s)[0]);
 }
 
 template <class str> inline str StringToLowerASCII(const str& s) {
-    // for std::string and std::wstring
-    str output(s);
-    StringToLowerASCII(&output);
+    // for std::string and std::wstring; folds while copying instead of
+    // copying and then folding.
+    str output;
+    output.resize(s.size());
+    if (!s.empty()) ::internal::CopyToLowerASCIIT(s.data(), s.size(), &output[0]);
     return output;
 }
 
 // Converts the elements of the given string.  This version uses a pointer to
 // clearly differentiate it from the non-pointer variant.
 template <class str> inline void StringToUpperASCII(str* s) {
-    for (typename str::iterator i = s->begin(); i != s->end(); ++i)
-        *i = ToUpperASCII(*i);
+    if (!s->empty()) ::internal::CopyToUpperASCIIT(s->data(), s->size(), &(*s)[0]);
 }
 
 template <class str> inline str StringToUpperASCII(const str& s) {
     // for std::string and std::wstring
-    str output(s);
-    StringToUpperASCII(&output);
+    str output;
+    output.resize(s.size());
+    if (!s.empty()) ::internal::CopyToUpperASCIIT(s.data(), s.size(), &output[0]);
     return output;
 }
 
@@ -765,62 +951,81 @@ template <class str> inline str StringToUpperASCII(const str& s) {
 // string.  This is useful for doing checking if an input string matches some
 // token, and it is optimized to avoid intermediate string copies.  This API is
 // borrowed from the equivalent APIs in Mozilla.
-static bool LowerCaseEqualsASCII(const std::string& a, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a.begin(), a.end(), b);
+static bool LowerCaseEqualsASCII(std::string_view a, std::string_view b) {
+    return utils::LowerCaseEqualsASCII(a, b);
 }
-static bool LowerCaseEqualsASCII(const std::wstring& a, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a.begin(), a.end(), b);
+static bool LowerCaseEqualsASCII(std::wstring_view a, std::string_view b) {
+    return utils::LowerCaseEqualsASCII(a, b);
 }
 
 // Same thing, but with string iterators instead.
 static bool LowerCaseEqualsASCII(std::string::const_iterator a_begin, std::string::const_iterator a_end, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a_begin, a_end, b);
+    if (a_begin == a_end) return !*b;
+    return utils::LowerCaseEqualsASCII(std::string_view(&*a_begin, a_end - a_begin), b);
 }
 static bool LowerCaseEqualsASCII(std::wstring::const_iterator a_begin, std::wstring::const_iterator a_end, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a_begin, a_end, b);
+    if (a_begin == a_end) return !*b;
+    return utils::LowerCaseEqualsASCII(std::wstring_view(&*a_begin, a_end - a_begin), b);
 }
 static bool LowerCaseEqualsASCII(const char* a_begin, const char* a_end, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a_begin, a_end, b);
+    return utils::LowerCaseEqualsASCII(std::string_view(a_begin, a_end - a_begin), b);
 }
 static bool LowerCaseEqualsASCII(const char16* a_begin, const char16* a_end, const char* b) {
-    return ::internal::DoLowerCaseEqualsASCII(a_begin, a_end, b);
+    return utils::LowerCaseEqualsASCII(std::basic_string_view<char16>(a_begin, a_end - a_begin), b);
+}
+
+// Returns true if |a| and |b| are equal ignoring ASCII case, without
+// building lower-case copies of either.
+static bool EqualsCaseInsensitiveASCII(std::string_view a, std::string_view b) {
+    return utils::EqualsCaseInsensitiveASCII(a, b);
+}
+static bool EqualsCaseInsensitiveASCII(std::wstring_view a, std::wstring_view b) {
+    return utils::EqualsCaseInsensitiveASCII(a, b);
 }
 
 // Performs a case-sensitive string compare. The behavior is undefined if both
 // strings are not ASCII.
-static bool EqualsASCII(const std::wstring& a, const std::string& b) {
+static bool EqualsASCII(std::wstring_view a, std::string_view b) {
     if (a.length() != b.length()) return false;
     return std::equal(b.begin(), b.end(), a.begin());
 }
 
 // Returns true if str starts with search, or false otherwise.
-static bool StartsWithASCII(const std::string& str, const std::string& search, bool case_sensitive) {
+static bool StartsWithASCII(std::string_view str, std::string_view search, bool case_sensitive) {
     if (case_sensitive)
         return str.compare(0, search.length(), search) == 0;
     else
-        return strncasecmp(str.c_str(), search.c_str(), search.length()) == 0;
+        return search.length() <= str.length() && utils::EqualsCaseInsensitiveASCII(str.substr(0, search.length()), search);
 }
-static bool StartsWith(const std::wstring& str, const std::wstring& search, bool case_sensitive) {
+static bool StartsWith(std::wstring_view str, std::wstring_view search, bool case_sensitive) {
     return ::internal::StartsWithT(str, search, case_sensitive);
 }
 
 // Returns true if str ends with search, or false otherwise.
-static bool EndsWith(const std::string& str, const std::string& search, bool case_sensitive) {
+static bool EndsWith(std::string_view str, std::string_view search, bool case_sensitive) {
     return ::internal::EndsWithT(str, search, case_sensitive);
 }
-static bool EndsWith(const std::wstring& str, const std::wstring& search, bool case_sensitive) {
+static bool EndsWith(std::wstring_view str, std::wstring_view search, bool case_sensitive) {
     return ::internal::EndsWithT(str, search, case_sensitive);
 }
 
 
 // Starting at |start_offset| (usually 0), replace the first instance of
-// |find_this| with |replace_with|.
-static void ReplaceFirstSubstringAfterOffset(std::wstring* str, std::wstring::size_type start_offset, const std::wstring& find_this, const std::wstring& replace_with) {
+// |find_this| with |replace_with|. An empty |find_this| matches nothing.
+// Callers that search for the same string repeatedly can pass a prebuilt
+// utils::SubstringSearcher instead.
+static void ReplaceFirstSubstringAfterOffset(std::wstring* str, std::wstring::size_type start_offset, const utils::SubstringSearcher<wchar_t>& find_this, std::wstring_view replace_with) {
     ::internal::DoReplaceSubstringsAfterOffset(str, start_offset, find_this, replace_with, false);  // replace first instance
 }
-static void ReplaceFirstSubstringAfterOffset(std::string* str, std::string::size_type start_offset, const std::string& find_this, const std::string& replace_with) {
+static void ReplaceFirstSubstringAfterOffset(std::string* str, std::string::size_type start_offset, const utils::SubstringSearcher<char>& find_this, std::string_view replace_with) {
     ::internal::DoReplaceSubstringsAfterOffset(str, start_offset, find_this, replace_with, false);  // replace first instance
 }
+static void ReplaceFirstSubstringAfterOffset(std::wstring* str, std::wstring::size_type start_offset, std::wstring_view find_this, std::wstring_view replace_with) {
+    ReplaceFirstSubstringAfterOffset(str, start_offset, utils::SubstringSearcher<wchar_t>(find_this), replace_with);
+}
+static void ReplaceFirstSubstringAfterOffset(std::string* str, std::string::size_type start_offset, std::string_view find_this, std::string_view replace_with) {
+    ReplaceFirstSubstringAfterOffset(str, start_offset, utils::SubstringSearcher<char>(find_this), replace_with);
+}
 
 // Starting at |start_offset| (usually 0), look through |str| and replace all
 // instances of |find_this| with |replace_with|.
@@ -828,12 +1033,29 @@ static void ReplaceFirstSubstringAfterOffset(std::string* str, std::string::size
 // This does entire substrings; use std::replace in <algorithm> for single
 // characters, for example:
 //   std::replace(str.begin(), str.end(), 'a', 'b');
-static void ReplaceSubstringsAfterOffset(std::wstring* str, std::wstring::size_type start_offset, const std::wstring& find_this, const std::wstring& replace_with) {
+static void ReplaceSubstringsAfterOffset(std::wstring* str, std::wstring::size_type start_offset, const utils::SubstringSearcher<wchar_t>& find_this, std::wstring_view replace_with) {
     ::internal::DoReplaceSubstringsAfterOffset(str, start_offset, find_this, replace_with, true);  // replace all instances
 }
-static void ReplaceSubstringsAfterOffset(std::string* str, std::string::size_type start_offset, const std::string& find_this, const std::string& replace_with) {
+static void ReplaceSubstringsAfterOffset(std::string* str, std::string::size_type start_offset, const utils::SubstringSearcher<char>& find_this, std::string_view replace_with) {
     ::internal::DoReplaceSubstringsAfterOffset(str, start_offset, find_this, replace_with, true);  // replace all instances
 }
+static void ReplaceSubstringsAfterOffset(std::wstring* str, std::wstring::size_type start_offset, std::wstring_view find_this, std::wstring_view replace_with) {
+    ReplaceSubstringsAfterOffset(str, start_offset, utils::SubstringSearcher<wchar_t>(find_this), replace_with);
+}
+static void ReplaceSubstringsAfterOffset(std::string* str, std::string::size_type start_offset, std::string_view find_this, std::string_view replace_with) {
+    ReplaceSubstringsAfterOffset(str, start_offset, utils::SubstringSearcher<char>(find_this), replace_with);
+}
+
+// Starting at |start_offset|, replace every occurrence of the first string of
+// each rule in |rules| with the second one, in a single pass over |str|. See
+// utils::SubstringReplacer for how overlapping matches are resolved; build one
+// directly to apply the same rules to many strings.
+static void ReplaceSubstringsAfterOffset(std::wstring* str, std::wstring::size_type start_offset, const std::vector<std::pair<std::wstring, std::wstring>>& rules) {
+    utils::SubstringReplacer<std::wstring>(rules).ReplaceInPlace(str, start_offset);
+}
+static void ReplaceSubstringsAfterOffset(std::string* str, std::string::size_type start_offset, const std::vector<std::pair<std::string, std::string>>& rules) {
+    utils::SubstringReplacer<std::string>(rules).ReplaceInPlace(str, start_offset);
+}
 
 // Reserves enough memory in |str| to accommodate |length_with_null| characters,
 // sets the size of |str| to |length_with_null - 1| characters, and returns a
@@ -868,40 +1090,75 @@ static typename string_type::value_type* WriteInto(string_type* str,
 // Splits a string into its fields delimited by any of the characters in
 // |delimiters|.  Each field is added to the |tokens| vector.  Returns the
 // number of tokens found.
-static size_t Tokenize(const std::wstring& str, const std::wstring& delimiters, std::vector<std::wstring>* tokens) {
+static size_t Tokenize(std::wstring_view str, std::wstring_view delimiters, std::vector<std::wstring>* tokens) {
     return ::internal::TokenizeT(str, delimiters, tokens);
 }
-static size_t Tokenize(const std::string& str, const std::string& delimiters, std::vector<std::string>* tokens) {
+static size_t Tokenize(std::string_view str, std::string_view delimiters, std::vector<std::string>* tokens) {
     return ::internal::TokenizeT(str, delimiters, tokens);
 }
 
-static size_t Tokenize(const std::wstring& str, const char16& delimiters, std::vector<std::wstring>* tokens) {
-    return Tokenize(str, std::wstring(1, delimiters), tokens);
+static size_t Tokenize(std::wstring_view str, const char16& delimiters, std::vector<std::wstring>* tokens) {
+    return Tokenize(str, std::wstring_view(&delimiters, 1), tokens);
 }
-static size_t Tokenize(const std::string& str, const char& delimiters, std::vector<std::string>* tokens) {
-    return Tokenize(str, std::string(1, delimiters), tokens);
+static size_t Tokenize(std::string_view str, const char& delimiters, std::vector<std::string>* tokens) {
+    return Tokenize(str, std::string_view(&delimiters, 1), tokens);
 }
 
-// Join |parts| using |separator|.
-static std::string JoinString(const std::vector<std::string>& parts, const std::string& separator) {
-    return ::internal::JoinStringT(parts, separator);
+// Same, but the tokens are views into |str|, which must outlive them.
+static size_t Tokenize(std::wstring_view str, std::wstring_view delimiters, std::vector<std::wstring_view>* tokens) {
+    return ::internal::TokenizeT(str, delimiters, tokens);
+}
+static size_t Tokenize(std::string_view str, std::string_view delimiters, std::vector<std::string_view>* tokens) {
+    return ::internal::TokenizeT(str, delimiters, tokens);
+}
+
+// Join |parts| using |separator|. The result is allocated once.
+static std::string JoinString(const std::vector<std::string>& parts, std::string_view separator) {
+    return ::internal::JoinStringT<std::string>(parts.begin(), parts.end(), separator);
+}
+static std::wstring JoinString(const std::vector<std::wstring>& parts, std::wstring_view separator) {
+    return ::internal::JoinStringT<std::wstring>(parts.begin(), parts.end(), separator);
+}
+static std::string JoinString(const std::vector<std::string_view>& parts, std::string_view separator) {
+    return ::internal::JoinStringT<std::string>(parts.begin(), parts.end(), separator);
 }
-static std::wstring JoinString(const std::vector<std::wstring>& parts, const std::wstring& separator) {
-    return ::internal::JoinStringT(parts, separator);
+static std::wstring JoinString(const std::vector<std::wstring_view>& parts, std::wstring_view separator) {
+    return ::internal::JoinStringT<std::wstring>(parts.begin(), parts.end(), separator);
+}
+static std::string JoinString(std::initializer_list<std::string_view> parts, std::string_view separator) {
+    return ::internal::JoinStringT<std::string>(parts.begin(), parts.end(), separator);
+}
+static std::wstring JoinString(std::initializer_list<std::wstring_view> parts, std::wstring_view separator) {
+    return ::internal::JoinStringT<std::wstring>(parts.begin(), parts.end(), separator);
+}
+
+// Join the parts in [begin, end), which may be strings, views or
+// null-terminated pointers, using |separator|. See utils::StringBuilder and
+// utils::Rope in utils/strings/string_builder.h for building up or streaming
+// large results.
+template<typename Iter>
+static std::string JoinString(Iter begin, Iter end, std::string_view separator) {
+    return ::internal::JoinStringT<std::string>(begin, end, separator);
+}
+template<typename Iter>
+static std::wstring JoinString(Iter begin, Iter end, std::wstring_view separator) {
+    return ::internal::JoinStringT<std::wstring>(begin, end, separator);
 }
 
 // Does the opposite of SplitString().
 static std::wstring JoinString(const std::vector<std::wstring>& parts, char16 s) {
-    return JoinString(parts, std::wstring(1, s));
+    return JoinString(parts, std::wstring_view(&s, 1));
 }
 static std::string JoinString(const std::vector<std::string>& parts, char s) {
-    return JoinString(parts, std::string(1, s));
+    return JoinString(parts, std::string_view(&s, 1));
 }
 
 // Replace $1-$2-$3..$9 in the format string with |a|-|b|-|c|..|i| respectively.
 // Additionally, any number of consecutive '$' characters is replaced by that
 // number less one. Eg $$->$, $$$->$$, etc. The offsets parameter here can be
 // NULL. This only allows you to use up to nine replacements.
+// The format is parsed on every call; for fixed formats use
+// utils::MakePlaceholderTemplate() or utils::PlaceholderTemplate instead.
 static std::wstring ReplaceStringPlaceholders(const std::wstring& format_string, const std::vector<std::wstring>& subst, std::vector<size_t>* offsets) {
     return ::internal::DoReplaceStringPlaceholders(format_string, subst, offsets);
 }
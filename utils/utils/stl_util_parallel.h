@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STL_UTIL_PARALLEL_INCLUDE_H_
+#define UTILS_STL_UTIL_PARALLEL_INCLUDE_H_
+
+#include <utility>
+#include <vector>
+
+#include "utils/containers/parallel_algorithm.h"
+#include "utils/stl_util.h"
+
+// Kept apart from stl_util.h so that only the callers of these pull in
+// utils/thread_pool.h and its threading headers.
+namespace std {
+
+// Sorted() and Difference() for large random-access containers, such as
+// std::vector and the flat containers, spread over utils::ThreadPool::Default().
+// See utils/containers/parallel_algorithm.h.
+template <typename Container>
+bool ParallelSorted(const Container& cont) {
+    return utils::ParallelIsSorted(cont.begin(), cont.end());
+}
+
+template <typename ResultType, typename Arg1, typename Arg2>
+ResultType ParallelDifference(const Arg1& a1, const Arg2& a2) {
+    std::vector<typename Arg1::value_type> difference;
+    utils::ParallelSetDifference(a1.begin(), a1.end(), a2.begin(), a2.end(), &difference);
+    return ::internal::MergeResult<ResultType>::Adopt(std::move(difference));
+}
+
+} // namespace std
+
+#endif  // !UTILS_STL_UTIL_PARALLEL_INCLUDE_H_
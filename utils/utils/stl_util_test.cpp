@@ -0,0 +1,175 @@
+#include <Windows.h>
+#include "utils/stl_util.h"
+#include "utils/strings/inline_string.h"
+#include "utils/strings/tokenizer.h"
+#include "utils/test_util.h"
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef TEST
+
+namespace {
+
+// Heap blocks handed out by CountingAllocator.
+std::atomic<size_t> g_allocations(0);
+
+// std::allocator that counts its allocations, so the benchmark sees what
+// each way of parsing allocates without replacing operator new.
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        typedef CountingAllocator<U> other;
+    };
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+// std::string and std::vector, counted.
+typedef std::basic_string<char, std::char_traits<char>, CountingAllocator<char>> CountedString;
+template <typename T>
+using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+template <typename Function>
+size_t CountAllocations(Function function) {
+    const size_t before = g_allocations.load(std::memory_order_relaxed);
+    function();
+    return g_allocations.load(std::memory_order_relaxed) - before;
+}
+
+}  // namespace
+
+int STL_UTIL_TEST(void) {
+    const std::string text = "  key.path = C:\\some\\dir  ";
+    const std::string_view line = std::string_view(text).substr(1);
+
+    if (x::TrimString(line, " ", TRIM_ALL) != "key.path = C:\\some\\dir") __debugbreak();
+    if (x::TrimString(line, " ", TRIM_LEADING) != "key.path = C:\\some\\dir  ") __debugbreak();
+    if (!x::TrimString("    ", " ", TRIM_TRAILING).empty()) __debugbreak();
+    if (x::TrimWhitespaceASCII(line, TRIM_TRAILING) != " key.path = C:\\some\\dir") __debugbreak();
+    if (x::TrimWhitespace(std::wstring_view(L"\x3000 wide\t"), TRIM_ALL) != L"wide") __debugbreak();
+
+    // The copying forms still accept their output as input.
+    std::string in_place = text;
+    if (!x::TrimString(in_place, " ", &in_place) || in_place != "key.path = C:\\some\\dir") __debugbreak();
+    if (!x::ReplaceChars(in_place, "\\", "\\\\", &in_place) || in_place != "key.path = C:\\\\some\\\\dir") __debugbreak();
+    if (!x::RemoveChars(in_place, "\\ ", &in_place) || in_place != "key.path=C:somedir") __debugbreak();
+    if (x::RemoveChars(in_place, "#", &in_place) || in_place != "key.path=C:somedir") __debugbreak();
+    std::wstring wide = L"a-b-c";
+    if (!x::ReplaceChars(wide, L"-", L"--", &wide) || wide != L"a--b--c") __debugbreak();
+
+    if (!x::StartsWithASCII(line.substr(1), "KEY", false) || x::StartsWithASCII("ke", "key", false)) __debugbreak();
+    if (!x::StartsWith(L"Prefix", L"pre", false) || x::StartsWith(L"Prefix", L"pre", true)) __debugbreak();
+    if (!x::EndsWith(line.substr(0, 9), "PATH", false) || x::EndsWith("h", "path", true)) __debugbreak();
+    if (!x::ContainsOnlyChars("20180101", "0123456789") || x::ContainsOnlyChars(line, " ")) __debugbreak();
+    if (!x::EqualsASCII(L"ascii", "ascii") || x::EqualsASCII(L"ascii", "asci")) __debugbreak();
+    if (!x::LowerCaseEqualsASCII(std::string_view("MiXeD"), "mixed")) __debugbreak();
+
+    std::vector<std::string_view> views;
+    std::vector<std::string> copies;
+    if (x::Tokenize(line, " =", &views) != 2 || views[0] != "key.path" || views[1] != "C:\\some\\dir") __debugbreak();
+    if (x::Tokenize(line, '=', &copies) != 2 || copies[0] != " key.path " || copies[1] != " C:\\some\\dir  ")
+        __debugbreak();
+    if (x::JoinString(views, "|") != "key.path|C:\\some\\dir") __debugbreak();
+    if (x::JoinString(copies, ',') != " key.path , C:\\some\\dir  ") __debugbreak();
+    if (x::JoinString({ "a", "b", "c" }, ", ") != "a, b, c" || !x::JoinString({}, ",").empty()) __debugbreak();
+    if (x::JoinString(std::vector<std::wstring>{ L"x", L"y" }, L'/') != L"x/y") __debugbreak();
+    return 0;
+}
+
+// Parses a 100000 line configuration file the way callers had to with the
+// std::string signatures (copying each line, the literals and every field)
+// and with the string_view ones, and prints the allocations and time each
+// takes. The owned strings and the vectors count their allocations; the
+// std::string forms call the same templates with CountedString.
+int STL_UTIL_BENCHMARK(void) {
+    std::string config;
+    for (int i = 0; i < 100000; ++i) {
+        config += i % 10 ? "    section.entry_" + std::to_string(i) + ".path = C:\\Programs\\Vendor\\" +
+                               std::to_string(i * 7) + "  \n"
+                         : "# a comment line that is long enough to live on the heap\n";
+    }
+
+    size_t matches = 0;
+    long long copying_time = 0;
+    const size_t copying = CountAllocations([&]() {
+        copying_time = TimeMicroseconds([&]() {
+            CountedVector<CountedString> lines, fields;
+            ::internal::TokenizeT(config, CountedString("\n"), &lines);
+            for (const CountedString& line : lines) {
+                if (x::StartsWithASCII(line, CountedString("#"), true)) continue;
+                const CountedString trimmed(x::TrimString(line, kWhitespaceASCII, TRIM_ALL));
+                if (::internal::TokenizeT(trimmed, CountedString(" ="), &fields) != 2) continue;
+                if (x::EndsWith(fields[0], CountedString(".PATH"), false) &&
+                    !x::ContainsOnlyChars(fields[1], CountedString("0123456789")))
+                    matches += ::internal::JoinStringT<CountedString>(fields.begin(), fields.end(), CountedString("="))
+                                   .size();
+            }
+        });
+    });
+
+    long long view_time = 0;
+    const size_t view = CountAllocations([&]() {
+        view_time = TimeMicroseconds([&]() {
+            CountedVector<std::string_view> lines, fields;
+            ::internal::TokenizeT(config, "\n", &lines);
+            for (std::string_view line : lines) {
+                if (x::StartsWithASCII(line, "#", true)) continue;
+                const std::string_view trimmed = x::TrimString(line, kWhitespaceASCII, TRIM_ALL);
+                if (::internal::TokenizeT(trimmed, " =", &fields) != 2) continue;
+                if (x::EndsWith(fields[0], ".PATH", false) && !x::ContainsOnlyChars(fields[1], "0123456789"))
+                    matches += ::internal::JoinStringT<CountedString>(fields.begin(), fields.end(), "=").size();
+            }
+        });
+    });
+
+    std::cout << "Config parse: std::string " << copying << " allocations " << copying_time << "us, string_view "
+              << view << " allocations " << view_time << "us (" << copying - view << " eliminated)" << std::endl;
+
+    // The same fields kept as owned strings, for callers that outlive the
+    // input: std::string spills every key to the heap, InlineString none.
+    // InlineString allocates with new[], so its spills are counted by hand.
+    size_t keys = 0;
+    long long string_time = 0;
+    const size_t strings = CountAllocations([&]() {
+        string_time = TimeMicroseconds([&]() {
+            CountedVector<CountedString> fields;
+            for (std::string_view line : utils::TokenizeView(config, "\n")) {
+                if (::internal::TokenizeT(line, " =", &fields) != 2) continue;
+                keys += ::internal::JoinStringT<CountedString>(fields.begin(), fields.end(), "=").size();
+            }
+        });
+    });
+    long long inline_time = 0;
+    size_t spilled = 0;
+    const size_t inlined = CountAllocations([&]() {
+        inline_time = TimeMicroseconds([&]() {
+            typedef utils::InlineString<char, 64> Field;
+            CountedVector<Field> fields;
+            for (std::string_view line : utils::TokenizeView(config, "\n")) {
+                if (::internal::TokenizeT(line, " =", &fields) != 2) continue;
+                const Field joined = ::internal::JoinStringT<Field>(fields.begin(), fields.end(), "=");
+                for (const Field& field : fields) spilled += !field.is_inline();
+                spilled += !joined.is_inline();
+                keys -= joined.size();
+            }
+        });
+    });
+
+    std::cout << "Owned fields: std::string " << strings << " allocations " << string_time << "us, InlineString "
+              << inlined + spilled << " allocations " << inline_time << "us" << std::endl;
+    return matches && !keys ? 0 : 1;
+}
+
+#endif // TEST
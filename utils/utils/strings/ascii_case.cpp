@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/ascii_case.h"
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+// |first| is 'A' to fold to lower case and 'a' to fold to upper case; either
+// way the letters differ from their counterparts only in bit 0x20.
+template <typename Char>
+inline Char FoldScalar(Char c, Char first) {
+    return (c >= first && c <= first + 25) ? static_cast<Char>(c ^ 0x20) : c;
+}
+
+template <typename Char>
+void FoldScalarRun(const Char* src, size_t length, Char* dst, Char first) {
+    for (size_t i = 0; i < length; ++i) dst[i] = FoldScalar(src[i], first);
+}
+
+template <typename Char>
+bool EqualsScalarRun(const Char* a, const Char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (FoldScalar(a[i], Char('A')) != FoldScalar(b[i], Char('A'))) return false;
+    }
+    return true;
+}
+
+// Compares exactly like internal::DoLowerCaseEqualsASCII(): a wide character is
+// never equal to a |b| byte above 0x7F.
+template <typename Char>
+bool LowerEqualsScalarRun(const Char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (FoldScalar(a[i], Char('A')) != b[i]) return false;
+    }
+    return true;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+template <typename Char>
+TARGET_ISA("sse2") inline __m128i Fold128(__m128i v, Char first) {
+    using namespace utils::simd;
+    const __m128i letters = InRange128(v, first, Char(26));
+    return _mm_xor_si128(v, _mm_and_si128(letters, Broadcast128(Char(0x20))));
+}
+
+template <typename Char>
+TARGET_ISA("avx2") inline __m256i Fold256(__m256i v, Char first) {
+    using namespace utils::simd;
+    const __m256i letters = InRange256(v, first, Char(26));
+    return _mm256_xor_si256(v, _mm256_and_si256(letters, Broadcast256(Char(0x20))));
+}
+
+// Widens the next 128 / sizeof(Char) bytes of |b| to the lane size of Char.
+// Returns false if one of them is not ASCII, which can never compare equal.
+TARGET_ISA("sse2") inline bool LoadASCII128(const char* b, __m128i* out, char) {
+    *out = utils::simd::Load128(b);
+    return utils::simd::MoveMask128(*out) == 0;
+}
+
+TARGET_ISA("sse2") inline bool LoadASCII128(const char* b, __m128i* out, char16) {
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b));
+    *out = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+    return (utils::simd::MoveMask128(bytes) & 0xFF) == 0;
+}
+
+TARGET_ISA("avx2") inline bool LoadASCII256(const char* b, __m256i* out, char) {
+    *out = utils::simd::Load256(b);
+    return utils::simd::MoveMask256(*out) == 0;
+}
+
+TARGET_ISA("avx2") inline bool LoadASCII256(const char* b, __m256i* out, char16) {
+    const __m128i bytes = utils::simd::Load128(b);
+    *out = _mm256_cvtepu8_epi16(bytes);
+    return utils::simd::MoveMask128(bytes) == 0;
+}
+
+template <typename Char>
+TARGET_ISA("sse2") void FoldSSE2(const Char* src, size_t length, Char* dst, Char first) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k128 <= length; i += Lanes<Char>::k128) {
+        Store128(dst + i, Fold128(Load128(src + i), first));
+    }
+    FoldScalarRun(src + i, length - i, dst + i, first);
+}
+
+template <typename Char>
+TARGET_ISA("sse2") bool EqualsSSE2(const Char* a, const Char* b, size_t length) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k128 <= length; i += Lanes<Char>::k128) {
+        const __m128i x = Fold128(Load128(a + i), Char('A'));
+        const __m128i y = Fold128(Load128(b + i), Char('A'));
+        if (MoveMask128(Equal128(x, y, Char())) != 0xFFFF) return false;
+    }
+    return EqualsScalarRun(a + i, b + i, length - i);
+}
+
+template <typename Char>
+TARGET_ISA("sse2") bool LowerEqualsSSE2(const Char* a, const char* b, size_t length) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k128 <= length; i += Lanes<Char>::k128) {
+        __m128i y;
+        if (!LoadASCII128(b + i, &y, Char())) break;
+        const __m128i x = Fold128(Load128(a + i), Char('A'));
+        if (MoveMask128(Equal128(x, y, Char())) != 0xFFFF) return false;
+    }
+    return LowerEqualsScalarRun(a + i, b + i, length - i);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") void FoldAVX2(const Char* src, size_t length, Char* dst, Char first) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k256 <= length; i += Lanes<Char>::k256) {
+        Store256(dst + i, Fold256(Load256(src + i), first));
+    }
+    _mm256_zeroupper();
+    FoldSSE2(src + i, length - i, dst + i, first);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") bool EqualsAVX2(const Char* a, const Char* b, size_t length) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k256 <= length; i += Lanes<Char>::k256) {
+        const __m256i x = Fold256(Load256(a + i), Char('A'));
+        const __m256i y = Fold256(Load256(b + i), Char('A'));
+        if (MoveMask256(Equal256(x, y, Char())) != 0xFFFFFFFF) return false;
+    }
+    _mm256_zeroupper();
+    return EqualsSSE2(a + i, b + i, length - i);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") bool LowerEqualsAVX2(const Char* a, const char* b, size_t length) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + Lanes<Char>::k256 <= length; i += Lanes<Char>::k256) {
+        __m256i y;
+        if (!LoadASCII256(b + i, &y, Char())) break;
+        const __m256i x = Fold256(Load256(a + i), Char('A'));
+        if (MoveMask256(Equal256(x, y, Char())) != 0xFFFFFFFF) return false;
+    }
+    _mm256_zeroupper();
+    return LowerEqualsSSE2(a + i, b + i, length - i);
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+template <typename Char>
+struct CaseKernels {
+    void (*fold)(const Char*, size_t, Char*, Char);
+    bool (*equals)(const Char*, const Char*, size_t);
+    bool (*lower_equals)(const Char*, const char*, size_t);
+
+    // wchar_t is 32 bits wide outside Windows, where only the scalar loops
+    // exist.
+    static CaseKernels Select() {
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (sizeof(Char) <= 2) {
+            const utils::CPU& cpu = utils::CPU::Get();
+            if (cpu.has_avx2()) return { &FoldAVX2<Char>, &EqualsAVX2<Char>, &LowerEqualsAVX2<Char> };
+            if (cpu.has_sse2()) return { &FoldSSE2<Char>, &EqualsSSE2<Char>, &LowerEqualsSSE2<Char> };
+        }
+#endif
+        return { &FoldScalarRun<Char>, &EqualsScalarRun<Char>, &LowerEqualsScalarRun<Char> };
+    }
+
+    static const CaseKernels& Get() {
+        static const CaseKernels kernels = Select();
+        return kernels;
+    }
+};
+
+}  // namespace
+
+void utils::ToLowerASCIIInPlace(char* str, size_t length) {
+    CaseKernels<char>::Get().fold(str, length, str, 'A');
+}
+
+void utils::ToLowerASCIIInPlace(char16* str, size_t length) {
+    CaseKernels<char16>::Get().fold(str, length, str, L'A');
+}
+
+void utils::ToUpperASCIIInPlace(char* str, size_t length) {
+    CaseKernels<char>::Get().fold(str, length, str, 'a');
+}
+
+void utils::ToUpperASCIIInPlace(char16* str, size_t length) {
+    CaseKernels<char16>::Get().fold(str, length, str, L'a');
+}
+
+void utils::CopyToLowerASCII(const char* src, size_t length, char* dst) {
+    CaseKernels<char>::Get().fold(src, length, dst, 'A');
+}
+
+void utils::CopyToLowerASCII(const char16* src, size_t length, char16* dst) {
+    CaseKernels<char16>::Get().fold(src, length, dst, L'A');
+}
+
+void utils::CopyToUpperASCII(const char* src, size_t length, char* dst) {
+    CaseKernels<char>::Get().fold(src, length, dst, 'a');
+}
+
+void utils::CopyToUpperASCII(const char16* src, size_t length, char16* dst) {
+    CaseKernels<char16>::Get().fold(src, length, dst, L'a');
+}
+
+bool utils::EqualsCaseInsensitiveASCII(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && CaseKernels<char>::Get().equals(a.data(), b.data(), a.size());
+}
+
+bool utils::EqualsCaseInsensitiveASCII(std::basic_string_view<char16> a, std::basic_string_view<char16> b) {
+    return a.size() == b.size() && CaseKernels<char16>::Get().equals(a.data(), b.data(), a.size());
+}
+
+bool utils::LowerCaseEqualsASCII(std::string_view a, std::string_view lowercase_ascii) {
+    return a.size() == lowercase_ascii.size() &&
+        CaseKernels<char>::Get().lower_equals(a.data(), lowercase_ascii.data(), a.size());
+}
+
+bool utils::LowerCaseEqualsASCII(std::basic_string_view<char16> a, std::string_view lowercase_ascii) {
+    return a.size() == lowercase_ascii.size() &&
+        CaseKernels<char16>::Get().lower_equals(a.data(), lowercase_ascii.data(), a.size());
+}
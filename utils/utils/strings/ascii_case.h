@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_ASCII_CASE_INCLUDE_H_
+#define UTILS_STRINGS_ASCII_CASE_INCLUDE_H_
+
+#include <string_view>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Bulk, locale-independent ASCII case folding. Only 'A'-'Z' and 'a'-'z' are
+// touched, exactly like ToLowerASCII()/ToUpperASCII() in stl_util.h, but 16 or
+// 32 bytes are handled per step with SSE2/AVX2 when the CPU has them. The
+// 16-bit char16 kernels are used where wchar_t is UTF-16; elsewhere the wide
+// overloads run the scalar loop.
+namespace utils {
+
+// Folds the |length| characters at |str| in place.
+UTILS_API void ToLowerASCIIInPlace(char* str, size_t length);
+UTILS_API void ToLowerASCIIInPlace(char16* str, size_t length);
+UTILS_API void ToUpperASCIIInPlace(char* str, size_t length);
+UTILS_API void ToUpperASCIIInPlace(char16* str, size_t length);
+
+// Writes the |length| folded characters of |src| to |dst|, which may be |src|.
+// This makes the copying StringToLowerASCII() a single pass.
+UTILS_API void CopyToLowerASCII(const char* src, size_t length, char* dst);
+UTILS_API void CopyToLowerASCII(const char16* src, size_t length, char16* dst);
+UTILS_API void CopyToUpperASCII(const char* src, size_t length, char* dst);
+UTILS_API void CopyToUpperASCII(const char16* src, size_t length, char16* dst);
+
+// Returns true if |a| and |b| are equal ignoring ASCII case. Nothing is
+// copied.
+UTILS_API bool EqualsCaseInsensitiveASCII(std::string_view a, std::string_view b);
+UTILS_API bool EqualsCaseInsensitiveASCII(std::basic_string_view<char16> a, std::basic_string_view<char16> b);
+
+// Returns true if the lower-case form of |a| equals |lowercase_ascii|, which
+// must already be lower-case ASCII. Same contract as x::LowerCaseEqualsASCII().
+UTILS_API bool LowerCaseEqualsASCII(std::string_view a, std::string_view lowercase_ascii);
+UTILS_API bool LowerCaseEqualsASCII(std::basic_string_view<char16> a, std::string_view lowercase_ascii);
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_ASCII_CASE_INCLUDE_H_
@@ -0,0 +1,60 @@
+#include <Windows.h>
+#include "utils/strings/ascii_case.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+int ASCII_CASE_TEST(void) {
+    std::string mixed = "Content-Type: TEXT/HTML; Charset=UTF-8 [@`{] \xC3\x89T\xC3\xA9";
+    std::string lower = mixed;
+    for (auto& c : lower) c = ToLowerASCII(c);
+    if (x::StringToLowerASCII(mixed) != lower) __debugbreak();
+    if (!x::EqualsCaseInsensitiveASCII(mixed, x::StringToUpperASCII(mixed))) __debugbreak();
+    if (!x::LowerCaseEqualsASCII(mixed, lower.c_str())) __debugbreak();
+
+    std::wstring wide = L"Accept-Encoding: GZIP, Deflate \x00C9\x0130";
+    std::wstring wide_upper = wide;
+    x::StringToUpperASCII(&wide_upper);
+    if (!x::EqualsCaseInsensitiveASCII(wide, wide_upper)) __debugbreak();
+    if (!x::LowerCaseEqualsASCII(std::wstring(L"Accept-Encoding: GZIP"), "accept-encoding: gzip")) __debugbreak();
+    if (x::LowerCaseEqualsASCII(std::wstring(L"\x00E9"), "\xE9")) __debugbreak();
+    return 0;
+}
+
+// Folds and compares a batch of typical HTTP header names one character at a
+// time, as stl_util.h used to, and with the vectorized kernels.
+int ASCII_CASE_BENCHMARK(void) {
+    const int kRounds = 2000000;
+    std::string header = "X-Forwarded-For-Original-Client-Address";
+    const std::string lower = x::StringToLowerASCII(header);
+    size_t matches = 0;
+
+    auto scalar_fold = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) {
+            for (auto& c : header) c = (i & 1) ? ToUpperASCII(c) : ToLowerASCII(c);
+        }
+    });
+    auto vector_fold = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) {
+            if (i & 1) x::StringToUpperASCII(&header);
+            else x::StringToLowerASCII(&header);
+        }
+    });
+    auto scalar_compare = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) {
+            matches += ::internal::DoLowerCaseEqualsASCII(header.begin(), header.end(), lower.c_str());
+        }
+    });
+    auto vector_compare = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) matches += x::LowerCaseEqualsASCII(header, lower.c_str());
+    });
+
+    std::cout << "fold: scalar " << scalar_fold << "us, vector " << vector_fold << "us" << std::endl;
+    std::cout << "LowerCaseEqualsASCII: scalar " << scalar_compare << "us, vector " << vector_compare << "us" << std::endl;
+    return matches == 2 * kRounds ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/char_set.h"
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+using utils::CharSet;
+
+template <typename Char>
+size_t ScanScalar(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+    for (size_t i = 0; i < length; ++i) {
+        if (set.Contains(str[i]) == want_member) return i;
+    }
+    return length;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// Compare every character against each member of a small set.
+template <typename Char>
+TARGET_ISA("sse2") size_t CompareSSE2(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k128;
+    const size_t count = set.size();
+    if (!count) return want_member ? length : 0;
+    __m128i needles[CharSet<Char>::kMaxVectorChars];
+    for (size_t d = 0; d < count; ++d) needles[d] = Broadcast128(set.members()[d]);
+
+    const uint32 flip = want_member ? 0 : 0xFFFF;
+    size_t i = 0;
+    for (; i + kLanes <= length; i += kLanes) {
+        const __m128i chunk = Load128(str + i);
+        __m128i hits = Equal128(chunk, needles[0], Char());
+        for (size_t d = 1; d < count; ++d) hits = _mm_or_si128(hits, Equal128(chunk, needles[d], Char()));
+        const uint32 mask = MoveMask128(hits) ^ flip;
+        if (mask) return i + LowestSetBit(mask) / sizeof(Char);
+    }
+    return i + ScanScalar(str + i, length - i, set, want_member);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") size_t CompareAVX2(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k256;
+    const size_t count = set.size();
+    if (!count) return want_member ? length : 0;
+    __m256i needles[CharSet<Char>::kMaxVectorChars];
+    for (size_t d = 0; d < count; ++d) needles[d] = Broadcast256(set.members()[d]);
+
+    const uint32 flip = want_member ? 0 : 0xFFFFFFFF;
+    size_t i = 0;
+    for (; i + kLanes <= length; i += kLanes) {
+        const __m256i chunk = Load256(str + i);
+        __m256i hits = Equal256(chunk, needles[0], Char());
+        for (size_t d = 1; d < count; ++d) hits = _mm256_or_si256(hits, Equal256(chunk, needles[d], Char()));
+        const uint32 mask = MoveMask256(hits) ^ flip;
+        if (mask) return i + LowestSetBit(mask) / sizeof(Char);
+    }
+    // The tail is shorter than one YMM register; let SSE2 take what it can.
+    // Clear the upper halves first so the legacy SSE code pays no transition
+    // penalty.
+    _mm256_zeroupper();
+    return i + CompareSSE2(str + i, length - i, set, want_member);
+}
+
+// Look every character up in a table of ASCII members: the low nibble picks
+// a byte of CharSet::nibbles(), the high nibble one of its bits. Bytes of
+// 0x80 and up have no bit to pick, so they never match. char16 values are
+// clamped to 0xFF before they are packed to bytes: packus saturates them as
+// signed, which would turn 0x8000 and up into 0x00, a lookup of NUL.
+TARGET_ISA("ssse3") inline __m128i LoadBytes128(const char* str) {
+    return utils::simd::Load128(str);
+}
+TARGET_ISA("ssse3") inline __m128i ClampToByte128(__m128i x) {
+    // x - max(x - 0xFF, 0) is min(x, 0xFF) without SSE4.1's min_epu16.
+    return _mm_sub_epi16(x, _mm_subs_epu16(x, _mm_set1_epi16(0xFF)));
+}
+TARGET_ISA("ssse3") inline __m128i LoadBytes128(const char16* str) {
+    return _mm_packus_epi16(ClampToByte128(utils::simd::Load128(str)), ClampToByte128(utils::simd::Load128(str + 8)));
+}
+
+template <typename Char>
+TARGET_ISA("ssse3") size_t LookupSSSE3(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+    using namespace utils::simd;
+    const __m128i low_table = Load128(set.nibbles());
+    const __m128i high_table = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const uint32 flip = want_member ? 0xFFFF : 0;
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i bytes = LoadBytes128(str + i);
+        const __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(bytes, nibble));
+        const __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        // Set for the characters that are not members.
+        const __m128i misses = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+        const uint32 mask = MoveMask128(misses) ^ flip;
+        if (mask) return i + LowestSetBit(mask);
+    }
+    return i + ScanScalar(str + i, length - i, set, want_member);
+}
+
+TARGET_ISA("avx2") inline __m256i LoadBytes256(const char* str) {
+    return utils::simd::Load256(str);
+}
+TARGET_ISA("avx2") inline __m256i LoadBytes256(const char16* str) {
+    // packus works within each 128-bit lane; put the quadwords back in order.
+    const __m256i byte_max = _mm256_set1_epi16(0xFF);
+    const __m256i packed = _mm256_packus_epi16(_mm256_min_epu16(utils::simd::Load256(str), byte_max),
+                                               _mm256_min_epu16(utils::simd::Load256(str + 16), byte_max));
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") size_t LookupAVX2(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+    using namespace utils::simd;
+    const __m256i low_table = _mm256_broadcastsi128_si256(Load128(set.nibbles()));
+    const __m256i high_table = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const uint32 flip = want_member ? 0xFFFFFFFF : 0;
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i bytes = LoadBytes256(str + i);
+        const __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(bytes, nibble));
+        const __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        const __m256i misses = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        const uint32 mask = MoveMask256(misses) ^ flip;
+        if (mask) return i + LowestSetBit(mask);
+    }
+    _mm256_zeroupper();
+    return i + LookupSSSE3(str + i, length - i, set, want_member);
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+template <typename Char>
+struct ScanKernels {
+    typedef size_t (*Function)(const Char*, size_t, const CharSet<Char>&, bool);
+
+    Function lookup = &ScanScalar<Char>;
+    Function compare = &ScanScalar<Char>;
+
+    // wchar_t is 32 bits wide outside Windows, where only the scalar scan
+    // exists.
+    static ScanKernels Select() {
+        ScanKernels kernels;
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (sizeof(Char) <= 2) {
+            const utils::CPU& cpu = utils::CPU::Get();
+            if (cpu.has_avx2()) {
+                kernels.lookup = &LookupAVX2<Char>;
+                kernels.compare = &CompareAVX2<Char>;
+            } else {
+                if (cpu.has_ssse3()) kernels.lookup = &LookupSSSE3<Char>;
+                if (cpu.has_sse2()) kernels.compare = &CompareSSE2<Char>;
+            }
+        }
+#endif
+        return kernels;
+    }
+
+    static size_t Run(const Char* str, size_t length, const CharSet<Char>& set, bool want_member) {
+        static const ScanKernels kernels = Select();
+        if (set.ascii()) return kernels.lookup(str, length, set, want_member);
+        if (set.vectorizable()) return kernels.compare(str, length, set, want_member);
+        return ScanScalar(str, length, set, want_member);
+    }
+};
+
+}  // namespace
+
+size_t utils::internal::FindFirstOf(const char* str, size_t length, const CharSet<char>& set) {
+    return ScanKernels<char>::Run(str, length, set, true);
+}
+
+size_t utils::internal::FindFirstOf(const char16* str, size_t length, const CharSet<char16>& set) {
+    return ScanKernels<char16>::Run(str, length, set, true);
+}
+
+size_t utils::internal::FindFirstNotOf(const char* str, size_t length, const CharSet<char>& set) {
+    return ScanKernels<char>::Run(str, length, set, false);
+}
+
+size_t utils::internal::FindFirstNotOf(const char16* str, size_t length, const CharSet<char16>& set) {
+    return ScanKernels<char16>::Run(str, length, set, false);
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_CHAR_SET_INCLUDE_H_
+#define UTILS_STRINGS_CHAR_SET_INCLUDE_H_
+
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// A set of characters built once and then tested in constant time, so that
+// scanning a string for its members is linear in the string alone. Characters
+// below 256 live in a bitmap; wider ones in 256-bit pages indexed by their
+// high byte, and anything above U+FFFF (32-bit wchar_t) in a sorted list.
+//
+// The scans in utils::internal below also run 16 or 32 characters at a time:
+// sets of ASCII characters of any size through a nibble lookup table
+// (SSSE3/AVX2), and other sets of up to |kMaxVectorChars| characters by
+// comparing against each member (SSE2/AVX2).
+// Example:
+//   static const utils::CharSet<char> kUnsafe("<>:\"/\\|?*");
+//   x::RemoveChars(name, kUnsafe, &name);
+template <typename Char>
+class CharSet {
+public:
+    typedef typename std::make_unsigned<Char>::type Unsigned;
+
+    static const size_t kMaxVectorChars = 16;
+
+    CharSet() {}
+    explicit CharSet(std::basic_string_view<Char> chars) {
+        for (Char c : chars) Add(c);
+    }
+
+    void Add(Char c) {
+        const uint32 u = static_cast<Unsigned>(c);
+        if (Contains(c)) return;
+        if (count_ < kMaxVectorChars) members_[count_] = c;
+        ++count_;
+        if (u < 256) {
+            bitmap_[u >> 5] |= 1u << (u & 31);
+            if (u < 128) nibbles_[u & 15] |= static_cast<uint8>(1u << (u >> 4));
+            else ascii_ = false;
+            return;
+        }
+        ascii_ = false;
+        if (u > 0xFFFF) {
+            wide_.insert(std::upper_bound(wide_.begin(), wide_.end(), u), u);
+            return;
+        }
+        if (pages_index_.empty()) pages_index_.resize(256);
+        uint8& page = pages_index_[u >> 8];
+        if (!page) {
+            pages_.resize(pages_.size() + 8);
+            page = static_cast<uint8>(pages_.size() / 8);
+        }
+        pages_[(page - 1) * 8 + ((u & 0xFF) >> 5)] |= 1u << (u & 31);
+    }
+
+    bool Contains(Char c) const {
+        const uint32 u = static_cast<Unsigned>(c);
+        if (u < 256) return (bitmap_[u >> 5] >> (u & 31)) & 1;
+        if (u > 0xFFFF) return std::binary_search(wide_.begin(), wide_.end(), u);
+        if (pages_index_.empty() || !pages_index_[u >> 8]) return false;
+        return (pages_[(pages_index_[u >> 8] - 1) * 8 + ((u & 0xFF) >> 5)] >> (u & 31)) & 1;
+    }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // True if every member is ASCII; such sets use the lookup table scans.
+    bool ascii() const { return ascii_; }
+    // The members, when there are at most |kMaxVectorChars| of them.
+    bool vectorizable() const { return count_ <= kMaxVectorChars; }
+    const Char* members() const { return members_; }
+    // Bit (c >> 4) of nibbles()[c & 15] is set for each ASCII member c.
+    const uint8* nibbles() const { return nibbles_; }
+
+private:
+    uint32 bitmap_[8] = { 0 };
+    uint8 nibbles_[16] = { 0 };
+    Char members_[kMaxVectorChars] = { 0 };
+    size_t count_ = 0;
+    bool ascii_ = true;
+    // Page n - 1 of |pages_| holds the high byte whose index entry is n.
+    std::vector<uint8> pages_index_;
+    std::vector<uint32> pages_;
+    std::vector<uint32> wide_;
+};
+
+namespace internal {
+
+// Return the offset of the first character of [str, str + length) that is
+// (FindFirstOf) or is not (FindFirstNotOf) in |set|, or |length| when there
+// is none. The kernels are chosen once per process from utils::CPU.
+UTILS_API size_t FindFirstOf(const char* str, size_t length, const CharSet<char>& set);
+UTILS_API size_t FindFirstOf(const char16* str, size_t length, const CharSet<char16>& set);
+UTILS_API size_t FindFirstNotOf(const char* str, size_t length, const CharSet<char>& set);
+UTILS_API size_t FindFirstNotOf(const char16* str, size_t length, const CharSet<char16>& set);
+
+} // namespace internal
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_CHAR_SET_INCLUDE_H_
@@ -0,0 +1,212 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/format.h"
+
+#include <string.h>
+
+#include <charconv>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+using utils::internal::FormatArg;
+using utils::internal::FormatOutput;
+using utils::internal::FormatSpec;
+
+const char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes |value| so that it ends just before |end| and returns its first
+// character. Two digits are produced per division.
+char* FormatDecimal(uint64 value, char* end) {
+    while (value >= 100) {
+        const size_t pair = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = kDigitPairs[pair + 1];
+        *--end = kDigitPairs[pair];
+    }
+    if (value >= 10) {
+        *--end = kDigitPairs[value * 2 + 1];
+        *--end = kDigitPairs[value * 2];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+char* FormatHex(uint64 value, bool upper, char* end) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    do {
+        *--end = digits[value & 15];
+        value >>= 4;
+    } while (value);
+    return end;
+}
+
+// Appends text that is either of the output's character type or ASCII, which
+// is widened a block at a time.
+template <typename Char, typename Source>
+void AppendText(FormatOutput<Char>* output, const Source* text, size_t length) {
+    if constexpr (std::is_same<Char, Source>::value) {
+        output->Append(text, length);
+    } else {
+        Char wide[64];
+        while (length) {
+            const size_t count = std::min(length, arraysize(wide));
+            for (size_t i = 0; i < count; ++i) wide[i] = static_cast<unsigned char>(text[i]);
+            output->Append(wide, count);
+            text += count;
+            length -= count;
+        }
+    }
+}
+
+// Appends |prefix| (a sign or "0x") and |body| padded to the field width.
+template <typename Char, typename Source>
+void AppendField(FormatOutput<Char>* output, const FormatSpec& spec, bool numeric, const char* prefix,
+                 const Source* body, size_t length) {
+    const size_t prefix_length = strlen(prefix);
+    const size_t used = prefix_length + length;
+    const size_t padding = spec.width > used ? spec.width - used : 0;
+    if (numeric && spec.zero && !spec.left) {
+        AppendText(output, prefix, prefix_length);
+        output->Fill('0', padding);
+        AppendText(output, body, length);
+        return;
+    }
+    if (!spec.left) output->Fill(' ', padding);
+    AppendText(output, prefix, prefix_length);
+    AppendText(output, body, length);
+    if (spec.left) output->Fill(' ', padding);
+}
+
+template <typename Char, typename Float>
+void AppendFloat(FormatOutput<Char>* output, const FormatSpec& spec, Float value) {
+    const bool negative = std::signbit(value);
+    const Float magnitude = negative ? -value : value;
+    const int precision = spec.precision < 0 ? 6 : spec.precision;
+
+    // Large values in fixed notation need up to 309 integer digits, which only
+    // the second attempt makes room for.
+    char buffer[64];
+    std::vector<char> large;
+    char* begin = buffer;
+    char* end = buffer + sizeof(buffer);
+    for (;;) {
+        std::to_chars_result result;
+        switch (spec.type) {
+        case 'e':
+            result = std::to_chars(begin, end, magnitude, std::chars_format::scientific, precision);
+            break;
+        case 'g':
+            result = std::to_chars(begin, end, magnitude, std::chars_format::general, precision);
+            break;
+        case 'f':
+            result = std::to_chars(begin, end, magnitude, std::chars_format::fixed, precision);
+            break;
+        default:
+            result = spec.precision < 0 ? std::to_chars(begin, end, magnitude)
+                                        : std::to_chars(begin, end, magnitude, std::chars_format::fixed, precision);
+            break;
+        }
+        if (result.ec == std::errc()) {
+            end = result.ptr;
+            break;
+        }
+        large.resize(400 + precision);
+        begin = large.data();
+        end = begin + large.size();
+    }
+    AppendField(output, spec, std::isfinite(value), negative ? "-" : "", begin, end - begin);
+}
+
+template <typename Char>
+void AppendArgument(FormatOutput<Char>* output, const FormatSpec& spec, const FormatArg<Char>& arg) {
+    // Room for a 64-bit value in decimal or hexadecimal.
+    char buffer[24];
+    char* const end = buffer + sizeof(buffer);
+    switch (arg.type) {
+    case utils::internal::FORMAT_ARG_BOOL:
+        AppendField(output, spec, false, "", arg.u ? "true" : "false", arg.u ? 4 : 5);
+        break;
+    case utils::internal::FORMAT_ARG_CHAR:
+        AppendField(output, spec, false, "", &arg.c, 1);
+        break;
+    case utils::internal::FORMAT_ARG_INT:
+    case utils::internal::FORMAT_ARG_UINT: {
+        const bool negative = arg.type == utils::internal::FORMAT_ARG_INT && arg.i < 0;
+        const uint64 magnitude = negative ? 0 - arg.u : arg.u;
+        const char* begin = spec.type == 'x' || spec.type == 'X' ? FormatHex(magnitude, spec.type == 'X', end)
+                                                                : FormatDecimal(magnitude, end);
+        AppendField(output, spec, true, negative ? "-" : "", begin, end - begin);
+        break;
+    }
+    case utils::internal::FORMAT_ARG_FLOAT:
+        AppendFloat(output, spec, arg.f);
+        break;
+    case utils::internal::FORMAT_ARG_DOUBLE:
+        AppendFloat(output, spec, arg.d);
+        break;
+    case utils::internal::FORMAT_ARG_STRING: {
+        size_t length = arg.length;
+        if (spec.precision >= 0) length = std::min(length, static_cast<size_t>(spec.precision));
+        AppendField(output, spec, false, "", arg.s, length);
+        break;
+    }
+    case utils::internal::FORMAT_ARG_POINTER: {
+        const char* begin = FormatHex(arg.u, spec.type == 'X', end);
+        AppendField(output, spec, true, "0x", begin, end - begin);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// The format was checked when it was compiled, so a malformed field cannot
+// occur here; it just ends the output.
+template <typename Char>
+void DoFormat(FormatOutput<Char>* output, const Char* format, size_t length, const FormatArg<Char>* args,
+              size_t count) {
+    size_t literal = 0;
+    size_t arg = 0;
+    for (size_t i = 0; i < length;) {
+        const Char c = format[i];
+        if (c != '{' && c != '}') {
+            ++i;
+            continue;
+        }
+        output->Append(format + literal, i - literal);
+        if (i + 1 < length && format[i + 1] == c) {
+            // Keep the second brace of "{{" or "}}" as literal text.
+            literal = i + 1;
+            i += 2;
+            continue;
+        }
+        FormatSpec spec;
+        if (c == '}' || !utils::internal::ParseFormatSpec(format, length, &i, &spec)) return;
+        if (arg < count) AppendArgument(output, spec, args[arg++]);
+        literal = i;
+    }
+    output->Append(format + literal, length - literal);
+}
+
+}  // namespace
+
+void utils::internal::VFormat(FormatOutput<char>* output, const char* format, size_t length,
+                              const FormatArg<char>* args, size_t count) {
+    DoFormat(output, format, length, args, count);
+}
+
+void utils::internal::VFormat(FormatOutput<char16>* output, const char16* format, size_t length,
+                              const FormatArg<char16>* args, size_t count) {
+    DoFormat(output, format, length, args, count);
+}
@@ -0,0 +1,451 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_FORMAT_INCLUDE_H_
+#define UTILS_STRINGS_FORMAT_INCLUDE_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Type-safe formatting that checks its format string at compile time and never
+// goes through the CRT printf family or the locale. A replacement field is {}
+// or {:spec}, where spec is
+//   [<|>][0][width][.precision][type]
+// Fields are right-aligned in |width| unless '<' is given; '0' pads numbers
+// with zeros after the sign. The types are
+//   d        integer in decimal
+//   x, X     integer or pointer in hexadecimal; negative integers keep the '-'
+//   f, e, g  floating point as fixed, scientific or general, precision 6
+//   s        string, or bool as "true" / "false"; precision truncates
+//   c        character
+// Without a type every argument takes its natural form, and a floating point
+// value prints the shortest text that reads back as the same value, or fixed
+// notation when a precision is given. "{{" and "}}" are literal braces.
+//
+// Arguments may be bool, integers, enums, floating point, pointers, and
+// characters and strings of the format's own character type. The format must
+// be wrapped in UTILS_FORMAT(), and a count or spec that does not match the
+// arguments fails to compile:
+//   char buffer[64];
+//   utils::FormatTo(buffer, UTILS_FORMAT("{} of {} ({:.1f}%)"), done, total, percent);
+//   std::wstring name = utils::Format(UTILS_FORMAT(L"{}-{:04}.log"), prefix, index);
+namespace utils {
+namespace internal {
+
+enum FormatArgType {
+    FORMAT_ARG_NONE,  // Not formattable with the format's character type.
+    FORMAT_ARG_BOOL,
+    FORMAT_ARG_CHAR,
+    FORMAT_ARG_INT,
+    FORMAT_ARG_UINT,
+    FORMAT_ARG_FLOAT,
+    FORMAT_ARG_DOUBLE,
+    FORMAT_ARG_STRING,
+    FORMAT_ARG_POINTER,
+};
+
+template <typename T>
+constexpr bool IsCharacterType() {
+    return std::is_same<T, char>::value || std::is_same<T, wchar_t>::value || std::is_same<T, char16_t>::value ||
+           std::is_same<T, char32_t>::value;
+}
+
+template <typename Char, typename T>
+constexpr FormatArgType FormatArgTypeOf() {
+    typedef typename std::remove_cv<typename std::decay<T>::type>::type U;
+    if constexpr (std::is_same<U, bool>::value) {
+        return FORMAT_ARG_BOOL;
+    } else if constexpr (std::is_same<U, Char>::value) {
+        return FORMAT_ARG_CHAR;
+    } else if constexpr (IsCharacterType<U>()) {
+        return FORMAT_ARG_NONE;
+    } else if constexpr (std::is_enum<U>::value) {
+        return FormatArgTypeOf<Char, typename std::underlying_type<U>::type>();
+    } else if constexpr (std::is_integral<U>::value) {
+        return std::is_signed<U>::value ? FORMAT_ARG_INT : FORMAT_ARG_UINT;
+    } else if constexpr (std::is_same<U, float>::value) {
+        return FORMAT_ARG_FLOAT;
+    } else if constexpr (std::is_floating_point<U>::value) {
+        return FORMAT_ARG_DOUBLE;
+    } else if constexpr (std::is_same<U, std::basic_string<Char>>::value ||
+                         std::is_same<U, std::basic_string_view<Char>>::value) {
+        return FORMAT_ARG_STRING;
+    } else if constexpr (std::is_pointer<U>::value) {
+        typedef typename std::remove_cv<typename std::remove_pointer<U>::type>::type Pointee;
+        if constexpr (std::is_same<Pointee, Char>::value) return FORMAT_ARG_STRING;
+        // A string of another character type would print as an address.
+        else if constexpr (IsCharacterType<Pointee>()) return FORMAT_ARG_NONE;
+        else return FORMAT_ARG_POINTER;
+    } else if constexpr (std::is_null_pointer<U>::value) {
+        return FORMAT_ARG_POINTER;
+    } else {
+        return FORMAT_ARG_NONE;
+    }
+}
+
+// One argument with its type erased, so the engine is compiled once per
+// character type rather than once per argument list.
+template <typename Char>
+struct FormatArg {
+    FormatArgType type;
+    union {
+        uint64 u;
+        int64 i;
+        float f;
+        double d;
+        Char c;
+        const Char* s;
+    };
+    size_t length;  // Of |s|.
+};
+
+template <typename Char, typename T>
+FormatArg<Char> MakeFormatArg(const T& value) {
+    constexpr FormatArgType kType = FormatArgTypeOf<Char, T>();
+    FormatArg<Char> arg = {};
+    arg.type = kType;
+    if constexpr (kType == FORMAT_ARG_BOOL) {
+        arg.u = value ? 1 : 0;
+    } else if constexpr (kType == FORMAT_ARG_CHAR) {
+        arg.c = value;
+    } else if constexpr (kType == FORMAT_ARG_INT) {
+        arg.i = static_cast<int64>(value);
+    } else if constexpr (kType == FORMAT_ARG_UINT) {
+        arg.u = static_cast<uint64>(value);
+    } else if constexpr (kType == FORMAT_ARG_FLOAT) {
+        arg.f = value;
+    } else if constexpr (kType == FORMAT_ARG_DOUBLE) {
+        arg.d = static_cast<double>(value);
+    } else if constexpr (kType == FORMAT_ARG_STRING && std::is_class<T>::value) {
+        arg.s = value.data();
+        arg.length = value.size();
+    } else if constexpr (kType == FORMAT_ARG_STRING) {
+        const Char* s = value;
+        arg.s = s;
+        arg.length = s ? std::char_traits<Char>::length(s) : 0;
+    } else if constexpr (kType == FORMAT_ARG_POINTER && std::is_null_pointer<T>::value) {
+        arg.u = 0;
+    } else if constexpr (kType == FORMAT_ARG_POINTER) {
+        arg.u = reinterpret_cast<uintptr_t>(value);
+    }
+    return arg;
+}
+
+struct FormatSpec {
+    bool left = false;
+    bool zero = false;
+    size_t width = 0;
+    int precision = -1;
+    char type = 0;
+};
+
+// Bounds for width and precision, which keep a field's size predictable.
+const size_t kMaxFormatWidth = 4096;
+const int kMaxFormatPrecision = 999;
+
+constexpr bool IsFormatType(int c) {
+    return c == 'd' || c == 'x' || c == 'X' || c == 'f' || c == 'e' || c == 'g' || c == 's' || c == 'c';
+}
+
+// Parses the replacement field that starts at the '{' at |*index| and moves
+// |*index| past its '}'. Returns false if the field is malformed.
+template <typename Char>
+constexpr bool ParseFormatSpec(const Char* format, size_t length, size_t* index, FormatSpec* spec) {
+    size_t i = *index + 1;
+    if (i < length && format[i] == ':') {
+        ++i;
+        if (i < length && (format[i] == '<' || format[i] == '>')) spec->left = format[i++] == '<';
+        if (i < length && format[i] == '0') {
+            spec->zero = true;
+            ++i;
+        }
+        for (; i < length && '0' <= format[i] && format[i] <= '9'; ++i) {
+            spec->width = spec->width * 10 + (format[i] - '0');
+            if (spec->width > kMaxFormatWidth) return false;
+        }
+        if (i < length && format[i] == '.') {
+            ++i;
+            if (i == length || format[i] < '0' || '9' < format[i]) return false;
+            spec->precision = 0;
+            for (; i < length && '0' <= format[i] && format[i] <= '9'; ++i) {
+                spec->precision = spec->precision * 10 + (format[i] - '0');
+                if (spec->precision > kMaxFormatPrecision) return false;
+            }
+        }
+        if (i < length && IsFormatType(format[i])) spec->type = static_cast<char>(format[i++]);
+    }
+    if (i == length || format[i] != '}') return false;
+    *index = i + 1;
+    return true;
+}
+
+constexpr bool FormatSpecSuits(const FormatSpec& spec, FormatArgType type) {
+    const bool integer = type == FORMAT_ARG_INT || type == FORMAT_ARG_UINT;
+    const bool floating = type == FORMAT_ARG_FLOAT || type == FORMAT_ARG_DOUBLE;
+    const bool no_precision = spec.precision < 0;
+    switch (spec.type) {
+    case 0:
+        return no_precision || floating || type == FORMAT_ARG_STRING;
+    case 'd':
+        return integer && no_precision;
+    case 'x':
+    case 'X':
+        return (integer || type == FORMAT_ARG_POINTER) && no_precision;
+    case 'f':
+    case 'e':
+    case 'g':
+        return floating;
+    case 's':
+        return type == FORMAT_ARG_STRING || (type == FORMAT_ARG_BOOL && no_precision);
+    case 'c':
+        return type == FORMAT_ARG_CHAR && no_precision;
+    }
+    return false;
+}
+
+enum FormatError {
+    FORMAT_OK,
+    FORMAT_UNMATCHED_BRACE,
+    FORMAT_BAD_FIELD,
+    FORMAT_TOO_FEW_ARGUMENTS,
+    FORMAT_TOO_MANY_ARGUMENTS,
+    FORMAT_UNSUPPORTED_ARGUMENT,
+    FORMAT_SPEC_MISMATCH,
+};
+
+template <typename Char>
+constexpr FormatError CheckFormat(const Char* format, size_t length, const FormatArgType* types, size_t count) {
+    for (size_t a = 0; a < count; ++a) {
+        if (types[a] == FORMAT_ARG_NONE) return FORMAT_UNSUPPORTED_ARGUMENT;
+    }
+    size_t arg = 0;
+    for (size_t i = 0; i < length;) {
+        if (format[i] != '{' && format[i] != '}') {
+            ++i;
+        } else if (i + 1 < length && format[i + 1] == format[i]) {
+            i += 2;
+        } else if (format[i] == '}') {
+            return FORMAT_UNMATCHED_BRACE;
+        } else {
+            FormatSpec spec;
+            if (!ParseFormatSpec(format, length, &i, &spec)) return FORMAT_BAD_FIELD;
+            if (arg == count) return FORMAT_TOO_FEW_ARGUMENTS;
+            if (!FormatSpecSuits(spec, types[arg++])) return FORMAT_SPEC_MISMATCH;
+        }
+    }
+    return arg == count ? FORMAT_OK : FORMAT_TOO_MANY_ARGUMENTS;
+}
+
+// Where formatted text goes. Text beyond the capacity is dropped unless Grow()
+// makes room, but it is still counted by size(), as snprintf() counts it.
+// One character past the capacity is always kept for the terminating null.
+template <typename Char>
+class FormatOutput {
+public:
+    size_t size() const { return size_; }
+
+    void Append(const Char* text, size_t length) {
+        if (size_ + length > capacity_ && !Grow(size_ + length)) {
+            if (size_ < capacity_) std::copy_n(text, capacity_ - size_, data_ + size_);
+        } else {
+            std::copy_n(text, length, data_ + size_);
+        }
+        size_ += length;
+    }
+
+    void Fill(Char c, size_t count) {
+        if (size_ + count > capacity_ && !Grow(size_ + count)) {
+            if (size_ < capacity_) std::fill_n(data_ + size_, capacity_ - size_, c);
+        } else {
+            std::fill_n(data_ + size_, count, c);
+        }
+        size_ += count;
+    }
+
+    void Terminate() {
+        if (data_) data_[std::min(size_, capacity_)] = 0;
+    }
+
+protected:
+    FormatOutput(Char* data, size_t capacity) : data_(data), capacity_(capacity) {}
+    virtual ~FormatOutput() {}
+
+    // Makes room for at least |capacity| characters, or returns false.
+    virtual bool Grow(size_t capacity) = 0;
+
+    Char* data_;
+    size_t size_ = 0;
+    size_t capacity_;
+};
+
+template <typename Char>
+class FixedFormatOutput : public FormatOutput<Char> {
+public:
+    FixedFormatOutput(Char* buffer, size_t size) : FormatOutput<Char>(size ? buffer : nullptr, size ? size - 1 : 0) {}
+
+protected:
+    bool Grow(size_t /* capacity */) override { return false; }
+};
+
+// Formats into the spare capacity of a string and trims it afterwards.
+template <typename Char>
+class StringFormatOutput : public FormatOutput<Char> {
+public:
+    explicit StringFormatOutput(std::basic_string<Char>* output) : FormatOutput<Char>(nullptr, 0), output_(output) {
+        this->size_ = output->size();
+        Resize(output->capacity());
+    }
+    ~StringFormatOutput() override { output_->resize(this->size_); }
+
+protected:
+    bool Grow(size_t capacity) override {
+        Resize(std::max(capacity, this->capacity_ * 2));
+        return true;
+    }
+
+private:
+    void Resize(size_t capacity) {
+        output_->resize(capacity);
+        this->data_ = &(*output_)[0];
+        this->capacity_ = capacity;
+    }
+
+    std::basic_string<Char>* output_;
+};
+
+UTILS_API void VFormat(FormatOutput<char>* output, const char* format, size_t length, const FormatArg<char>* args,
+                       size_t count);
+UTILS_API void VFormat(FormatOutput<char16>* output, const char16* format, size_t length,
+                       const FormatArg<char16>* args, size_t count);
+
+// Base of the format string types UTILS_FORMAT() creates.
+struct CompileTimeFormat {};
+
+template <typename S, typename Result>
+using EnableIfFormat = typename std::enable_if<std::is_base_of<CompileTimeFormat, S>::value, Result>::type;
+
+template <typename S>
+using FormatChar = typename std::remove_cv<typename std::remove_pointer<decltype(S::data())>::type>::type;
+
+template <typename S, typename Char, typename... Args>
+void FormatWith(FormatOutput<Char>* output, const Args&... args) {
+    static_assert(std::is_same<Char, FormatChar<S>>::value, "format string and output use different character types");
+    constexpr FormatArgType kTypes[] = { FormatArgTypeOf<Char, Args>()..., FORMAT_ARG_NONE };
+    constexpr FormatError kError = CheckFormat(S::data(), S::size(), kTypes, sizeof...(Args));
+    static_assert(kError != FORMAT_UNMATCHED_BRACE, "unmatched '}' in format string, write '}}' for a brace");
+    static_assert(kError != FORMAT_BAD_FIELD, "malformed replacement field in format string");
+    static_assert(kError != FORMAT_TOO_FEW_ARGUMENTS, "format string has more fields than arguments");
+    static_assert(kError != FORMAT_TOO_MANY_ARGUMENTS, "format string has fewer fields than arguments");
+    static_assert(kError != FORMAT_UNSUPPORTED_ARGUMENT, "argument cannot be formatted with this character type");
+    static_assert(kError != FORMAT_SPEC_MISMATCH, "format spec does not suit the type of its argument");
+
+    const FormatArg<Char> values[] = { MakeFormatArg<Char>(args)..., FormatArg<Char>() };
+    VFormat(output, S::data(), S::size(), values, sizeof...(Args));
+    output->Terminate();
+}
+
+} // namespace internal
+
+// Makes a string literal usable as a format string; see the top of the file.
+#define UTILS_FORMAT(s)                                                         \
+    [] {                                                                        \
+        struct FormatString : ::utils::internal::CompileTimeFormat {            \
+            static constexpr auto data() { return s; }                          \
+            static constexpr size_t size() { return sizeof(s) / sizeof(*s) - 1; } \
+        };                                                                      \
+        return FormatString();                                                  \
+    }()
+
+// A growable buffer that keeps up to |N| - 1 characters and the terminating
+// null inline, so most results never touch the heap.
+template <typename Char, size_t N = 256>
+class BasicFormatBuffer : public internal::FormatOutput<Char> {
+public:
+    typedef std::basic_string<Char> String;
+    typedef std::basic_string_view<Char> StringView;
+
+    BasicFormatBuffer() : internal::FormatOutput<Char>(inline_, N - 1) { inline_[0] = 0; }
+
+    const Char* data() const { return this->data_; }
+    const Char* c_str() const { return this->data_; }
+    size_t size() const { return this->size_; }
+    bool empty() const { return this->size_ == 0; }
+    StringView view() const { return StringView(this->data_, this->size_); }
+    String str() const { return String(this->data_, this->size_); }
+
+    // Keeps the heap block, if one was needed, for the next use.
+    void clear() {
+        this->size_ = 0;
+        this->data_[0] = 0;
+    }
+
+protected:
+    bool Grow(size_t capacity) override {
+        const size_t grown = std::max(capacity, this->capacity_ * 2);
+        std::unique_ptr<Char[]> heap(new Char[grown + 1]);
+        std::copy_n(this->data_, this->size_, heap.get());
+        heap_ = std::move(heap);
+        this->data_ = heap_.get();
+        this->capacity_ = grown;
+        return true;
+    }
+
+private:
+    Char inline_[N];
+    std::unique_ptr<Char[]> heap_;
+
+    DISALLOW_COPY_AND_ASSIGN(BasicFormatBuffer);
+};
+
+typedef BasicFormatBuffer<char> FormatBuffer;
+typedef BasicFormatBuffer<char16> WFormatBuffer;
+
+// Writes at most |size| - 1 characters and a terminating null to |buffer|,
+// and returns the length of the whole result, as snprintf() does: a return
+// value of |size| or more means the text was truncated.
+template <typename S, typename Char, typename... Args>
+internal::EnableIfFormat<S, size_t> FormatTo(Char* buffer, size_t size, S /* format */, const Args&... args) {
+    internal::FixedFormatOutput<Char> output(buffer, size);
+    internal::FormatWith<S>(&output, args...);
+    return output.size();
+}
+
+template <typename S, typename Char, size_t N, typename... Args>
+internal::EnableIfFormat<S, size_t> FormatTo(Char (&buffer)[N], S format, const Args&... args) {
+    return FormatTo(buffer, N, format, args...);
+}
+
+template <typename S, typename Char, size_t N, typename... Args>
+internal::EnableIfFormat<S, void> FormatAppend(BasicFormatBuffer<Char, N>* buffer, S /* format */, const Args&... args) {
+    internal::FormatWith<S>(buffer, args...);
+}
+
+template <typename S, typename Char, typename... Args>
+internal::EnableIfFormat<S, void> FormatAppend(std::basic_string<Char>* output, S /* format */, const Args&... args) {
+    internal::StringFormatOutput<Char> string_output(output);
+    internal::FormatWith<S>(&string_output, args...);
+}
+
+template <typename S, typename... Args>
+internal::EnableIfFormat<S, std::basic_string<internal::FormatChar<S>>> Format(S format, const Args&... args) {
+    std::basic_string<internal::FormatChar<S>> result;
+    FormatAppend(&result, format, args...);
+    return result;
+}
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_FORMAT_INCLUDE_H_
@@ -0,0 +1,118 @@
+#include <Windows.h>
+#include "utils/strings/format.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+namespace {
+
+enum Color { RED, GREEN = 7 };
+
+}  // namespace
+
+int FORMAT_TEST(void) {
+    if (utils::Format(UTILS_FORMAT("plain text")) != "plain text") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{{}} }}{{")) != "{} }{") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{} {} {} {}"), true, false, 'c', RED) != "true false c 0") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{:s}|{:<6}|{:>6}|{:.3}"), true, "left", "right", std::string("truncate")) !=
+        "true|left  | right|tru") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{:c}{}"), 'x', std::string_view("yz")) != "xyz") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{}"), static_cast<const char*>(nullptr)) != "") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{:x} {:X} {:08x} {:x}"), 255, 255u, 0xbeefu, -255) != "ff FF 0000beef -ff")
+        __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{:x}"), reinterpret_cast<const void*>(0x1234)) != "0x1234") __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{}"), nullptr) != "0x0") __debugbreak();
+
+    // Integers at every width and both ends of their range, against the CRT.
+    const int64 integers[] = { 0, 1, -1, 9, 10, 99, 100, -100, 12345, -987654, kint32max, kint32min, kint64max, kint64min };
+    char expected[128], buffer[128];
+    for (int64 value : integers) {
+        x::snprintf(expected, sizeof(expected), "%lld|%8lld|%-8lld|%08lld", value, value, value, value);
+        utils::FormatTo(buffer, UTILS_FORMAT("{}|{:8}|{:<8}|{:08}"), value, value, value, value);
+        if (strcmp(buffer, expected) != 0) __debugbreak();
+    }
+    if (utils::Format(UTILS_FORMAT("{} {} {}"), kuint64max, static_cast<uint8>(200), static_cast<int16>(-300)) !=
+        "18446744073709551615 200 -300") __debugbreak();
+
+    // Floating point: shortest round trip by default, printf's rounding with a
+    // precision.
+    if (utils::Format(UTILS_FORMAT("{} {} {} {}"), 0.1, 0.1f, 1e300, -0.0) != "0.1 0.1 1e+300 -0") __debugbreak();
+    const double doubles[] = { 0.0, 0.5, 2.5, -1.125, 3.14159265358979, 1e-7, 123456789.987654321, 1e22 };
+    for (double value : doubles) {
+        x::snprintf(expected, sizeof(expected), "%f|%.2f|%12.3f|%012.1f|%e|%g", value, value, value, value, value, value);
+        utils::FormatTo(buffer, UTILS_FORMAT("{:f}|{:.2}|{:12.3f}|{:012.1f}|{:e}|{:g}"), value, value, value, value,
+                        value, value);
+        if (strcmp(buffer, expected) != 0) __debugbreak();
+    }
+    if (utils::Format(UTILS_FORMAT("{:.0f}"), 1e300).size() != 301) __debugbreak();
+    if (utils::Format(UTILS_FORMAT("{:6}|{:06}"), HUGE_VAL, -HUGE_VAL) != "   inf|  -inf") __debugbreak();
+
+    // Truncation follows snprintf: the full length is returned and the buffer
+    // always ends in a null.
+    char small[8];
+    if (utils::FormatTo(small, UTILS_FORMAT("{}-{}"), 1234, 5678) != 9) __debugbreak();
+    if (strcmp(small, "1234-56") != 0) __debugbreak();
+    if (utils::FormatTo(small, 0, UTILS_FORMAT("{}"), 1) != 1) __debugbreak();
+
+    utils::BasicFormatBuffer<char, 16> growable;
+    for (int i = 0; i < 100; ++i) utils::FormatAppend(&growable, UTILS_FORMAT("{},"), i);
+    std::string joined;
+    for (int i = 0; i < 100; ++i) joined += std::to_string(i) + ",";
+    if (growable.view() != joined || strlen(growable.c_str()) != joined.size()) __debugbreak();
+    growable.clear();
+    if (!growable.empty() || growable.c_str()[0] != 0) __debugbreak();
+
+    std::string appended = "prefix ";
+    utils::FormatAppend(&appended, UTILS_FORMAT("{:>40}"), "suffix");
+    if (appended != "prefix " + std::string(34, ' ') + "suffix") __debugbreak();
+
+    const std::wstring wide = utils::Format(UTILS_FORMAT(L"{}-{:04}.{}|{:x}|{}"), L"log", 7, std::wstring(L"txt"), 171,
+                                            -2.5);
+    if (wide != L"log-0007.txt|ab|-2.5") __debugbreak();
+    wchar_t wide_buffer[4];
+    if (utils::FormatTo(wide_buffer, UTILS_FORMAT(L"{}{}"), L'\x4E2D', 12345) != 6) __debugbreak();
+    if (std::wstring(wide_buffer) != L"\x4E2D" L"12") __debugbreak();
+
+    // Each of these fails to compile:
+    //   utils::Format(UTILS_FORMAT("{} {}"), 1);           // too few arguments
+    //   utils::Format(UTILS_FORMAT("{}"), 1, 2);           // too many arguments
+    //   utils::Format(UTILS_FORMAT("{:d}"), "text");       // spec mismatch
+    //   utils::Format(UTILS_FORMAT("{}"), L"wide");        // wrong character type
+    //   utils::Format(UTILS_FORMAT("}"));                  // unmatched brace
+    return 0;
+}
+
+// Formats one million log lines into a stack buffer with x::snprintf() and
+// with utils::FormatTo().
+int FORMAT_BENCHMARK(void) {
+    const int kLines = 1000000;
+    char buffer[256];
+    size_t sizes = 0;
+    auto crt = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLines; ++i) {
+            sizes += x::snprintf(buffer, sizeof(buffer), "[%08x] request %d took %.3fms (%s)", i * 2654435761u, i,
+                                 i * 0.001, "ok");
+        }
+    });
+    auto engine = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLines; ++i) {
+            sizes += utils::FormatTo(buffer, UTILS_FORMAT("[{:08x}] request {} took {:.3f}ms ({})"), i * 2654435761u,
+                                     i, i * 0.001, "ok");
+        }
+    });
+    auto integers = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLines; ++i) sizes += x::snprintf(buffer, sizeof(buffer), "%d,%d,%d", i, -i, i * 7);
+    });
+    auto engine_integers = TimeMicroseconds([&]() {
+        for (int i = 0; i < kLines; ++i) sizes += utils::FormatTo(buffer, UTILS_FORMAT("{},{},{}"), i, -i, i * 7);
+    });
+
+    std::cout << "Log line: snprintf " << crt << "us, FormatTo " << engine << "us" << std::endl;
+    std::cout << "Integers: snprintf " << integers << "us, FormatTo " << engine_integers << "us" << std::endl;
+    return sizes ? 0 : 1;
+}
+
+#endif // TEST
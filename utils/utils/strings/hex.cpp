@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/hex.h"
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+const char kLowerDigits[] = "0123456789abcdef";
+const char kUpperDigits[] = "0123456789ABCDEF";
+
+inline const char* DigitsFor(utils::HexCase hex_case) {
+    return hex_case == utils::HEX_UPPERCASE ? kUpperDigits : kLowerDigits;
+}
+
+// Returns the value of |c|, or 16 or more if it is not a hex digit.
+inline uint32 DigitValue(uint8 c) {
+    const uint32 digit = c - uint32('0');
+    if (digit < 10) return digit;
+    const uint32 letter = (c | 0x20) - uint32('a');
+    return letter < 6 ? letter + 10 : 16;
+}
+
+void EncodeScalar(const uint8* data, size_t size, char* out, const char* digits) {
+    for (size_t i = 0; i < size; ++i) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+}
+
+bool DecodeScalar(const char* hex, size_t size, uint8* out) {
+    for (size_t i = 0; i < size; ++i) {
+        const uint32 high = DigitValue(static_cast<uint8>(hex[2 * i]));
+        const uint32 low = DigitValue(static_cast<uint8>(hex[2 * i + 1]));
+        if ((high | low) > 15) return false;
+        out[i] = static_cast<uint8>(high << 4 | low);
+    }
+    return true;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// The digit for each nibble is looked up in a 16-entry shuffle table; the two
+// digits of each byte are then interleaved, high nibble first.
+TARGET_ISA("ssse3") void EncodeSSSE3(const uint8* data, size_t size, char* out, const char* digits) {
+    using namespace utils::simd;
+    const __m128i table = Load128(digits);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = Load128(data + i);
+        const __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        const __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(bytes, nibble));
+        Store128(out + 2 * i, _mm_unpacklo_epi8(high, low));
+        Store128(out + 2 * i + 16, _mm_unpackhi_epi8(high, low));
+    }
+    EncodeScalar(data + i, size - i, out + 2 * i, digits);
+}
+
+TARGET_ISA("avx2") void EncodeAVX2(const uint8* data, size_t size, char* out, const char* digits) {
+    using namespace utils::simd;
+    const __m256i table = _mm256_broadcastsi128_si256(Load128(digits));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i bytes = Load256(data + i);
+        const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        const __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(bytes, nibble));
+        // The unpacks work within each 128-bit lane: |first| holds bytes 0-7
+        // and 16-23, |second| bytes 8-15 and 24-31.
+        const __m256i first = _mm256_unpacklo_epi8(high, low);
+        const __m256i second = _mm256_unpackhi_epi8(high, low);
+        Store256(out + 2 * i, _mm256_permute2x128_si256(first, second, 0x20));
+        Store256(out + 2 * i + 32, _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    _mm256_zeroupper();
+    EncodeSSSE3(data + i, size - i, out + 2 * i, digits);
+}
+
+// Maps 16 characters to their digit values and sets |*valid| to the
+// characters that are hex digits: '0'-'9' by subtracting '0', and letters of
+// either case by setting bit 0x20 and subtracting 'a'. Unsigned x < n is
+// tested as min(x, n - 1) == x.
+TARGET_ISA("ssse3") inline __m128i DigitValues128(__m128i c, __m128i* valid) {
+    const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    *valid = _mm_or_si128(is_digit, is_letter);
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+TARGET_ISA("avx2") inline __m256i DigitValues256(__m256i c, __m256i* valid) {
+    const __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    *valid = _mm256_or_si256(is_digit, is_letter);
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+// Each pair of digit values is combined as high * 16 + low with one
+// multiply-add into a 16-bit lane, and the lanes are packed back to bytes.
+TARGET_ISA("ssse3") bool DecodeSSSE3(const char* hex, size_t size, uint8* out) {
+    using namespace utils::simd;
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i valid_first, valid_second;
+        const __m128i first = DigitValues128(Load128(hex + 2 * i), &valid_first);
+        const __m128i second = DigitValues128(Load128(hex + 2 * i + 16), &valid_second);
+        if (MoveMask128(_mm_and_si128(valid_first, valid_second)) != 0xFFFF) return false;
+        Store128(out + i, _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights)));
+    }
+    return DecodeScalar(hex + 2 * i, size - i, out + i);
+}
+
+TARGET_ISA("avx2") bool DecodeAVX2(const char* hex, size_t size, uint8* out) {
+    using namespace utils::simd;
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i valid_first, valid_second;
+        const __m256i first = DigitValues256(Load256(hex + 2 * i), &valid_first);
+        const __m256i second = DigitValues256(Load256(hex + 2 * i + 32), &valid_second);
+        if (MoveMask256(_mm256_and_si256(valid_first, valid_second)) != 0xFFFFFFFF) {
+            _mm256_zeroupper();
+            return false;
+        }
+        // packus works within each 128-bit lane; put the quadwords back in
+        // order.
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights),
+                                                   _mm256_maddubs_epi16(second, weights));
+        Store256(out + i, _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    _mm256_zeroupper();
+    return DecodeSSSE3(hex + 2 * i, size - i, out + i);
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+// |size| counts bytes on both sides.
+struct HexKernels {
+    void (*encode)(const uint8*, size_t, char*, const char*) = &EncodeScalar;
+    bool (*decode)(const char*, size_t, uint8*) = &DecodeScalar;
+
+    static const HexKernels& Get() {
+        static const HexKernels kernels = Select();
+        return kernels;
+    }
+
+    static HexKernels Select() {
+        HexKernels kernels;
+#if defined(ARCH_CPU_X86_FAMILY)
+        const utils::CPU& cpu = utils::CPU::Get();
+        if (cpu.has_avx2()) {
+            kernels.encode = &EncodeAVX2;
+            kernels.decode = &DecodeAVX2;
+        } else if (cpu.has_ssse3()) {
+            kernels.encode = &EncodeSSSE3;
+            kernels.decode = &DecodeSSSE3;
+        }
+#endif
+        return kernels;
+    }
+};
+
+}  // namespace
+
+void utils::HexEncode(const void* data, size_t size, char* out, HexCase hex_case) {
+    HexKernels::Get().encode(static_cast<const uint8*>(data), size, out, DigitsFor(hex_case));
+}
+
+bool utils::HexDecode(const char* hex, size_t length, uint8* out) {
+    if (length % 2) return false;
+    return HexKernels::Get().decode(hex, length / 2, out);
+}
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_HEX_INCLUDE_H_
+#define UTILS_STRINGS_HEX_INCLUDE_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Bulk hexadecimal encoding and decoding of byte spans, for digests, keys and
+// binary blobs. Decoding accepts exactly the digits IsHexDigit() in
+// stl_util.h does, in either case. 16 or 32 bytes are handled per step with
+// SSSE3/AVX2 shuffles when the CPU has them. The pointer forms write into
+// the caller's buffer and never allocate.
+namespace utils {
+
+enum HexCase {
+    HEX_LOWERCASE,
+    HEX_UPPERCASE,
+};
+
+// Writes the 2 * |size| digits for the bytes at |data| to |out|. No
+// terminating null is written.
+UTILS_API void HexEncode(const void* data, size_t size, char* out, HexCase hex_case = HEX_LOWERCASE);
+
+// Writes the |length| / 2 bytes spelled by the digits at |hex| to |out|.
+// Returns false, with |out| partly written, if |length| is odd or any
+// character is not a hex digit.
+UTILS_API bool HexDecode(const char* hex, size_t length, uint8* out);
+
+inline std::string HexEncode(const void* data, size_t size, HexCase hex_case = HEX_LOWERCASE) {
+    std::string hex(size * 2, '\0');
+    if (size) HexEncode(data, size, &hex[0], hex_case);
+    return hex;
+}
+
+// Replaces |*bytes| with the decoded |hex|. |*bytes| is left empty on
+// failure.
+inline bool HexDecode(std::string_view hex, std::vector<uint8>* bytes) {
+    bytes->resize(hex.size() / 2);
+    if (!HexDecode(hex.data(), hex.size(), bytes->data())) {
+        bytes->clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_HEX_INCLUDE_H_
@@ -0,0 +1,98 @@
+#include <Windows.h>
+#include "utils/strings/hex.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// The per-character decoding that callers wrote before HexDecode().
+bool DecodeWithHexDigitToInt(const char* hex, size_t length, uint8* out) {
+    if (length % 2) return false;
+    for (size_t i = 0; i < length; i += 2) {
+        if (!IsHexDigit(hex[i]) || !IsHexDigit(hex[i + 1])) return false;
+        out[i / 2] = static_cast<uint8>(HexDigitToInt(hex[i]) << 4 | HexDigitToInt(hex[i + 1]));
+    }
+    return true;
+}
+
+}  // namespace
+
+int HEX_TEST(void) {
+    const uint8 digest[] = { 0xd4, 0x1d, 0x8c, 0xd9, 0x8f, 0x00, 0xb2, 0x04, 0xe9, 0x80, 0x09, 0x98, 0xec, 0xf8, 0x42, 0x7e };
+    if (utils::HexEncode(digest, sizeof(digest)) != "d41d8cd98f00b204e9800998ecf8427e") __debugbreak();
+    if (utils::HexEncode(digest, 4, utils::HEX_UPPERCASE) != "D41D8CD9" || !utils::HexEncode(digest, 0).empty())
+        __debugbreak();
+    std::vector<uint8> bytes;
+    if (!utils::HexDecode("D41d8CD98f00B204e9800998ECF8427e", &bytes) ||
+        bytes != std::vector<uint8>(digest, digest + sizeof(digest))) __debugbreak();
+    if (utils::HexDecode("abc", &bytes) || !bytes.empty() || !utils::HexDecode("", &bytes)) __debugbreak();
+
+    // Every length around the register widths, at odd alignments, both cases,
+    // against the per-character helpers.
+    std::mt19937 random(12);
+    std::vector<uint8> data(200);
+    for (uint8& b : data) b = static_cast<uint8>(random());
+    char hex[512], expected_hex[512];
+    uint8 decoded[256], expected[256];
+    for (size_t size = 0; size <= 150; ++size) {
+        for (int hex_case = utils::HEX_LOWERCASE; hex_case <= utils::HEX_UPPERCASE; ++hex_case) {
+            const uint8* src = data.data() + size % 7;
+            for (size_t i = 0; i < size; ++i) {
+                x::snprintf(expected_hex + 2 * i, 3, hex_case == utils::HEX_UPPERCASE ? "%02X" : "%02x", src[i]);
+            }
+            utils::HexEncode(src, size, hex + 1, static_cast<utils::HexCase>(hex_case));
+            if (memcmp(hex + 1, expected_hex, 2 * size) != 0) __debugbreak();
+            if (!utils::HexDecode(hex + 1, 2 * size, decoded + 3) || memcmp(decoded + 3, src, size) != 0) __debugbreak();
+        }
+    }
+
+    // Each byte value in each position of a long input, so every lane of
+    // every kernel sees every invalid character.
+    const std::string valid = utils::HexEncode(data.data(), 100);
+    for (int c = 0; c < 256; ++c) {
+        for (size_t position : { size_t(0), size_t(17), size_t(63), size_t(64), size_t(130), size_t(199) }) {
+            std::string text = valid;
+            text[position] = static_cast<char>(c);
+            const bool ok = DecodeWithHexDigitToInt(text.data(), text.size(), expected);
+            if (utils::HexDecode(text.data(), text.size(), decoded) != ok) __debugbreak();
+            if (ok && memcmp(decoded, expected, 100) != 0) __debugbreak();
+        }
+    }
+    if (utils::HexDecode(valid.data(), valid.size() - 1, decoded)) __debugbreak();
+    return 0;
+}
+
+// Hex-encodes and decodes 64MB with a per-character loop (a digit table for
+// encoding, IsHexDigit() and HexDigitToInt() for decoding) and with
+// utils::HexEncode()/HexDecode(), and prints the time each takes.
+int HEX_BENCHMARK(void) {
+    const size_t kSize = 64 * 1024 * 1024;
+    std::vector<uint8> data(kSize), decoded(kSize);
+    std::mt19937 random(7);
+    for (uint8& b : data) b = static_cast<uint8>(random());
+    std::string hex(2 * kSize, '\0'), loop_hex(2 * kSize, '\0');
+
+    auto loop_encode = TimeMicroseconds([&]() {
+        for (size_t i = 0; i < kSize; ++i) {
+            loop_hex[2 * i] = "0123456789abcdef"[data[i] >> 4];
+            loop_hex[2 * i + 1] = "0123456789abcdef"[data[i] & 0x0F];
+        }
+    });
+    auto encode = TimeMicroseconds([&]() { utils::HexEncode(data.data(), kSize, &hex[0]); });
+    bool ok = hex == loop_hex;
+
+    auto loop_decode = TimeMicroseconds([&]() { ok &= DecodeWithHexDigitToInt(hex.data(), hex.size(), decoded.data()); });
+    auto decode = TimeMicroseconds([&]() { ok &= utils::HexDecode(hex.data(), hex.size(), decoded.data()); });
+    ok &= decoded == data;
+
+    std::cout << "Hex encode: loop " << loop_encode << "us, HexEncode " << encode << "us" << std::endl;
+    std::cout << "Hex decode: HexDigitToInt " << loop_decode << "us, HexDecode " << decode << "us" << std::endl;
+    return ok ? 0 : 1;
+}
+
+#endif // TEST
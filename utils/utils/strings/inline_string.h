@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_INLINE_STRING_INCLUDE_H_
+#define UTILS_STRINGS_INLINE_STRING_INCLUDE_H_
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// A string that keeps up to |N| characters and the terminating null inside
+// the object and only moves to the heap when it grows past that. Unlike the
+// small-string buffer of std::string, whose size the library picks (15 chars
+// or fewer), |N| is chosen by the caller, so paths, keys and names up to a
+// known length never allocate.
+//
+// It has the parts of the std::basic_string interface that the helpers in
+// stl_util.h use (reserve, resize, assign, append, replace, swap, operator[],
+// npos and so on), so the templates there accept it as their |STR|, and it
+// converts to a string view for every function taking one.
+// Example:
+//   utils::InlineString<wchar_t, MAX_PATH> path;
+//   ::GetModuleFileName(nullptr, WriteInto(&path, MAX_PATH + 1), MAX_PATH + 1);
+template <typename Char, size_t N>
+class InlineString {
+public:
+    typedef Char value_type;
+    typedef size_t size_type;
+    typedef std::char_traits<Char> traits_type;
+    typedef Char* iterator;
+    typedef const Char* const_iterator;
+    typedef std::basic_string_view<Char> StringView;
+
+    static const size_type npos = static_cast<size_type>(-1);
+    static const size_type kInlineCapacity = N;
+
+    InlineString() { inline_[0] = 0; }
+    InlineString(const Char* str) : InlineString() { assign(StringView(str)); }
+    InlineString(const Char* str, size_type length) : InlineString() { assign(str, length); }
+    explicit InlineString(StringView str) : InlineString() { assign(str); }
+    InlineString(const InlineString& other) : InlineString() { assign(other.data_, other.size_); }
+    InlineString(InlineString&& other) noexcept : InlineString() { *this = std::move(other); }
+    ~InlineString() {
+        if (!is_inline()) delete[] data_;
+    }
+
+    InlineString& operator=(const InlineString& other) { return assign(other.data_, other.size_); }
+    // Never allocates: an inline |other| fits in any buffer, which holds at
+    // least N characters, and a heap one is taken over. So std::vector moves
+    // its elements when it grows rather than copying them.
+    InlineString& operator=(InlineString&& other) noexcept {
+        if (this == &other) return *this;
+        if (other.is_inline()) {
+            traits_type::copy(data_, other.data_, other.size_);
+            SetSize(other.size_);
+            return *this;
+        }
+        if (!is_inline()) delete[] data_;
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_;
+        other.size_ = 0;
+        other.capacity_ = N;
+        other.inline_[0] = 0;
+        return *this;
+    }
+    InlineString& operator=(StringView str) { return assign(str); }
+    InlineString& operator=(const Char* str) { return assign(StringView(str)); }
+
+    operator StringView() const { return StringView(data_, size_); }
+    StringView view() const { return StringView(data_, size_); }
+
+    const Char* data() const { return data_; }
+    Char* data() { return data_; }
+    const Char* c_str() const { return data_; }
+    size_type size() const { return size_; }
+    size_type length() const { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    // True while the characters still live inside the object.
+    bool is_inline() const { return data_ == inline_; }
+
+    Char& operator[](size_type i) { return data_[i]; }
+    const Char& operator[](size_type i) const { return data_[i]; }
+    Char& front() { return data_[0]; }
+    Char& back() { return data_[size_ - 1]; }
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    void reserve(size_type capacity) {
+        if (capacity > capacity_) Reallocate(capacity);
+    }
+
+    void resize(size_type size, Char c = Char()) {
+        if (size > size_) append(size - size_, c);
+        else SetSize(size);
+    }
+
+    void clear() { SetSize(0); }
+
+    // |str| may point into this string.
+    InlineString& assign(const Char* str, size_type length) {
+        if (length > capacity_) {
+            InlineString grown;
+            grown.Reallocate(length);
+            grown.assign(str, length);
+            swap(grown);
+            return *this;
+        }
+        traits_type::move(data_, str, length);
+        SetSize(length);
+        return *this;
+    }
+    InlineString& assign(StringView str) { return assign(str.data(), str.size()); }
+
+    // |str| may point into this string.
+    InlineString& append(const Char* str, size_type length) {
+        if (size_ + length > capacity_) {
+            // Copy out of the old buffer before it is freed.
+            const size_type size = size_;
+            Reallocate(std::max(size + length, capacity_ * 2), str, length);
+            SetSize(size + length);
+            return *this;
+        }
+        traits_type::move(data_ + size_, str, length);
+        SetSize(size_ + length);
+        return *this;
+    }
+    InlineString& append(StringView str) { return append(str.data(), str.size()); }
+    InlineString& append(size_type count, Char c) {
+        reserve(size_ + count);
+        traits_type::assign(data_ + size_, count, c);
+        SetSize(size_ + count);
+        return *this;
+    }
+
+    InlineString& operator+=(StringView str) { return append(str); }
+    InlineString& operator+=(const Char* str) { return append(StringView(str)); }
+    InlineString& operator+=(Char c) { return append(1, c); }
+    void push_back(Char c) { append(1, c); }
+    void pop_back() { SetSize(size_ - 1); }
+
+    // Replaces the |count| characters at |pos| with |str|, which may point
+    // into this string.
+    InlineString& replace(size_type pos, size_type count, const Char* str, size_type length) {
+        count = std::min(count, size_ - pos);
+        InlineString result;
+        result.reserve(size_ - count + length);
+        result.append(data_, pos).append(str, length).append(data_ + pos + count, size_ - pos - count);
+        swap(result);
+        return *this;
+    }
+    InlineString& replace(size_type pos, size_type count, StringView str) {
+        return replace(pos, count, str.data(), str.size());
+    }
+
+    InlineString& erase(size_type pos = 0, size_type count = npos) {
+        count = std::min(count, size_ - pos);
+        traits_type::move(data_ + pos, data_ + pos + count, size_ - pos - count);
+        SetSize(size_ - count);
+        return *this;
+    }
+
+    InlineString substr(size_type pos = 0, size_type count = npos) const { return InlineString(view().substr(pos, count)); }
+    size_type find(StringView str, size_type pos = 0) const { return view().find(str, pos); }
+    size_type find(Char c, size_type pos = 0) const { return view().find(c, pos); }
+    int compare(StringView str) const { return view().compare(str); }
+
+    void swap(InlineString& other) noexcept {
+        InlineString tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    void SetSize(size_type size) {
+        size_ = size;
+        data_[size] = 0;
+    }
+
+    // Moves the characters to a heap block of |capacity| characters, copying
+    // |length| more from |str| after them first.
+    void Reallocate(size_type capacity, const Char* str = nullptr, size_type length = 0) {
+        Char* data = new Char[capacity + 1];
+        traits_type::copy(data, data_, size_);
+        if (length) traits_type::copy(data + size_, str, length);
+        data[size_ + length] = 0;
+        if (!is_inline()) delete[] data_;
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    Char* data_ = inline_;
+    size_type size_ = 0;
+    size_type capacity_ = N;
+    Char inline_[N + 1];
+};
+
+template <typename Char, size_t N>
+bool operator==(const InlineString<Char, N>& a, std::basic_string_view<Char> b) { return a.view() == b; }
+template <typename Char, size_t N>
+bool operator==(std::basic_string_view<Char> a, const InlineString<Char, N>& b) { return a == b.view(); }
+template <typename Char, size_t N>
+bool operator==(const InlineString<Char, N>& a, const InlineString<Char, N>& b) { return a.view() == b.view(); }
+template <typename Char, size_t N>
+bool operator==(const InlineString<Char, N>& a, const Char* b) { return a.view() == b; }
+template <typename Char, size_t N>
+bool operator!=(const InlineString<Char, N>& a, std::basic_string_view<Char> b) { return a.view() != b; }
+template <typename Char, size_t N>
+bool operator!=(const InlineString<Char, N>& a, const InlineString<Char, N>& b) { return a.view() != b.view(); }
+template <typename Char, size_t N>
+bool operator!=(const InlineString<Char, N>& a, const Char* b) { return a.view() != b; }
+template <typename Char, size_t N>
+bool operator<(const InlineString<Char, N>& a, const InlineString<Char, N>& b) { return a.view() < b.view(); }
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_INLINE_STRING_INCLUDE_H_
@@ -0,0 +1,110 @@
+#include <Windows.h>
+#include "utils/strings/inline_string.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#ifdef TEST
+
+namespace {
+
+typedef utils::InlineString<char, 32> Key;
+typedef utils::InlineString<wchar_t, 16> WideKey;
+
+}  // namespace
+
+int INLINE_STRING_TEST(void) {
+    Key key = "section.entry";
+    if (!key.is_inline() || key.size() != 13 || key != "section.entry" || key.c_str()[13] != 0) __debugbreak();
+    key += ".path";
+    key.push_back('!');
+    key.pop_back();
+    if (key != "section.entry.path" || key.find('.') != 7 || key.substr(8, 5) != "entry") __debugbreak();
+
+    // Growing past N moves to the heap once, and appending the string to
+    // itself still reads the old characters.
+    key.append(key.data(), key.size());
+    if (key != "section.entry.pathsection.entry.path" || key.is_inline()) __debugbreak();
+    key.assign(key.data() + 8, 5);
+    if (key != "entry" || key.is_inline()) __debugbreak();
+    Key moved(std::move(key));
+    if (moved != "entry" || !key.empty() || !key.is_inline() || moved.is_inline()) __debugbreak();
+    Key copy = moved;
+    copy.replace(0, 1, "E", 1);
+    copy.erase(3);
+    if (copy != "Ent" || moved != "entry") __debugbreak();
+    copy.swap(moved);
+    if (copy != "entry" || moved != "Ent") __debugbreak();
+    copy.resize(40, 'x');
+    copy.resize(2);
+    if (copy != "en" || copy.capacity() < 40) __debugbreak();
+
+    // Moves cannot throw, so a growing vector moves the heap buffers over
+    // rather than copying them.
+    static_assert(std::is_nothrow_move_constructible<Key>::value && std::is_nothrow_move_assignable<Key>::value,
+                  "InlineString moves must be noexcept");
+    std::vector<Key> keys(1, Key("a key too long for the inline buffer"));
+    const char* buffer = keys[0].data();
+    keys.resize(keys.capacity() + 1);
+    if (keys[0].data() != buffer || keys[0] != "a key too long for the inline buffer") __debugbreak();
+
+    // The stl_util templates take it as their string type.
+    const std::string_view line = "  alpha, beta,,gamma  ";
+    std::vector<Key> tokens;
+    if (::internal::TokenizeT(line, ", ", &tokens) != 3 || tokens[2] != "gamma") __debugbreak();
+    Key joined = ::internal::JoinStringT<Key>(tokens.begin(), tokens.end(), "+");
+    if (joined != "alpha+beta+gamma" || !joined.is_inline()) __debugbreak();
+    const Key padded(line);
+    std::string_view trimmed;
+    ::internal::TrimStringT<char>(padded, " ", TRIM_ALL, &trimmed);
+    if (trimmed != "alpha, beta,,gamma" || x::TrimString(padded, " ", TRIM_LEADING) != "alpha, beta,,gamma  ")
+        __debugbreak();
+    if (!x::StartsWithASCII(joined, "ALPHA", false) || !::internal::StartsWithT<char>(joined, "alpha", true)) __debugbreak();
+    if (!x::EndsWith(joined, tokens[2], true) || !x::ContainsOnlyChars(tokens[0], "ahlp")) __debugbreak();
+    Key collapsed = ::internal::CollapseWhitespaceT<Key>(line, false);
+    if (collapsed != "alpha, beta,,gamma") __debugbreak();
+    x::StringToUpperASCII(&collapsed);
+    if (collapsed != "ALPHA, BETA,,GAMMA") __debugbreak();
+    ::internal::ReplaceCharsT(collapsed, utils::CharSet<char>(","), ";", &collapsed);
+    ::internal::DoReplaceSubstringsAfterOffset(&joined, 0, utils::SubstringSearcher<char>("+"), "", true);
+    if (collapsed != "ALPHA; BETA;;GAMMA" || joined != "alphabetagamma") __debugbreak();
+
+    WideKey path;
+    const size_t length = x::swprintf(x::WriteInto(&path, 64), 64, L"C:\\dir\\%d", 12345);
+    path.resize(length);
+    if (path != L"C:\\dir\\12345" || path.is_inline()) __debugbreak();
+    return 0;
+}
+
+// Builds one million keys of about 25 characters, too long for the small
+// string buffer of std::string, as std::string and as InlineString<char, 32>,
+// and prints the time each takes. STL_UTIL_BENCHMARK counts the allocations.
+int INLINE_STRING_BENCHMARK(void) {
+    const int kKeys = 1000000;
+    size_t total = 0;
+    char digits[16];
+    auto heap = TimeMicroseconds([&]() {
+        for (int i = 0; i < kKeys; ++i) {
+            std::string key = "section.entry_";
+            key.append(digits, x::snprintf(digits, sizeof(digits), "%d", i));
+            key += ".path";
+            total += key.size();
+        }
+    });
+    auto inline_time = TimeMicroseconds([&]() {
+        for (int i = 0; i < kKeys; ++i) {
+            Key key = "section.entry_";
+            key.append(digits, x::snprintf(digits, sizeof(digits), "%d", i));
+            key += ".path";
+            total -= key.size();
+        }
+    });
+
+    std::cout << "Short keys: std::string " << heap << "us, InlineString " << inline_time << "us" << std::endl;
+    return total == 0 ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/number_conversions.h"
+
+#include <string.h>
+
+#include "utils/bits.h"
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+const char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+const char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+const uint64 kPowersOfTen[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// Returns the value of |c| as a digit of base 36, or 36 if it is not one.
+inline uint32 DigitValue(char c) {
+    const uint32 digit = static_cast<uint8>(c) - uint32('0');
+    if (digit < 10) return digit;
+    const uint32 letter = (static_cast<uint8>(c) | 0x20) - uint32('a');
+    return letter < 26 ? letter + 10 : 36;
+}
+
+// Returns the first digit after the base prefix of [p, last) and sets
+// |*base| when it is 0. A prefix only counts when a digit follows it, so
+// "0x" alone reads as 0.
+const char* SkipBasePrefix(const char* p, const char* last, int* base) {
+    if (last - p >= 2 && p[0] == '0') {
+        const char x = p[1] | 0x20;
+        if ((*base == 0 || *base == 16) && x == 'x' && last - p > 2 && DigitValue(p[2]) < 16) {
+            *base = 16;
+            return p + 2;
+        }
+        if ((*base == 0 || *base == 2) && x == 'b' && last - p > 2 && DigitValue(p[2]) < 2) {
+            *base = 2;
+            return p + 2;
+        }
+        // Like strtoll(), any digit after the "0" makes it octal, and parsing
+        // then stops at an 8 or a 9. The "0" is left to read as the first
+        // digit, so "08" gives 0 rather than no digits at all.
+        if (*base == 0 && DigitValue(p[1]) < 10) {
+            *base = 8;
+            return p;
+        }
+    }
+    if (*base == 0) *base = 10;
+    return p;
+}
+
+// Converts the 8 characters at |p| if all are digits. The first is the most
+// significant and sits in the lowest byte of the little-endian load. The
+// check adds 6 to each byte, which carries into the high nibble for
+// everything above '9'; the digits are then combined pairwise, into 4-digit
+// and into 8-digit values with three multiplies.
+inline bool ParseEightDigits(const char* p, uint32* value) {
+    uint64 chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) !=
+        0x3333333333333333ULL) {
+        return false;
+    }
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+    *value = static_cast<uint32>(chunk);
+    return true;
+}
+
+bool ParseSixteenDigits(const char* p, uint64* value) {
+    uint32 high, low;
+    if (!ParseEightDigits(p, &high) || !ParseEightDigits(p + 8, &low)) return false;
+    *value = high * 100000000ULL + low;
+    return true;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// Checks the 16 characters with one compare, then multiply-adds neighbouring
+// digits into 2-, 4- and 8-digit lanes.
+TARGET_ISA("ssse3") bool ParseSixteenDigitsSSSE3(const char* p, uint64* value) {
+    using namespace utils::simd;
+    const __m128i digits = _mm_sub_epi8(Load128(p), _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    if (MoveMask128(is_digit) != 0xFFFF) return false;
+    const __m128i pairs = _mm_maddubs_epi16(digits, _mm_set1_epi16(0x010A));
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));
+    const __m128i eights = _mm_madd_epi16(_mm_packs_epi32(quads, quads), _mm_set1_epi32(0x00012710));
+    const uint32 high = static_cast<uint32>(_mm_cvtsi128_si32(eights));
+    const uint32 low = static_cast<uint32>(_mm_cvtsi128_si32(_mm_srli_si128(eights, 4)));
+    *value = high * 100000000ULL + low;
+    return true;
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+struct NumberKernels {
+    bool (*parse_sixteen_digits)(const char*, uint64*) = &ParseSixteenDigits;
+
+    static const NumberKernels& Get() {
+        static const NumberKernels kernels = Select();
+        return kernels;
+    }
+
+    static NumberKernels Select() {
+        NumberKernels kernels;
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (utils::CPU::Get().has_ssse3()) kernels.parse_sixteen_digits = &ParseSixteenDigitsSSSE3;
+#endif
+        return kernels;
+    }
+};
+
+// Returns the number of decimal digits of |value|, from the bit length and a
+// compare against a power of ten. 1233 / 4096 is just above log10(2).
+inline int DecimalLength(uint64 value) {
+    const int guess = (utils::bits::Log2Floor(value | 1) + 1) * 1233 >> 12;
+    return guess + ((value | 1) >= kPowersOfTen[guess]);
+}
+
+// Writes |value| so that it ends just before |end|. Two digits are produced
+// per division.
+void FormatDecimal(uint64 value, char* end) {
+    while (value >= 100) {
+        const size_t pair = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = kDigitPairs[pair + 1];
+        *--end = kDigitPairs[pair];
+    }
+    if (value >= 10) {
+        *--end = kDigitPairs[value * 2 + 1];
+        *--end = kDigitPairs[value * 2];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+}
+
+template <typename Float>
+std::from_chars_result ParseFloat(const char* first, const char* last, Float* value) {
+    // std::from_chars() reads hexadecimal without the "0x", after the sign.
+    const char* p = first + (first != last && *first == '-');
+    if (last - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && (DigitValue(p[2]) < 16 || p[2] == '.')) {
+        Float magnitude;
+        std::from_chars_result result = std::from_chars(p + 2, last, magnitude, std::chars_format::hex);
+        if (result.ec == std::errc()) *value = p != first ? -magnitude : magnitude;
+        else if (result.ec == std::errc::invalid_argument) result.ptr = first;
+        return result;
+    }
+    return std::from_chars(first, last, *value);
+}
+
+}  // namespace
+
+std::from_chars_result utils::internal::ParseUnsigned(const char* first, const char* last, int base, uint64 max,
+                                                      uint64* value) {
+    if (base != 0 && (base < 2 || base > 36)) return std::from_chars_result{ first, std::errc::invalid_argument };
+    const char* p = SkipBasePrefix(first, last, &base);
+    if (p == last || DigitValue(*p) >= static_cast<uint32>(base))
+        return std::from_chars_result{ first, std::errc::invalid_argument };
+
+    // Up to 16 significant decimal digits are read a register at a time;
+    // they cannot overflow a uint64, only |max|.
+    uint64 result = 0;
+    if (base == 10) {
+        while (p != last && *p == '0') ++p;
+        uint32 eight;
+        if (last - p >= 16 && NumberKernels::Get().parse_sixteen_digits(p, &result)) {
+            p += 16;
+        } else if (last - p >= 8 && ParseEightDigits(p, &eight)) {
+            result = eight;
+            p += 8;
+        }
+    }
+    bool overflow = result > max;
+    const uint64 cutoff = max / base;
+    const uint32 cutoff_digit = static_cast<uint32>(max % base);
+    for (; p != last; ++p) {
+        const uint32 digit = DigitValue(*p);
+        if (digit >= static_cast<uint32>(base)) break;
+        if (result > cutoff || (result == cutoff && digit > cutoff_digit)) overflow = true;
+        else result = result * base + digit;
+    }
+    if (overflow) return std::from_chars_result{ p, std::errc::result_out_of_range };
+    *value = result;
+    return std::from_chars_result{ p, std::errc() };
+}
+
+std::to_chars_result utils::internal::FormatUnsigned(char* first, char* last, uint64 value, int base) {
+    if (base < 2 || base > 36) return std::to_chars_result{ last, std::errc::invalid_argument };
+    if (base == 10) {
+        const int length = DecimalLength(value);
+        if (last - first < length) return std::to_chars_result{ last, std::errc::value_too_large };
+        FormatDecimal(value, first + length);
+        return std::to_chars_result{ first + length, std::errc() };
+    }
+    if (utils::bits::IsPowerOfTwo(static_cast<uint32>(base))) {
+        const int shift = utils::bits::Log2Floor(static_cast<uint32>(base));
+        const int length = utils::bits::Log2Floor(value | 1) / shift + 1;
+        if (last - first < length) return std::to_chars_result{ last, std::errc::value_too_large };
+        for (char* p = first + length; p != first; value >>= shift) *--p = kDigits[value & (base - 1)];
+        return std::to_chars_result{ first + length, std::errc() };
+    }
+    char buffer[64];
+    char* const end = buffer + sizeof(buffer);
+    char* begin = end;
+    do {
+        *--begin = kDigits[value % base];
+        value /= base;
+    } while (value);
+    if (last - first < end - begin) return std::to_chars_result{ last, std::errc::value_too_large };
+    memcpy(first, begin, end - begin);
+    return std::to_chars_result{ first + (end - begin), std::errc() };
+}
+
+std::from_chars_result utils::ParseNumber(const char* first, const char* last, double* value) {
+    return ParseFloat(first, last, value);
+}
+
+std::from_chars_result utils::ParseNumber(const char* first, const char* last, float* value) {
+    return ParseFloat(first, last, value);
+}
+
+std::to_chars_result utils::FormatNumber(char* first, char* last, double value) {
+    return std::to_chars(first, last, value);
+}
+
+std::to_chars_result utils::FormatNumber(char* first, char* last, float value) {
+    return std::to_chars(first, last, value);
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_NUMBER_CONVERSIONS_INCLUDE_H_
+#define UTILS_STRINGS_NUMBER_CONVERSIONS_INCLUDE_H_
+
+#include <charconv>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Conversions between numbers and text that never throw, allocate or look at
+// the locale, unlike std::stoll() or snprintf(). They follow std::from_chars
+// and std::to_chars: the pointer forms report the end of what they read or
+// wrote and a std::errc, and only the std::string helpers allocate.
+//
+// Integers of every width parse in any base from 2 to 36. Base 0 takes the
+// base from a C++ literal prefix: "0x" hexadecimal, "0b" binary, a leading
+// "0" octal, and decimal otherwise; bases 16 and 2 also skip their prefix.
+// A leading '-' is only read for signed types, and no '+' or whitespace is.
+// Runs of 8 and 16 decimal digits are converted a register at a time.
+//
+// Doubles and floats read decimal or scientific notation, "inf" and "nan",
+// and hexadecimal after "0x". They print the shortest text that reads back
+// as the same value.
+// Example:
+//   int64 offset;
+//   if (!utils::StringToNumber(header, &offset, 0)) return false;
+//   char buffer[utils::kMaxNumberLength];
+//   const char* end = utils::FormatNumber(buffer, std::end(buffer), offset).ptr;
+namespace utils {
+
+// Room for any number FormatNumber() writes: 64 binary digits and a sign, or
+// the longest shortest double, "-2.2250738585072014e-308".
+const size_t kMaxNumberLength = 66;
+
+namespace internal {
+
+template <typename T>
+using EnableIfInteger =
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type;
+
+// Parses the digits of an unsigned integer no larger than |max| in |base|,
+// after the base prefix if any. On overflow the digits are still consumed.
+UTILS_API std::from_chars_result ParseUnsigned(const char* first, const char* last, int base, uint64 max,
+                                               uint64* value);
+
+UTILS_API std::to_chars_result FormatUnsigned(char* first, char* last, uint64 value, int base);
+
+} // namespace internal
+
+// Reads the longest number at the start of [first, last) into |*value|. On
+// error |*value| is left alone and the result holds
+// std::errc::invalid_argument, with |ptr| at |first|, when there is no
+// number, or std::errc::result_out_of_range, with |ptr| past it, when it
+// does not fit in |T|.
+template <typename T, internal::EnableIfInteger<T> = 0>
+std::from_chars_result ParseNumber(const char* first, const char* last, T* value, int base = 10) {
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    const bool negative = std::is_signed<T>::value && first != last && *first == '-';
+    const uint64 max = static_cast<uint64>(std::numeric_limits<T>::max()) + negative;
+    uint64 magnitude = 0;
+    std::from_chars_result result = internal::ParseUnsigned(first + negative, last, base, max, &magnitude);
+    if (result.ec == std::errc::invalid_argument) result.ptr = first;
+    if (result.ec == std::errc())
+        *value = static_cast<T>(negative ? static_cast<Unsigned>(0 - magnitude) : static_cast<Unsigned>(magnitude));
+    return result;
+}
+
+UTILS_API std::from_chars_result ParseNumber(const char* first, const char* last, double* value);
+UTILS_API std::from_chars_result ParseNumber(const char* first, const char* last, float* value);
+
+// Writes |value| to [first, last) without a terminating null. Digits above 9
+// are lowercase letters. If it does not fit the result holds
+// std::errc::value_too_large, with |ptr| at |last|.
+template <typename T, internal::EnableIfInteger<T> = 0>
+std::to_chars_result FormatNumber(char* first, char* last, T value, int base = 10) {
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    Unsigned magnitude = static_cast<Unsigned>(value);
+    if constexpr (std::is_signed<T>::value) {
+        if (value < 0) {
+            if (first == last) return std::to_chars_result{ last, std::errc::value_too_large };
+            *first++ = '-';
+            magnitude = static_cast<Unsigned>(0 - magnitude);
+        }
+    }
+    return internal::FormatUnsigned(first, last, magnitude, base);
+}
+
+UTILS_API std::to_chars_result FormatNumber(char* first, char* last, double value);
+UTILS_API std::to_chars_result FormatNumber(char* first, char* last, float value);
+
+// Returns true if all of |text| is a number that fits in |T|.
+template <typename T, internal::EnableIfInteger<T> = 0>
+bool StringToNumber(std::string_view text, T* value, int base = 10) {
+    const char* const last = text.data() + text.size();
+    const std::from_chars_result result = ParseNumber(text.data(), last, value, base);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline bool StringToNumber(std::string_view text, double* value) {
+    const char* const last = text.data() + text.size();
+    const std::from_chars_result result = ParseNumber(text.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline bool StringToNumber(std::string_view text, float* value) {
+    const char* const last = text.data() + text.size();
+    const std::from_chars_result result = ParseNumber(text.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+template <typename T, internal::EnableIfInteger<T> = 0>
+std::string NumberToString(T value, int base = 10) {
+    char buffer[kMaxNumberLength];
+    return std::string(buffer, FormatNumber(buffer, buffer + sizeof(buffer), value, base).ptr);
+}
+
+inline std::string NumberToString(double value) {
+    char buffer[kMaxNumberLength];
+    return std::string(buffer, FormatNumber(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_NUMBER_CONVERSIONS_INCLUDE_H_
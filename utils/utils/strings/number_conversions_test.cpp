@@ -0,0 +1,204 @@
+#include <Windows.h>
+#include "utils/strings/number_conversions.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// Parses |text| whole and checks the value and where it stopped.
+template <typename T>
+void CheckParse(const char* text, int base, std::errc ec, size_t consumed, T expected = T()) {
+    T value = T(7);
+    const std::from_chars_result result = utils::ParseNumber(text, text + strlen(text), &value, base);
+    if (result.ec != ec || result.ptr != text + consumed) __debugbreak();
+    if (value != (ec == std::errc() ? expected : T(7))) __debugbreak();
+}
+
+// Formats |value| in every base and reads it back, against std::to_chars().
+template <typename T>
+void CheckRoundTrip(T value) {
+    char buffer[utils::kMaxNumberLength], expected[utils::kMaxNumberLength];
+    for (int base = 2; base <= 36; ++base) {
+        const std::to_chars_result result = utils::FormatNumber(buffer, buffer + sizeof(buffer), value, base);
+        const std::to_chars_result reference = std::to_chars(expected, expected + sizeof(expected), value, base);
+        if (result.ec != std::errc() || std::string(buffer, result.ptr) != std::string(expected, reference.ptr))
+            __debugbreak();
+        T parsed = T();
+        if (!utils::StringToNumber(std::string_view(buffer, result.ptr - buffer), &parsed, base) || parsed != value)
+            __debugbreak();
+        // One character short does not fit.
+        if (utils::FormatNumber(buffer, result.ptr - 1, value, base).ec != std::errc::value_too_large) __debugbreak();
+    }
+}
+
+template <typename T>
+void CheckWidth(std::mt19937_64& random) {
+    CheckRoundTrip<T>(0);
+    CheckRoundTrip<T>(std::numeric_limits<T>::min());
+    CheckRoundTrip<T>(std::numeric_limits<T>::max());
+    for (int i = 0; i < 300; ++i) CheckRoundTrip<T>(static_cast<T>(random() >> (random() % 64)));
+
+    // One past either end is out of range, with every digit consumed.
+    char text[utils::kMaxNumberLength + 1];
+    for (uint64 bound : { static_cast<uint64>(std::numeric_limits<T>::max()), 0 - static_cast<uint64>(std::numeric_limits<T>::min()) }) {
+        if (bound == 0 || bound == std::numeric_limits<uint64>::max()) continue;
+        size_t length = 0;
+        if (bound != static_cast<uint64>(std::numeric_limits<T>::max())) text[length++] = '-';
+        length = utils::FormatNumber(text + length, text + sizeof(text), bound + 1).ptr - text;
+        text[length] = 0;
+        CheckParse<T>(text, 10, std::errc::result_out_of_range, length);
+    }
+}
+
+}  // namespace
+
+int NUMBER_CONVERSIONS_TEST(void) {
+    std::mt19937_64 random(20);
+    CheckWidth<int8>(random);
+    CheckWidth<uint8>(random);
+    CheckWidth<int16>(random);
+    CheckWidth<uint16>(random);
+    CheckWidth<int32>(random);
+    CheckWidth<uint32>(random);
+    CheckWidth<int64>(random);
+    CheckWidth<uint64>(random);
+    CheckParse<uint64>("18446744073709551616", 10, std::errc::result_out_of_range, 20);
+    CheckParse<uint64>("99999999999999999999999", 10, std::errc::result_out_of_range, 23);
+    CheckParse<int64>("-9223372036854775808", 10, std::errc(), 20, std::numeric_limits<int64>::min());
+
+    // Prefixes, signs and where parsing stops.
+    CheckParse<int>("0x1F", 0, std::errc(), 4, 31);
+    CheckParse<int>("-0X1f", 0, std::errc(), 5, -31);
+    CheckParse<int>("0x1F", 16, std::errc(), 4, 31);
+    CheckParse<int>("1F", 16, std::errc(), 2, 31);
+    CheckParse<int>("0x1F", 10, std::errc(), 1, 0);
+    CheckParse<int>("0b101", 0, std::errc(), 5, 5);
+    CheckParse<int>("0b101", 2, std::errc(), 5, 5);
+    CheckParse<int>("0b1", 16, std::errc(), 3, 0xb1);
+    CheckParse<int>("017", 0, std::errc(), 3, 15);
+    CheckParse<int>("019", 0, std::errc(), 2, 1);
+    CheckParse<int>("08", 0, std::errc(), 1, 0);
+    CheckParse<int>("-09", 0, std::errc(), 2, 0);
+    CheckParse<int>("0", 0, std::errc(), 1, 0);
+    CheckParse<int>("0x", 0, std::errc(), 1, 0);
+    CheckParse<int>("0xg", 16, std::errc(), 1, 0);
+    CheckParse<int>("zz", 36, std::errc(), 2, 35 * 36 + 35);
+    CheckParse<int>("12abc", 10, std::errc(), 2, 12);
+    CheckParse<unsigned>("-1", 10, std::errc::invalid_argument, 0);
+    CheckParse<int>("", 10, std::errc::invalid_argument, 0);
+    CheckParse<int>("-", 10, std::errc::invalid_argument, 0);
+    CheckParse<int>("+1", 10, std::errc::invalid_argument, 0);
+    CheckParse<int>(" 1", 10, std::errc::invalid_argument, 0);
+    CheckParse<int>("1", 37, std::errc::invalid_argument, 0);
+    CheckParse<uint8>("0000000000000000000000255", 10, std::errc(), 25, 255);
+
+    // Runs of digits of every length at every offset, so both the 8- and
+    // 16-digit paths meet a non-digit in each lane.
+    const char kStops[] = { '/', ':', 'a', '.', '\0', '\x80' };
+    for (size_t length = 1; length <= 20; ++length) {
+        for (char stop : kStops) {
+            for (int i = 0; i < 20; ++i) {
+                std::string text(length, '0');
+                for (char& c : text) c = static_cast<char>('0' + random() % 10);
+                text += stop;
+                text += "12345678901234567";
+                uint64 value = 0, expected = 0;
+                const std::from_chars_result result = utils::ParseNumber(text.data(), text.data() + text.size(), &value);
+                const std::from_chars_result reference = std::from_chars(text.data(), text.data() + text.size(), expected);
+                if (result.ec != reference.ec || result.ptr != reference.ptr || value != expected) __debugbreak();
+            }
+        }
+    }
+
+    // Doubles print the shortest text that reads back the same.
+    char buffer[utils::kMaxNumberLength];
+    for (int i = 0; i < 100000; ++i) {
+        const uint64 bits = random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value) continue;
+        const std::to_chars_result result = utils::FormatNumber(buffer, buffer + sizeof(buffer), value);
+        double parsed = 0;
+        if (result.ec != std::errc() || !utils::StringToNumber(std::string_view(buffer, result.ptr - buffer), &parsed) ||
+            memcmp(&parsed, &value, sizeof(value)) != 0) __debugbreak();
+    }
+    if (utils::NumberToString(0.1) != "0.1" || utils::NumberToString(-2.5e-300) != "-2.5e-300" ||
+        utils::NumberToString(1e21) != "1e+21") __debugbreak();
+    double value = 0;
+    float single = 0;
+    if (!utils::StringToNumber("0x1.8p1", &value) || value != 3.0) __debugbreak();
+    if (!utils::StringToNumber("-0x10", &value) || value != -16.0) __debugbreak();
+    if (!utils::StringToNumber("-inf", &value) || value != -std::numeric_limits<double>::infinity()) __debugbreak();
+    if (!utils::StringToNumber("1.5e3", &single) || single != 1500.0f) __debugbreak();
+    if (utils::StringToNumber("1e999", &value) || utils::StringToNumber("1.5x", &value) || utils::StringToNumber("", &value))
+        __debugbreak();
+    if (utils::NumberToString(-255, 16) != "-ff" || utils::NumberToString(uint64(0)) != "0") __debugbreak();
+    return 0;
+}
+
+// Parses and formats 2M random 64-bit integers, short and long, and 2M
+// doubles with std::stoll()/strtod()/snprintf() and with ParseNumber()/
+// FormatNumber(), and prints the time each takes.
+int NUMBER_CONVERSIONS_BENCHMARK(void) {
+    const size_t kCount = 2000000;
+    std::mt19937_64 random(7);
+    std::vector<int64> integers(kCount);
+    for (int64& value : integers) value = static_cast<int64>(random()) >> (random() % 64);
+    std::vector<double> doubles(kCount);
+    for (double& value : doubles) value = static_cast<double>(static_cast<int64>(random())) / (1 + random() % 1000000);
+
+    std::vector<std::string> integer_text, double_text;
+    char buffer[utils::kMaxNumberLength];
+    for (int64 value : integers) integer_text.push_back(utils::NumberToString(value));
+    for (double value : doubles) double_text.push_back(utils::NumberToString(value));
+
+    uint64 std_sum = 0, utils_sum = 0;
+    double std_total = 0, utils_total = 0;
+    auto stoll = TimeMicroseconds([&]() {
+        for (const std::string& text : integer_text) std_sum += std::stoll(text);
+    });
+    auto parse = TimeMicroseconds([&]() {
+        for (const std::string& text : integer_text) {
+            int64 value = 0;
+            utils::ParseNumber(text.data(), text.data() + text.size(), &value);
+            utils_sum += value;
+        }
+    });
+    auto snprintf_integer = TimeMicroseconds([&]() {
+        for (int64 value : integers) std_sum += x::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+    });
+    auto format_integer = TimeMicroseconds([&]() {
+        for (int64 value : integers) utils_sum += utils::FormatNumber(buffer, buffer + sizeof(buffer), value).ptr - buffer;
+    });
+    auto strtod = TimeMicroseconds([&]() {
+        for (const std::string& text : double_text) std_total += ::strtod(text.c_str(), nullptr);
+    });
+    auto parse_double = TimeMicroseconds([&]() {
+        for (const std::string& text : double_text) {
+            double value = 0;
+            utils::ParseNumber(text.data(), text.data() + text.size(), &value);
+            utils_total += value;
+        }
+    });
+    auto snprintf_double = TimeMicroseconds([&]() {
+        for (double value : doubles) std_sum += x::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    });
+    auto format_double = TimeMicroseconds([&]() {
+        for (double value : doubles) utils_sum += utils::FormatNumber(buffer, buffer + sizeof(buffer), value).ptr - buffer;
+    });
+
+    std::cout << "Parse int64: std::stoll " << stoll << "us, ParseNumber " << parse << "us" << std::endl;
+    std::cout << "Format int64: snprintf " << snprintf_integer << "us, FormatNumber " << format_integer << "us" << std::endl;
+    std::cout << "Parse double: strtod " << strtod << "us, ParseNumber " << parse_double << "us" << std::endl;
+    std::cout << "Format double: snprintf(%.17g) " << snprintf_double << "us, FormatNumber " << format_double << "us"
+              << std::endl;
+    return std_total == utils_total ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_PLACEHOLDER_TEMPLATE_INCLUDE_H_
+#define UTILS_STRINGS_PLACEHOLDER_TEMPLATE_INCLUDE_H_
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/basictypes.h"
+
+// Pre-parsed formats for x::ReplaceStringPlaceholders(). The format is split
+// once into literal runs and $N placeholders, at compile time for string
+// literals or once at startup for formats read from configuration. A
+// replacement then sizes the result exactly, allocates it once and copies each
+// run into place. The output, including |offsets|, is the same as
+// x::ReplaceStringPlaceholders() gives for the same format.
+namespace utils {
+namespace internal {
+
+struct PlaceholderSegment {
+    bool is_parameter = false;
+    // The literal run [offset, offset + length) of the format string.
+    size_t offset = 0;
+    size_t length = 0;
+    // Zero-based substitution index; $0 and a '$' without digits wrap around
+    // to an index that never has a substitution.
+    size_t parameter = 0;
+};
+
+constexpr void AppendLiteral(PlaceholderSegment* segments, size_t* count, size_t offset, size_t length) {
+    if (*count && !segments[*count - 1].is_parameter &&
+        segments[*count - 1].offset + segments[*count - 1].length == offset) {
+        segments[*count - 1].length += length;
+        return;
+    }
+    segments[*count].offset = offset;
+    segments[*count].length = length;
+    ++*count;
+}
+
+// Splits |format| into |segments|, which must have room for |length| entries,
+// and returns the number used. Every literal the old parser emitted is a run
+// of the format itself: "$$$" yields the last two '$'.
+template <typename Char>
+constexpr size_t ParsePlaceholders(const Char* format, size_t length, PlaceholderSegment* segments) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (format[i] != '$') {
+            AppendLiteral(segments, &count, i, 1);
+            continue;
+        }
+        if (i + 1 == length) break;
+        ++i;
+        if (format[i] == '$') {
+            size_t run = i;
+            while (run < length && format[run] == '$') ++run;
+            AppendLiteral(segments, &count, i, run - i);
+            i = run - 1;
+        } else {
+            size_t index = 0;
+            while (i < length && '0' <= format[i] && format[i] <= '9') {
+                index = index * 10 + (format[i] - '0');
+                ++i;
+            }
+            --i;
+            segments[count].is_parameter = true;
+            segments[count].parameter = index - 1;
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Fills |ranks| with the position each placeholder's offset takes in the
+// |offsets| output: sorted by parameter, and for the same parameter later
+// placeholders first, as the lower_bound insertion in
+// DoReplaceStringPlaceholders() orders them. Returns the placeholder count.
+constexpr size_t RankPlaceholders(const PlaceholderSegment* segments, size_t count, size_t* ranks) {
+    size_t placeholders = 0;
+    for (size_t s = 0; s < count; ++s) {
+        if (!segments[s].is_parameter) continue;
+        size_t rank = 0;
+        for (size_t t = 0; t < count; ++t) {
+            if (!segments[t].is_parameter) continue;
+            if (segments[t].parameter < segments[s].parameter ||
+                (segments[t].parameter == segments[s].parameter && t > s)) ++rank;
+        }
+        ranks[placeholders++] = rank;
+    }
+    return placeholders;
+}
+
+template <typename STR, typename Subst>
+STR SubstitutePlaceholders(const typename STR::value_type* format, const PlaceholderSegment* segments, size_t count,
+                           const size_t* ranks, size_t placeholders, const Subst* subst, size_t subst_count,
+                           std::vector<size_t>* offsets) {
+    size_t length = 0;
+    for (size_t s = 0; s < count; ++s) {
+        const PlaceholderSegment& segment = segments[s];
+        if (!segment.is_parameter) length += segment.length;
+        else if (segment.parameter < subst_count) length += subst[segment.parameter].size();
+    }
+
+    STR result;
+    result.resize(length);
+    typename STR::value_type* const begin = length ? &result[0] : nullptr;
+    typename STR::value_type* out = begin;
+    const size_t base = offsets ? offsets->size() : 0;
+    if (offsets) offsets->resize(base + placeholders);
+
+    size_t placeholder = 0;
+    for (size_t s = 0; s < count; ++s) {
+        const PlaceholderSegment& segment = segments[s];
+        if (!segment.is_parameter) {
+            out = std::copy(format + segment.offset, format + segment.offset + segment.length, out);
+            continue;
+        }
+        if (offsets) (*offsets)[base + ranks[placeholder]] = out - begin;
+        ++placeholder;
+        if (segment.parameter < subst_count) {
+            const Subst& value = subst[segment.parameter];
+            out = std::copy(value.data(), value.data() + value.size(), out);
+        }
+    }
+    return result;
+}
+
+} // namespace internal
+
+// A format parsed at compile time. Create it with MakePlaceholderTemplate().
+// Example:
+//   constexpr auto kUnread = utils::MakePlaceholderTemplate("$1 has $2 unread messages");
+//   std::string text = kUnread.Replace({ user, count });
+template <typename Char, size_t N>
+class StaticPlaceholderTemplate {
+public:
+    typedef std::basic_string<Char> String;
+    typedef std::basic_string_view<Char> StringView;
+
+    constexpr explicit StaticPlaceholderTemplate(const Char (&format)[N]) : format_(format) {
+        count_ = internal::ParsePlaceholders(format, N - 1, segments_);
+        placeholders_ = internal::RankPlaceholders(segments_, count_, ranks_);
+    }
+
+    constexpr size_t segment_count() const { return count_; }
+    constexpr size_t placeholder_count() const { return placeholders_; }
+
+    // Same contract as x::ReplaceStringPlaceholders(); |offsets| may be NULL.
+    String Replace(std::initializer_list<StringView> subst, std::vector<size_t>* offsets = nullptr) const {
+        return internal::SubstitutePlaceholders<String>(format_, segments_, count_, ranks_, placeholders_,
+                                                        subst.begin(), subst.size(), offsets);
+    }
+    String Replace(const std::vector<String>& subst, std::vector<size_t>* offsets = nullptr) const {
+        return internal::SubstitutePlaceholders<String>(format_, segments_, count_, ranks_, placeholders_,
+                                                        subst.data(), subst.size(), offsets);
+    }
+
+private:
+    const Char* format_;
+    internal::PlaceholderSegment segments_[N] = {};
+    size_t ranks_[N] = {};
+    size_t count_ = 0;
+    size_t placeholders_ = 0;
+};
+
+template <typename Char, size_t N>
+constexpr StaticPlaceholderTemplate<Char, N> MakePlaceholderTemplate(const Char (&format)[N]) {
+    return StaticPlaceholderTemplate<Char, N>(format);
+}
+
+// A format parsed once at runtime, for formats that are only known after
+// startup, e.g. loaded from a configuration file. The template keeps its own
+// copy of the format.
+template <typename STR>
+class PlaceholderTemplate {
+public:
+    typedef typename STR::value_type Char;
+    typedef std::basic_string_view<Char> StringView;
+
+    explicit PlaceholderTemplate(const STR& format) : format_(format), segments_(format.size()) {
+        segments_.resize(internal::ParsePlaceholders(format_.data(), format_.size(), segments_.data()));
+        ranks_.resize(segments_.size());
+        ranks_.resize(internal::RankPlaceholders(segments_.data(), segments_.size(), ranks_.data()));
+    }
+
+    const STR& format() const { return format_; }
+    size_t placeholder_count() const { return ranks_.size(); }
+
+    // Same contract as x::ReplaceStringPlaceholders(); |offsets| may be NULL.
+    STR Replace(std::initializer_list<StringView> subst, std::vector<size_t>* offsets = nullptr) const {
+        return internal::SubstitutePlaceholders<STR>(format_.data(), segments_.data(), segments_.size(), ranks_.data(),
+                                                     ranks_.size(), subst.begin(), subst.size(), offsets);
+    }
+    STR Replace(const std::vector<STR>& subst, std::vector<size_t>* offsets = nullptr) const {
+        return internal::SubstitutePlaceholders<STR>(format_.data(), segments_.data(), segments_.size(), ranks_.data(),
+                                                     ranks_.size(), subst.data(), subst.size(), offsets);
+    }
+
+private:
+    STR format_;
+    std::vector<internal::PlaceholderSegment> segments_;
+    std::vector<size_t> ranks_;
+};
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_PLACEHOLDER_TEMPLATE_INCLUDE_H_
@@ -0,0 +1,66 @@
+#include <Windows.h>
+#include "utils/strings/placeholder_template.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+namespace {
+
+constexpr auto kGreeting = utils::MakePlaceholderTemplate("Hello $1, you have $2 new $$messages$");
+static_assert(kGreeting.placeholder_count() == 2, "two placeholders");
+static_assert(kGreeting.segment_count() == 6, "the escaped '$' starts a new literal run");
+
+}  // namespace
+
+int PLACEHOLDER_TEMPLATE_TEST(void) {
+    const std::vector<std::string> subst = { "alice", "3", "unused" };
+    const std::string formats[] = {
+        "", "$", "$$", "$$$1", "plain", "$1$2$1", "$2 before $1", "$0 and $ and $x", "$10 $9 $3", "trailing $",
+        "$$$$ and $1$$2",
+    };
+    for (const std::string& format : formats) {
+        std::vector<size_t> expected_offsets, offsets;
+        const std::string expected = x::ReplaceStringPlaceholders(format, subst, &expected_offsets);
+        const utils::PlaceholderTemplate<std::string> compiled(format);
+        if (compiled.Replace(subst, &offsets) != expected || offsets != expected_offsets) __debugbreak();
+        if (compiled.Replace({ "alice", "3", "unused" }) != expected) __debugbreak();
+    }
+
+    std::vector<size_t> offsets;
+    if (kGreeting.Replace({ "alice", "3" }, &offsets) != "Hello alice, you have 3 new $messages") __debugbreak();
+    if (offsets.size() != 2 || offsets[0] != 6 || offsets[1] != 22) __debugbreak();
+
+    const utils::PlaceholderTemplate<std::wstring> wide(L"$1: $2");
+    if (wide.Replace({ L"key", L"value" }) != L"key: value") __debugbreak();
+    return 0;
+}
+
+// Formats the same message with x::ReplaceStringPlaceholders(), which parses
+// the format each time, and with a pre-parsed template.
+int PLACEHOLDER_TEMPLATE_BENCHMARK(void) {
+    const int kRounds = 1000000;
+    const std::string format = "User $1 logged in from $2 at $3 using $4";
+    const std::vector<std::string> subst = { "alice@example.com", "192.168.100.200", "2018-06-01 12:00:00", "Chrome" };
+    const utils::PlaceholderTemplate<std::string> compiled(format);
+    constexpr auto kStatic = utils::MakePlaceholderTemplate("User $1 logged in from $2 at $3 using $4");
+
+    size_t length = 0;
+    auto parsed = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) length += x::ReplaceStringPlaceholders(format, subst, nullptr).size();
+    });
+    auto runtime = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) length += compiled.Replace(subst).size();
+    });
+    auto static_time = TimeMicroseconds([&]() {
+        for (int i = 0; i < kRounds; ++i) length += kStatic.Replace(subst).size();
+    });
+
+    std::cout << "ReplaceStringPlaceholders " << parsed << "us, PlaceholderTemplate " << runtime
+              << "us, MakePlaceholderTemplate " << static_time << "us" << std::endl;
+    return length ? 0 : 1;
+}
+
+#endif // TEST
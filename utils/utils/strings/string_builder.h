@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_STRING_BUILDER_INCLUDE_H_
+#define UTILS_STRINGS_STRING_BUILDER_INCLUDE_H_
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/basictypes.h"
+
+namespace utils {
+namespace internal {
+
+// Returns the length of the parts in [begin, end) joined with |separator|.
+// Each part may be anything a string view can be made from: a string, a view,
+// a literal or a null-terminated pointer.
+template <typename Char, typename Iter>
+size_t JoinedLength(Iter begin, Iter end, std::basic_string_view<Char> separator) {
+    size_t length = 0, count = 0;
+    for (; begin != end; ++begin, ++count) length += std::basic_string_view<Char>(*begin).size();
+    return count ? length + separator.size() * (count - 1) : 0;
+}
+
+// Appends the parts in [begin, end) joined with |separator| to |output|,
+// growing it once and copying each part exactly once. The range is walked
+// twice, so it needs forward iterators. |STR| is any string type with
+// reserve() and append(data, size).
+template <typename STR, typename Iter>
+void AppendJoined(STR* output, Iter begin, Iter end, std::basic_string_view<typename STR::value_type> separator) {
+    typedef std::basic_string_view<typename STR::value_type> StringView;
+    if (begin == end) return;
+    output->reserve(output->size() + JoinedLength(begin, end, separator));
+    const StringView first(*begin);
+    output->append(first.data(), first.size());
+    for (++begin; begin != end; ++begin) {
+        const StringView part(*begin);
+        output->append(separator.data(), separator.size());
+        output->append(part.data(), part.size());
+    }
+}
+
+} // namespace internal
+
+// Collects views of the pieces of a string and copies them once, into a
+// result allocated at its final length, when the string is built. Nothing is
+// copied while appending, so every piece must outlive the last call to Build()
+// or AppendTo(), and none may view the string AppendTo() writes to.
+// Example:
+//   utils::StringBuilder builder;
+//   builder.Append(scheme).Append("://").Append(host);
+//   builder.AppendJoined(segments.begin(), segments.end(), "/");
+//   std::string url = builder.Build();
+template <typename Char>
+class BasicStringBuilder {
+public:
+    typedef std::basic_string<Char> String;
+    typedef std::basic_string_view<Char> StringView;
+
+    BasicStringBuilder() {}
+    // |pieces| is how many pieces to make room for up front.
+    explicit BasicStringBuilder(size_t pieces) { pieces_.reserve(pieces); }
+
+    BasicStringBuilder& Append(StringView piece) {
+        if (piece.empty()) return *this;
+        pieces_.push_back(piece);
+        length_ += piece.size();
+        return *this;
+    }
+
+    // Appends the parts in [begin, end) with |separator| between them. A part
+    // is anything a StringView can be made from.
+    template <typename Iter>
+    BasicStringBuilder& AppendJoined(Iter begin, Iter end, StringView separator) {
+        for (bool first = true; begin != end; ++begin, first = false) {
+            if (!first) Append(separator);
+            Append(StringView(*begin));
+        }
+        return *this;
+    }
+
+    size_t length() const { return length_; }
+    bool empty() const { return length_ == 0; }
+
+    String Build() const {
+        String result;
+        AppendTo(&result);
+        return result;
+    }
+
+    void AppendTo(String* output) const {
+        output->reserve(output->size() + length_);
+        for (StringView piece : pieces_) output->append(piece.data(), piece.size());
+    }
+
+    void clear() {
+        pieces_.clear();
+        length_ = 0;
+    }
+
+private:
+    std::vector<StringView> pieces_;
+    size_t length_ = 0;
+};
+
+typedef BasicStringBuilder<char> StringBuilder;
+typedef BasicStringBuilder<char16> WStringBuilder;
+
+// A string kept as a sequence of chunks that is never flattened unless asked
+// to, for joins too large to copy into one buffer. WriteTo() hands the chunks
+// in order to a writer, so the text goes to a file or socket straight from
+// where it lives.
+//
+// Text is either copied into blocks the rope owns (Append(), AppendJoined()),
+// adopted without a copy (Append(String&&)) or referenced (AppendExternal()),
+// in which case it must outlive the rope. Short copies are packed into
+// |kBlockSize| character blocks that never move, and consecutive ones share a
+// chunk, so a writer sees a few large chunks rather than one per part.
+// Example:
+//   utils::Rope rope;
+//   rope.AppendJoined(rows.begin(), rows.end(), "\n");
+//   rope.WriteTo([&](const char* data, size_t size) {
+//       return fwrite(data, 1, size, file) == size;
+//   });
+template <typename Char>
+class BasicRope {
+public:
+    typedef std::basic_string<Char> String;
+    typedef std::basic_string_view<Char> StringView;
+
+    static const size_t kBlockSize = 4096;
+
+    BasicRope() {}
+    // A moved-from rope is empty.
+    BasicRope(BasicRope&& other) { swap(other); }
+    BasicRope& operator=(BasicRope&& other) {
+        BasicRope(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(BasicRope& other) {
+        chunks_.swap(other.chunks_);
+        std::swap(length_, other.length_);
+        blocks_.swap(other.blocks_);
+        std::swap(block_end_, other.block_end_);
+        std::swap(block_free_, other.block_free_);
+        std::swap(last_copied_, other.last_copied_);
+        strings_.swap(other.strings_);
+    }
+
+    // Copies |text| into the rope.
+    BasicRope& Append(StringView text) {
+        if (text.empty()) return *this;
+        if (text.size() > kBlockSize / 4) {
+            // Big enough to be a chunk of its own.
+            std::unique_ptr<Char[]> block(new Char[text.size()]);
+            std::copy_n(text.data(), text.size(), block.get());
+            AddChunk(StringView(block.get(), text.size()));
+            blocks_.push_back(std::move(block));
+            return *this;
+        }
+        if (text.size() > block_free_) {
+            blocks_.emplace_back(new Char[kBlockSize]);
+            block_end_ = blocks_.back().get();
+            block_free_ = kBlockSize;
+        }
+        std::copy_n(text.data(), text.size(), block_end_);
+        if (last_copied_ && chunks_.back().data() + chunks_.back().size() == block_end_) {
+            chunks_.back() = StringView(chunks_.back().data(), chunks_.back().size() + text.size());
+            length_ += text.size();
+        } else {
+            AddChunk(StringView(block_end_, text.size()));
+        }
+        last_copied_ = true;
+        block_end_ += text.size();
+        block_free_ -= text.size();
+        return *this;
+    }
+
+    BasicRope& Append(const Char* text) { return Append(StringView(text)); }
+
+    // Takes |text| over without copying its characters.
+    BasicRope& Append(String&& text) {
+        if (text.empty()) return *this;
+        strings_.push_back(std::move(text));
+        AddChunk(strings_.back());
+        return *this;
+    }
+
+    // References |text|, which must outlive the rope.
+    BasicRope& AppendExternal(StringView text) {
+        if (!text.empty()) AddChunk(text);
+        return *this;
+    }
+
+    // Copies the parts in [begin, end) with |separator| between them. A part
+    // is anything a StringView can be made from.
+    template <typename Iter>
+    BasicRope& AppendJoined(Iter begin, Iter end, StringView separator) {
+        for (bool first = true; begin != end; ++begin, first = false) {
+            if (!first) Append(separator);
+            Append(StringView(*begin));
+        }
+        return *this;
+    }
+
+    size_t length() const { return length_; }
+    bool empty() const { return length_ == 0; }
+    const std::vector<StringView>& chunks() const { return chunks_; }
+
+    // Calls |writer|(const Char* data, size_t size) for each chunk in order,
+    // stopping at the first call that returns false. Returns whether every
+    // chunk was written.
+    template <typename Writer>
+    bool WriteTo(Writer&& writer) const {
+        for (StringView chunk : chunks_) {
+            if (!writer(chunk.data(), chunk.size())) return false;
+        }
+        return true;
+    }
+
+    String Flatten() const {
+        String result;
+        result.reserve(length_);
+        for (StringView chunk : chunks_) result.append(chunk.data(), chunk.size());
+        return result;
+    }
+
+private:
+    void AddChunk(StringView chunk) {
+        chunks_.push_back(chunk);
+        length_ += chunk.size();
+        last_copied_ = false;
+    }
+
+    std::vector<StringView> chunks_;
+    size_t length_ = 0;
+    std::vector<std::unique_ptr<Char[]>> blocks_;
+    Char* block_end_ = nullptr;
+    size_t block_free_ = 0;
+    // Whether the last chunk ends at |block_end_| and can take the next copy.
+    bool last_copied_ = false;
+    // A deque never moves its elements, so chunks may view short strings
+    // stored inline.
+    std::deque<String> strings_;
+
+    DISALLOW_COPY_AND_ASSIGN(BasicRope);
+};
+
+typedef BasicRope<char> Rope;
+typedef BasicRope<char16> WRope;
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_STRING_BUILDER_INCLUDE_H_
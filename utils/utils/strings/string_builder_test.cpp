@@ -0,0 +1,113 @@
+#include <Windows.h>
+#include "utils/strings/string_builder.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <stdio.h>
+
+#include <iostream>
+#include <list>
+
+#ifdef TEST
+
+int STRING_BUILDER_TEST(void) {
+    // Any range of anything that makes a view.
+    const std::list<std::string> list = { "usr", "local", "bin" };
+    const char* const pointers[] = { "a", "", "c" };
+    if (x::JoinString(list.begin(), list.end(), "/") != "usr/local/bin") __debugbreak();
+    if (x::JoinString(std::begin(pointers), std::end(pointers), ", ") != "a, , c") __debugbreak();
+    if (!x::JoinString(list.end(), list.end(), "/").empty()) __debugbreak();
+    const std::wstring_view wide[] = { L"x", L"\x4E2D" };
+    if (x::JoinString(std::begin(wide), std::end(wide), L"--") != L"x--\x4E2D") __debugbreak();
+
+    utils::StringBuilder builder;
+    const std::string host = "example.com";
+    builder.Append("https").Append("://").Append(host).Append("");
+    builder.AppendJoined(list.begin(), list.end(), "/");
+    if (builder.length() != 32 || builder.Build() != "https://example.comusr/local/bin") __debugbreak();
+    std::string output = "url=";
+    builder.AppendTo(&output);
+    if (output != "url=https://example.comusr/local/bin") __debugbreak();
+    builder.clear();
+    if (!builder.empty() || !builder.Build().empty()) __debugbreak();
+
+    utils::Rope rope;
+    std::vector<std::string> rows;
+    for (int i = 0; i < 1000; ++i) rows.push_back("row " + std::to_string(i));
+    rope.Append("header\n");
+    rope.AppendJoined(rows.begin(), rows.end(), "\n");
+    const std::string big(5000, 'x');
+    rope.Append(big);
+    rope.Append(std::string("adopted"));
+    rope.Append(std::string_view("tail")).Append("!");
+    rope.AppendExternal(host);
+    std::string expected = "header\n" + x::JoinString(rows, "\n") + big + "adopted" + "tail!" + host;
+    if (rope.length() != expected.size() || rope.Flatten() != expected) __debugbreak();
+    // The header and rows are packed into blocks, |big| gets a block of its
+    // own, and |host| is referenced.
+    const std::vector<std::string_view>& chunks = rope.chunks();
+    if (chunks.size() < 5 || chunks.size() > 10 || chunks[0].substr(0, 12) != "header\nrow 0") __debugbreak();
+    if (chunks[chunks.size() - 4] != big || chunks[chunks.size() - 2] != "tail!") __debugbreak();
+    if (chunks.back().data() != host.data() || chunks[chunks.size() - 3] != "adopted") __debugbreak();
+
+    std::string written;
+    if (!rope.WriteTo([&](const char* data, size_t size) {
+            written.append(data, size);
+            return true;
+        }) || written != expected) __debugbreak();
+    size_t calls = 0;
+    if (rope.WriteTo([&](const char*, size_t) { return ++calls < 3; }) || calls != 3) __debugbreak();
+
+    utils::Rope moved(std::move(rope));
+    if (!rope.empty() || moved.Flatten() != expected) __debugbreak();
+    rope.Append("reused");
+    rope = std::move(moved);
+    if (rope.Flatten() != expected) __debugbreak();
+
+    utils::WRope wide_rope;
+    wide_rope.Append(L"\x4E2D").Append(L"\x6587").AppendExternal(wide[0]);
+    if (wide_rope.chunks().size() != 2 || wide_rope.Flatten() != L"\x4E2D\x6587x") __debugbreak();
+    return 0;
+}
+
+// Joins one million CSV rows (about 60MB) and writes them to a temporary
+// file: appended one at a time without presizing, with x::JoinString(), and
+// streamed from a utils::Rope without flattening. Prints the time each takes.
+int STRING_BUILDER_BENCHMARK(void) {
+    std::vector<std::string> rows;
+    for (int i = 0; i < 1000000; ++i)
+        rows.push_back(std::to_string(i) + ",2018-06-01T12:00:00Z,worker-" + std::to_string(i % 64) + ",GET,/index.html");
+
+    FILE* file = tmpfile();
+    if (!file) return 1;
+    size_t sizes = 0;
+    auto write = [&](const char* data, size_t size) { return fwrite(data, 1, size, file) == size; };
+
+    auto appended = TimeMicroseconds([&]() {
+        std::string result;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (i) result += "\n";
+            result += rows[i];
+        }
+        write(result.data(), result.size());
+        sizes += result.size();
+    });
+    auto joined = TimeMicroseconds([&]() {
+        const std::string result = x::JoinString(rows, "\n");
+        write(result.data(), result.size());
+        sizes += result.size();
+    });
+    auto streamed = TimeMicroseconds([&]() {
+        utils::Rope rope;
+        rope.AppendJoined(rows.begin(), rows.end(), "\n");
+        rope.WriteTo(write);
+        sizes += rope.length();
+    });
+    fclose(file);
+
+    std::cout << "Join and write: append " << appended << "us, JoinString " << joined << "us, Rope " << streamed
+              << "us" << std::endl;
+    return sizes ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/string_search.h"
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+// True if the needle, whose first and last characters are already known to
+// match at |candidate|, matches in full.
+template <typename Char>
+inline bool MiddleMatches(const Char* candidate, const Char* needle, size_t needle_length) {
+    return needle_length <= 2 ||
+           std::char_traits<Char>::compare(candidate + 1, needle + 1, needle_length - 2) == 0;
+}
+
+// Jumps between occurrences of the first needle character with memchr() or
+// wmemchr() and checks the last character before the rest.
+template <typename Char>
+size_t FilterScalar(const Char* haystack, size_t length, const Char* needle, size_t needle_length) {
+    typedef std::char_traits<Char> Traits;
+    if (length < needle_length) return length;
+    const size_t last = needle_length - 1;
+    const size_t candidates = length - last;
+    for (size_t i = 0; i < candidates; ++i) {
+        const Char* first = Traits::find(haystack + i, candidates - i, needle[0]);
+        if (!first) break;
+        i = first - haystack;
+        if (haystack[i + last] == needle[last] && MiddleMatches(haystack + i, needle, needle_length)) return i;
+    }
+    return length;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// Each register compares the first needle character against 16 bytes of
+// haystack positions and the last one against the same positions shifted by
+// the needle length; a position is a candidate only where both hit.
+template <typename Char>
+TARGET_ISA("sse2") size_t FilterSSE2(const Char* haystack, size_t length, const Char* needle, size_t needle_length) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k128;
+    // A 16-bit match sets two mask bits; clear both at once.
+    const uint32 kCharBits = sizeof(Char) == 1 ? 1 : 3;
+    const size_t last = needle_length - 1;
+    const __m128i first_char = Broadcast128(needle[0]);
+    const __m128i last_char = Broadcast128(needle[last]);
+
+    size_t i = 0;
+    for (; i + last + kLanes <= length; i += kLanes) {
+        const __m128i first = Equal128(Load128(haystack + i), first_char, Char());
+        const __m128i tail = Equal128(Load128(haystack + i + last), last_char, Char());
+        uint32 mask = MoveMask128(_mm_and_si128(first, tail));
+        while (mask) {
+            const uint32 bit = LowestSetBit(mask);
+            const size_t candidate = i + bit / sizeof(Char);
+            if (MiddleMatches(haystack + candidate, needle, needle_length)) return candidate;
+            mask &= ~(kCharBits << bit);
+        }
+    }
+    return i + FilterScalar(haystack + i, length - i, needle, needle_length);
+}
+
+template <typename Char>
+TARGET_ISA("avx2") size_t FilterAVX2(const Char* haystack, size_t length, const Char* needle, size_t needle_length) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k256;
+    const uint32 kCharBits = sizeof(Char) == 1 ? 1 : 3;
+    const size_t last = needle_length - 1;
+    const __m256i first_char = Broadcast256(needle[0]);
+    const __m256i last_char = Broadcast256(needle[last]);
+
+    size_t i = 0;
+    for (; i + last + kLanes <= length; i += kLanes) {
+        const __m256i first = Equal256(Load256(haystack + i), first_char, Char());
+        const __m256i tail = Equal256(Load256(haystack + i + last), last_char, Char());
+        uint32 mask = MoveMask256(_mm256_and_si256(first, tail));
+        while (mask) {
+            const uint32 bit = LowestSetBit(mask);
+            const size_t candidate = i + bit / sizeof(Char);
+            if (MiddleMatches(haystack + candidate, needle, needle_length)) return candidate;
+            mask &= ~(kCharBits << bit);
+        }
+    }
+    _mm256_zeroupper();
+    return i + FilterSSE2(haystack + i, length - i, needle, needle_length);
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+// Boyer-Moore-Horspool: line the needle up, compare its last character and
+// then the rest, and on a mismatch slide it so that the haystack character
+// under its end meets the nearest possible occurrence in the needle.
+template <typename Char>
+size_t Horspool(const Char* haystack, size_t length, const Char* needle, size_t needle_length, const uint32* shifts) {
+    typedef typename std::make_unsigned<Char>::type Unsigned;
+    const size_t last = needle_length - 1;
+    const Char last_char = needle[last];
+    for (size_t i = 0; i + last < length;) {
+        const Char c = haystack[i + last];
+        if (c == last_char && std::char_traits<Char>::compare(haystack + i, needle, last) == 0) return i;
+        i += shifts[static_cast<Unsigned>(c) & 0xFF];
+    }
+    return length;
+}
+
+template <typename Char>
+struct SearchKernel {
+    typedef size_t (*Function)(const Char*, size_t, const Char*, size_t);
+
+    // wchar_t is 32 bits wide outside Windows, where only the scalar filter
+    // exists.
+    static Function Select() {
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (sizeof(Char) <= 2) {
+            const utils::CPU& cpu = utils::CPU::Get();
+            if (cpu.has_avx2()) return &FilterAVX2<Char>;
+            if (cpu.has_sse2()) return &FilterSSE2<Char>;
+        }
+#endif
+        return &FilterScalar<Char>;
+    }
+
+    static size_t Run(const Char* haystack, size_t length, const Char* needle, size_t needle_length,
+                      const uint32* shifts) {
+        if (shifts) return Horspool(haystack, length, needle, needle_length, shifts);
+        if (needle_length == 1) {
+            const Char* found = std::char_traits<Char>::find(haystack, length, needle[0]);
+            return found ? found - haystack : length;
+        }
+        static const Function kernel = Select();
+        return kernel(haystack, length, needle, needle_length);
+    }
+};
+
+}  // namespace
+
+size_t utils::internal::FindSubstring(const char* haystack, size_t length, const char* needle, size_t needle_length,
+                                      const uint32* shifts) {
+    return SearchKernel<char>::Run(haystack, length, needle, needle_length, shifts);
+}
+
+size_t utils::internal::FindSubstring(const char16* haystack, size_t length, const char16* needle,
+                                      size_t needle_length, const uint32* shifts) {
+    return SearchKernel<char16>::Run(haystack, length, needle, needle_length, shifts);
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_STRING_SEARCH_INCLUDE_H_
+#define UTILS_STRINGS_STRING_SEARCH_INCLUDE_H_
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+namespace utils {
+namespace internal {
+
+// Returns the offset of the first occurrence of [needle, needle +
+// needle_length) in [haystack, haystack + length), or |length| when there is
+// none. |needle_length| is at least 1 and at most |length|. |shifts| is the
+// Horspool table of a SubstringSearcher (below) for long needles and null for
+// the filtered search. The kernels are chosen once per process from utils::CPU.
+UTILS_API size_t FindSubstring(const char* haystack, size_t length, const char* needle, size_t needle_length,
+                               const uint32* shifts);
+UTILS_API size_t FindSubstring(const char16* haystack, size_t length, const char16* needle, size_t needle_length,
+                               const uint32* shifts);
+
+} // namespace internal
+
+// A needle prepared once for searching any number of haystacks.
+//
+// Needles of up to |kMaxFilteredLength| characters are found by comparing the
+// first and last needle characters against 16 or 32 haystack positions at a
+// time (SSE2/AVX2) and checking the middle only where both match, so the
+// middle is rarely touched. Single characters go to memchr()/wmemchr().
+// Longer needles use Boyer-Moore-Horspool, which skips ahead by up to the
+// needle length on each mismatch; its shift table is built here, keyed by
+// the low byte of each character.
+// Example:
+//   static const utils::SubstringSearcher<char> kMarker("<!-- end of header -->");
+//   size_t end = kMarker.Find(page);
+template <typename Char>
+class SubstringSearcher {
+public:
+    typedef std::basic_string<Char> String;
+    typedef std::basic_string_view<Char> StringView;
+
+    static const size_t kMaxFilteredLength = 32;
+
+    explicit SubstringSearcher(StringView needle) : needle_(needle) {
+        const size_t length = needle_.size();
+        if (length <= kMaxFilteredLength) return;
+        for (uint32& shift : shifts_) shift = static_cast<uint32>(length);
+        for (size_t i = 0; i + 1 < length; ++i) shifts_[LowByte(needle_[i])] = static_cast<uint32>(length - 1 - i);
+    }
+
+    const String& needle() const { return needle_; }
+    size_t size() const { return needle_.size(); }
+
+    // Returns the offset of the first occurrence of the needle in |haystack|
+    // at or after |from|, or StringView::npos. An empty needle is found at
+    // |from| when |from| is within |haystack|, as with std::string::find().
+    size_t Find(StringView haystack, size_t from = 0) const {
+        if (from > haystack.size() || needle_.size() > haystack.size() - from) return StringView::npos;
+        if (needle_.empty()) return from;
+        const size_t length = haystack.size() - from;
+        const size_t found = internal::FindSubstring(haystack.data() + from, length, needle_.data(), needle_.size(),
+                                                     needle_.size() > kMaxFilteredLength ? shifts_ : nullptr);
+        return found == length ? StringView::npos : from + found;
+    }
+
+private:
+    static size_t LowByte(Char c) { return static_cast<typename std::make_unsigned<Char>::type>(c) & 0xFF; }
+
+    String needle_;
+    uint32 shifts_[256];
+};
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_STRING_SEARCH_INCLUDE_H_
@@ -0,0 +1,111 @@
+#include <Windows.h>
+#include "utils/strings/string_search.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// Checks SubstringSearcher::Find() against std::basic_string::find() for
+// needles cut from |text| and mutated copies of them, at every start offset.
+template <typename Char>
+bool CheckAgainstFind(const std::basic_string<Char>& text, std::mt19937* random) {
+    for (size_t length = 1; length <= 80; ++length) {
+        for (int round = 0; round < 4; ++round) {
+            const size_t begin = (*random)() % (text.size() - length);
+            std::basic_string<Char> needle = text.substr(begin, length);
+            if (round & 1) needle[(*random)() % length] ^= 1;
+            const utils::SubstringSearcher<Char> searcher(needle);
+            for (size_t from = 0; from <= text.size(); from += 1 + (*random)() % 7) {
+                if (searcher.Find(text, from) != text.find(needle, from)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int STRING_SEARCH_TEST(void) {
+    const utils::SubstringSearcher<char> empty("");
+    if (empty.Find("abc") != 0 || empty.Find("abc", 3) != 3 || empty.Find("abc", 4) != std::string::npos) __debugbreak();
+    const utils::SubstringSearcher<char> abc("abc");
+    if (abc.Find("ab") != std::string::npos || abc.Find("xxabcabc", 3) != 5 || abc.Find("abc", 1) != std::string::npos)
+        __debugbreak();
+
+    // A small alphabet makes for many partial matches, both at the first and
+    // last characters and in the Horspool comparisons.
+    std::mt19937 random(2018);
+    std::string narrow;
+    std::wstring wide;
+    for (int i = 0; i < 700; ++i) {
+        narrow += "ab\xE1"[random() % 3];
+        wide += L"ab\x4E2D\x0161"[random() % 4];
+    }
+    if (!CheckAgainstFind(narrow, &random) || !CheckAgainstFind(wide, &random)) __debugbreak();
+
+    std::string str = "one two one two one";
+    x::ReplaceFirstSubstringAfterOffset(&str, 1, "one", "1");
+    if (str != "one two 1 two one") __debugbreak();
+    x::ReplaceSubstringsAfterOffset(&str, 0, "one", "three");
+    if (str != "three two 1 two three") __debugbreak();
+    x::ReplaceSubstringsAfterOffset(&str, 0, "two", "owt");
+    if (str != "three owt 1 owt three") __debugbreak();
+    x::ReplaceSubstringsAfterOffset(&str, 0, "", "x");
+    x::ReplaceSubstringsAfterOffset(&str, str.size(), "three", "x");
+    if (str != "three owt 1 owt three") __debugbreak();
+    // The replacement is never searched again.
+    std::string nested = "aaa";
+    x::ReplaceSubstringsAfterOffset(&nested, 0, "a", "aa");
+    if (nested != "aaaaaa") __debugbreak();
+    std::wstring path = L"C:\\dir\\\\file";
+    static const utils::SubstringSearcher<wchar_t> kDoubleSeparator(L"\\\\");
+    x::ReplaceSubstringsAfterOffset(&path, 0, kDoubleSeparator, L"\\");
+    if (path != L"C:\\dir\\file") __debugbreak();
+    const std::string long_needle(40, 'q');
+    std::string haystack = "head " + long_needle + " middle " + long_needle + long_needle + " tail";
+    x::ReplaceSubstringsAfterOffset(&haystack, 0, long_needle, "Q");
+    if (haystack != "head Q middle QQ tail") __debugbreak();
+    return 0;
+}
+
+// Searches 64MB of text for a short and a long needle that occur only at its
+// end with std::string::find() and with a SubstringSearcher, then replaces
+// 10000 matches the old way (find and replace in place) and with
+// x::ReplaceSubstringsAfterOffset(). Prints the time each takes.
+int STRING_SEARCH_BENCHMARK(void) {
+    const std::string line = "2018-06-01 12:00:00.000 [info] worker=7 request=GET /index.html status=200\r\n";
+    std::string text;
+    while (text.size() < 64 * 1024 * 1024) text += line;
+    const std::string short_needle = "status=404";
+    const std::string long_needle = "2018-06-01 12:00:00.000 [error] worker=7 request=POST /upload status=500";
+    text += long_needle + short_needle;
+
+    size_t found = 0;
+    auto std_short = TimeMicroseconds([&]() { found += text.find(short_needle); });
+    auto new_short = TimeMicroseconds([&]() { found -= utils::SubstringSearcher<char>(short_needle).Find(text); });
+    auto std_long = TimeMicroseconds([&]() { found += text.find(long_needle); });
+    auto new_long = TimeMicroseconds([&]() { found -= utils::SubstringSearcher<char>(long_needle).Find(text); });
+
+    std::string replaced = text.substr(0, line.size() * 10000);
+    std::string old_way = replaced;
+    auto old_replace = TimeMicroseconds([&]() {
+        for (size_t offs = old_way.find("worker=7"); offs != std::string::npos; offs = old_way.find("worker=7", offs)) {
+            old_way.replace(offs, 8, "worker=seven");
+            offs += 12;
+        }
+    });
+    auto new_replace = TimeMicroseconds([&]() { x::ReplaceSubstringsAfterOffset(&replaced, 0, "worker=7", "worker=seven"); });
+
+    std::cout << "Short needle: find " << std_short << "us, SubstringSearcher " << new_short << "us" << std::endl;
+    std::cout << "Long needle: find " << std_long << "us, SubstringSearcher " << new_long << "us" << std::endl;
+    std::cout << "Replace all: in place " << old_replace << "us, ReplaceSubstringsAfterOffset " << new_replace << "us"
+              << std::endl;
+    return found == 0 && old_way == replaced ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_SUBSTRING_REPLACER_INCLUDE_H_
+#define UTILS_STRINGS_SUBSTRING_REPLACER_INCLUDE_H_
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// Replaces many substrings in one pass. The rule table is compiled once into
+// an Aho-Corasick automaton; every rewrite then walks the input once, whatever
+// the number of rules.
+// Where matches overlap, the one starting leftmost wins, and among those the
+// longest; the rewritten text is never scanned again, so rules do not chain the
+// way repeated x::ReplaceSubstringsAfterOffset() calls would. Empty patterns
+// are ignored and for duplicate patterns the first rule is used.
+// Example:
+//   utils::SubstringReplacer<std::string> replacer({ { "&", "&amp;" }, { "<", "&lt;" } });
+//   std::string html = replacer.Replace(text);
+template <typename STR>
+class SubstringReplacer {
+public:
+    typedef typename STR::value_type Char;
+    typedef typename std::make_unsigned<Char>::type Unsigned;
+    typedef std::basic_string_view<Char> StringView;
+    typedef std::vector<std::pair<STR, STR>> Rules;
+
+    explicit SubstringReplacer(const Rules& rules) : rules_(rules) { Compile(); }
+
+    SubstringReplacer(std::initializer_list<std::pair<STR, STR>> rules) : rules_(rules) { Compile(); }
+
+    size_t rule_count() const { return rules_.size(); }
+
+    // Rewrites |input| into |output|, which holds |capacity| characters and
+    // may not alias |input|. Returns the length of the full result; when it is
+    // larger than |capacity| the output was truncated, so callers can retry
+    // with a buffer of the returned size. No terminating null is written.
+    size_t Replace(StringView input, Char* output, size_t capacity) const {
+        size_t written = 0;
+        size_t copied_up_to = 0;
+        Scan(input, [&](size_t start, size_t rule) {
+            Append(output, capacity, &written, input.data() + copied_up_to, start - copied_up_to);
+            const STR& with = rules_[rule].second;
+            Append(output, capacity, &written, with.data(), with.size());
+            copied_up_to = start + rules_[rule].first.size();
+        });
+        Append(output, capacity, &written, input.data() + copied_up_to, input.size() - copied_up_to);
+        return written;
+    }
+
+    // Returns a rewritten copy of |input|. The matches are collected first so
+    // the result is allocated exactly once.
+    STR Replace(StringView input) const {
+        STR result;
+        Rewrite(StringView(), input, &result);
+        return result;
+    }
+
+    // Rewrites |*str| from |start_offset| on. Returns true if anything was
+    // replaced; |*str| is left untouched otherwise.
+    bool ReplaceInPlace(STR* str, size_t start_offset = 0) const {
+        if (start_offset >= str->size()) return false;
+        const StringView whole(str->data(), str->size());
+        STR result;
+        if (!Rewrite(whole.substr(0, start_offset), whole.substr(start_offset), &result)) return false;
+        str->swap(result);
+        return true;
+    }
+
+private:
+    static const int32 kNoRule = -1;
+
+    struct State {
+        int32 fail = 0;
+        int32 rule = kNoRule;     // Rule whose pattern ends exactly here.
+        int32 output = 0;         // Nearest state on the fail chain with a rule.
+        uint32 depth = 0;
+    };
+
+    // Stores |prefix| followed by the rewritten |input| in |*result|.
+    // Returns false if |input| had no match.
+    bool Rewrite(StringView prefix, StringView input, STR* result) const {
+        std::vector<std::pair<size_t, size_t>> matches;
+        size_t length = prefix.size() + input.size();
+        Scan(input, [&](size_t start, size_t rule) {
+            matches.emplace_back(start, rule);
+            length = length - rules_[rule].first.size() + rules_[rule].second.size();
+        });
+
+        result->resize(length);
+        if (!length) return !matches.empty();
+        Char* out = std::copy(prefix.begin(), prefix.end(), &(*result)[0]);
+        size_t copied_up_to = 0;
+        for (const auto& match : matches) {
+            const std::pair<STR, STR>& rule = rules_[match.second];
+            out = std::copy(input.data() + copied_up_to, input.data() + match.first, out);
+            out = std::copy(rule.second.begin(), rule.second.end(), out);
+            copied_up_to = match.first + rule.first.size();
+        }
+        std::copy(input.data() + copied_up_to, input.data() + input.size(), out);
+        return !matches.empty();
+    }
+
+    static void Append(Char* output, size_t capacity, size_t* written, const Char* src, size_t count) {
+        if (*written < capacity) {
+            std::copy(src, src + std::min(count, capacity - *written), output + *written);
+        }
+        *written += count;
+    }
+
+    // Maps a character onto its column in the transition table. Characters
+    // that occur in no pattern share column 0.
+    size_t ClassOf(Char c) const {
+        const Unsigned u = static_cast<Unsigned>(c);
+        if (u < 256) return narrow_classes_[u];
+        auto it = std::lower_bound(wide_classes_.begin(), wide_classes_.end(), std::make_pair(u, uint32(0)));
+        if (it != wide_classes_.end() && it->first == u) return it->second;
+        return 0;
+    }
+
+    void Compile() {
+        std::fill(narrow_classes_, narrow_classes_ + 256, uint32(0));
+        classes_ = 1;
+        for (const auto& rule : rules_) {
+            for (Char c : rule.first) {
+                const Unsigned u = static_cast<Unsigned>(c);
+                if (u < 256) {
+                    if (!narrow_classes_[u]) narrow_classes_[u] = static_cast<uint32>(classes_++);
+                } else if (!ClassOf(c)) {
+                    wide_classes_.insert(std::upper_bound(wide_classes_.begin(), wide_classes_.end(), std::make_pair(u, uint32(0))),
+                                         std::make_pair(u, static_cast<uint32>(classes_++)));
+                }
+            }
+        }
+
+        // Build the trie; 0 in |next_| means "no edge" until the links are set.
+        states_.assign(1, State());
+        next_.assign(classes_, 0);
+        for (size_t r = 0; r < rules_.size(); ++r) {
+            const STR& pattern = rules_[r].first;
+            if (pattern.empty()) continue;
+            int32 state = 0;
+            for (Char c : pattern) {
+                const size_t edge = state * classes_ + ClassOf(c);
+                if (!next_[edge]) {
+                    State child;
+                    child.depth = states_[state].depth + 1;
+                    next_[edge] = static_cast<int32>(states_.size());
+                    states_.push_back(child);
+                    next_.resize(states_.size() * classes_, 0);
+                }
+                state = next_[edge];
+            }
+            if (states_[state].rule == kNoRule) states_[state].rule = static_cast<int32>(r);
+        }
+
+        // Breadth-first pass: fill in failure links, turn the trie into a full
+        // DFA and chain each state to the nearest matching suffix state.
+        std::vector<int32> queue;
+        queue.reserve(states_.size());
+        for (size_t c = 0; c < classes_; ++c) {
+            if (next_[c]) queue.push_back(next_[c]);
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int32 state = queue[head];
+            const int32 fail = states_[state].fail;
+            states_[state].output = states_[fail].rule != kNoRule ? fail : states_[fail].output;
+            for (size_t c = 0; c < classes_; ++c) {
+                int32& edge = next_[state * classes_ + c];
+                if (edge) {
+                    states_[edge].fail = next_[fail * classes_ + c];
+                    queue.push_back(edge);
+                } else {
+                    edge = next_[fail * classes_ + c];
+                }
+            }
+        }
+    }
+
+    // Walks |input| and reports the non-overlapping, leftmost-longest matches
+    // in order as |on_match(start, rule)|. After each replacement the
+    // automaton restarts at the end of the match, so at most the length of the
+    // longest pattern is read twice per replacement.
+    template <typename Callback>
+    void Scan(StringView input, Callback on_match) const {
+        if (states_.size() == 1) return;
+
+        size_t best_start = 0, best_rule = 0;
+        bool pending = false;
+        int32 state = 0;
+        for (size_t i = 0; i < input.size() || pending; ++i) {
+            if (i < input.size()) state = next_[state * classes_ + ClassOf(input[i])];
+
+            // Once the automaton no longer remembers |best_start|, no later
+            // match can start at or before it, so the pending match is final.
+            if (pending && (i == input.size() || i + 1 - states_[state].depth > best_start)) {
+                on_match(best_start, best_rule);
+                i = best_start + rules_[best_rule].first.size() - 1;
+                state = 0;
+                pending = false;
+                continue;
+            }
+
+            // The longest pattern ending here starts leftmost of all the
+            // patterns ending here.
+            const int32 s = states_[state].rule != kNoRule ? state : states_[state].output;
+            if (!s) continue;
+            const size_t start = i + 1 - states_[s].depth;
+            const size_t rule = states_[s].rule;
+            if (!pending || start < best_start ||
+                (start == best_start && rules_[rule].first.size() > rules_[best_rule].first.size())) {
+                best_start = start;
+                best_rule = rule;
+                pending = true;
+            }
+        }
+    }
+
+    Rules rules_;
+    std::vector<State> states_;
+    std::vector<int32> next_;                               // states_ x classes_
+    uint32 narrow_classes_[256];
+    std::vector<std::pair<Unsigned, uint32>> wide_classes_;  // Sorted by character.
+    size_t classes_ = 1;
+};
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_SUBSTRING_REPLACER_INCLUDE_H_
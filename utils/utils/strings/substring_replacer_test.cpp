@@ -0,0 +1,151 @@
+#include <Windows.h>
+#include "utils/strings/substring_replacer.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+#include <random>
+
+#ifdef TEST
+
+namespace {
+
+// The rules applied the slow way: at each position the longest pattern that
+// matches there is replaced, the first rule winning among duplicates.
+std::string ReplaceNaive(const std::string& input, const std::vector<std::pair<std::string, std::string>>& rules) {
+    std::string result;
+    for (size_t i = 0; i < input.size();) {
+        const std::pair<std::string, std::string>* best = nullptr;
+        for (const auto& rule : rules) {
+            if (rule.first.empty() || input.compare(i, rule.first.size(), rule.first) != 0) continue;
+            if (!best || rule.first.size() > best->first.size()) best = &rule;
+        }
+        if (best) {
+            result += best->second;
+            i += best->first.size();
+        } else {
+            result += input[i++];
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+int SUBSTRING_REPLACER_TEST(void) {
+    typedef utils::SubstringReplacer<std::string> Replacer;
+
+    // The match starting leftmost wins, and the longest of those.
+    const Replacer words({ { "he", "1" }, { "hello", "2" }, { "ell", "3" }, { "lo", "4" } });
+    if (words.Replace("hello") != "2" || words.Replace("hell") != "1ll" || words.Replace("shell") != "s1ll") __debugbreak();
+    if (words.Replace("yellow") != "y3ow" || words.Replace("hello hell lo") != "2 1ll 4") __debugbreak();
+
+    // Overlapping patterns: the one found first consumes the shared text.
+    const Replacer overlapping({ { "abc", "X" }, { "bcd", "Y" }, { "cd", "Z" } });
+    if (overlapping.Replace("abcd") != "Xd" || overlapping.Replace("xbcd") != "xY" || overlapping.Replace("acd") != "aZ")
+        __debugbreak();
+
+    // Duplicate patterns use the first rule; replacements are not rescanned.
+    const Replacer duplicates({ { "a", "b" }, { "a", "c" }, { "b", "a" } });
+    if (duplicates.rule_count() != 3 || duplicates.Replace("ab") != "ba") __debugbreak();
+
+    // Empty patterns are ignored.
+    const Replacer empty_pattern({ { "", "E" }, { "b", "B" } });
+    if (empty_pattern.Replace("abc") != "aBc" || !empty_pattern.Replace("").empty()) __debugbreak();
+    const Replacer only_empty({ { "", "E" } });
+    if (only_empty.Replace("abc") != "abc") __debugbreak();
+
+    // ReplaceInPlace() leaves the text before the offset alone, and the string
+    // untouched when nothing matched.
+    const Replacer dash({ { "a", "xy" } });
+    std::string text = "a-a-a";
+    if (!dash.ReplaceInPlace(&text, 2) || text != "a-xy-xy") __debugbreak();
+    if (dash.ReplaceInPlace(&text, 2) || text != "a-xy-xy") __debugbreak();
+    if (dash.ReplaceInPlace(&text, text.size()) || dash.ReplaceInPlace(&text, 100) || text != "a-xy-xy") __debugbreak();
+    text = "aaa";
+    if (!dash.ReplaceInPlace(&text) || text != "xyxyxy") __debugbreak();
+
+    // A short buffer holds a prefix of the result; the full length is returned.
+    const std::string full = dash.Replace("-a-a-");
+    char buffer[16];
+    for (size_t capacity = 0; capacity <= sizeof(buffer); ++capacity) {
+        memset(buffer, '#', sizeof(buffer));
+        if (dash.Replace("-a-a-", buffer, capacity) != full.size()) __debugbreak();
+        const size_t written = std::min(capacity, full.size());
+        if (full.compare(0, written, buffer, written) != 0) __debugbreak();
+        if (written < sizeof(buffer) && buffer[written] != '#') __debugbreak();
+    }
+
+    // Characters above 0xFF take the sorted class table.
+    const utils::SubstringReplacer<std::wstring> wide({ { L"\x4E2D\x6587", L"zh" }, { L"\x6587", L"wen" }, { L"a", L"\x0100" } });
+    if (wide.Replace(L"a\x4E2D\x6587\x6587\x4E2D") != L"\x0100zhwen\x4E2D") __debugbreak();
+
+    // Rules that cannot feed one another give what one
+    // x::ReplaceSubstringsAfterOffset() call per rule gives.
+    const std::vector<std::pair<std::string, std::string>> html = {
+        { "&", "&amp;" }, { "<", "&lt;" }, { ">", "&gt;" }, { "\"", "&quot;" }, { "'", "&#39;" },
+    };
+    const Replacer escape(html);
+    std::mt19937 random(2);
+    const char alphabet[] = "ab <>&\"'";
+    for (int round = 0; round < 200; ++round) {
+        std::string input;
+        for (size_t length = random() % 60; length; --length) input += alphabet[random() % (sizeof(alphabet) - 1)];
+        std::string expected = input;
+        for (const auto& rule : html) x::ReplaceSubstringsAfterOffset(&expected, 0, rule.first, rule.second);
+        if (escape.Replace(input) != expected) __debugbreak();
+        // So does the rule-table overload, after an offset.
+        const size_t offset = input.empty() ? 0 : random() % input.size();
+        std::string wrapped = input, per_rule = input;
+        x::ReplaceSubstringsAfterOffset(&wrapped, offset, html);
+        for (const auto& rule : html) x::ReplaceSubstringsAfterOffset(&per_rule, offset, rule.first, rule.second);
+        if (wrapped != per_rule || wrapped.compare(0, offset, input, 0, offset) != 0) __debugbreak();
+    }
+
+    // Random rule tables over a small alphabet, so matches overlap, nest and
+    // repeat, against the naive rewrite.
+    for (int round = 0; round < 300; ++round) {
+        std::vector<std::pair<std::string, std::string>> rules;
+        for (size_t count = 1 + random() % 8; count; --count) {
+            std::string pattern, replacement;
+            for (size_t length = random() % 5; length; --length) pattern += static_cast<char>('a' + random() % 3);
+            for (size_t length = random() % 4; length; --length) replacement += static_cast<char>('x' + random() % 3);
+            rules.emplace_back(pattern, replacement);
+        }
+        const Replacer replacer(rules);
+        for (int text_round = 0; text_round < 10; ++text_round) {
+            std::string input;
+            for (size_t length = random() % 40; length; --length) input += static_cast<char>('a' + random() % 4);
+            if (replacer.Replace(input) != ReplaceNaive(input, rules)) __debugbreak();
+        }
+    }
+    return 0;
+}
+
+// Fills a 1MB template that uses 40 placeholders with one
+// x::ReplaceSubstringsAfterOffset() call per placeholder, which rewrites the
+// whole string each time, and with one SubstringReplacer pass, and prints the
+// time each takes.
+int SUBSTRING_REPLACER_BENCHMARK(void) {
+    std::vector<std::pair<std::string, std::string>> rules;
+    for (int i = 0; i < 40; ++i) rules.emplace_back("{{field_" + std::to_string(i) + "}}", "value " + std::to_string(i * 31));
+    std::string input;
+    for (int i = 0; input.size() < 1024 * 1024; ++i) input += "<td class=\"cell\">" + rules[i * 7 % 40].first + "</td>\n";
+
+    std::string repeated = input;
+    auto repeated_time = TimeMicroseconds([&]() {
+        for (const auto& rule : rules) x::ReplaceSubstringsAfterOffset(&repeated, 0, rule.first, rule.second);
+    });
+
+    std::string single;
+    auto single_time = TimeMicroseconds([&]() {
+        const utils::SubstringReplacer<std::string> replacer(rules);
+        single = replacer.Replace(input);
+    });
+
+    std::cout << "40 rules over 1MB: ReplaceSubstringsAfterOffset " << repeated_time << "us, SubstringReplacer "
+              << single_time << "us" << std::endl;
+    return repeated == single ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_TOKENIZER_INCLUDE_H_
+#define UTILS_STRINGS_TOKENIZER_INCLUDE_H_
+
+#include <iterator>
+#include <string_view>
+
+#include "utils/strings/char_set.h"
+
+namespace utils {
+
+// A lazy range over the fields of a string delimited by any of a set of
+// characters, with the same splitting rules as x::Tokenize(): runs of
+// delimiters are skipped, so no empty token is ever produced. Each token is a
+// view into the input, so nothing is copied or allocated; |str| must outlive
+// the range.
+// Example:
+//   for (std::string_view line : utils::TokenizeView(log, "\r\n"))
+//     ...
+template <typename Char>
+class TokenRange {
+public:
+    typedef std::basic_string_view<Char> StringView;
+
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef StringView value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const StringView* pointer;
+        typedef StringView reference;
+
+        iterator() {}
+
+        StringView operator*() const {
+            return StringView(range_->str_.data() + begin_, end_ - begin_);
+        }
+
+        iterator& operator++() {
+            Seek(end_);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const iterator& r) const { return begin_ == r.begin_; }
+        bool operator!=(const iterator& r) const { return begin_ != r.begin_; }
+
+    private:
+        friend class TokenRange;
+
+        iterator(const TokenRange* range, size_t offset) : range_(range) {
+            Seek(offset);
+        }
+
+        // Positions the iterator on the first token at or after |offset|.
+        void Seek(size_t offset) {
+            const Char* data = range_->str_.data();
+            const size_t size = range_->str_.size();
+            begin_ = offset + internal::FindFirstNotOf(data + offset, size - offset, range_->delimiters_);
+            end_ = size;
+            if (begin_ == size) return;
+            end_ = begin_ + 1 + internal::FindFirstOf(data + begin_ + 1, size - begin_ - 1, range_->delimiters_);
+        }
+
+        const TokenRange* range_ = nullptr;
+        size_t begin_ = 0;
+        size_t end_ = 0;
+    };
+
+    TokenRange(StringView str, StringView delimiters)
+        : str_(str), delimiters_(delimiters) {}
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const {
+        iterator it;
+        it.range_ = this;
+        it.begin_ = it.end_ = str_.size();
+        return it;
+    }
+
+private:
+    StringView str_;
+    CharSet<Char> delimiters_;
+};
+
+inline TokenRange<char> TokenizeView(std::string_view str, std::string_view delimiters) {
+    return TokenRange<char>(str, delimiters);
+}
+
+inline TokenRange<char16> TokenizeView(std::basic_string_view<char16> str, std::basic_string_view<char16> delimiters) {
+    return TokenRange<char16>(str, delimiters);
+}
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_TOKENIZER_INCLUDE_H_
@@ -0,0 +1,61 @@
+#include <Windows.h>
+#include "utils/strings/tokenizer.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+int TOKENIZER_TEST(void) {
+    const std::string input = ",,alpha, beta,,gamma;delta , ;epsilon-with-a-rather-long-token-name;;";
+    const std::string delimiters = ",; ";
+
+    std::vector<std::string> expected;
+    x::Tokenize(input, delimiters, &expected);
+
+    size_t index = 0;
+    for (std::string_view token : utils::TokenizeView(input, delimiters)) {
+        if (index >= expected.size() || token != expected[index]) __debugbreak();
+        ++index;
+    }
+    if (index != expected.size()) __debugbreak();
+
+    const std::wstring wide = L"  one\ttwo  three\t";
+    std::vector<std::wstring> expected_wide;
+    x::Tokenize(wide, std::wstring(L" \t"), &expected_wide);
+    index = 0;
+    for (auto token : utils::TokenizeView(wide, L" \t")) {
+        if (index >= expected_wide.size() || token != expected_wide[index]) __debugbreak();
+        ++index;
+    }
+    if (index != expected_wide.size()) __debugbreak();
+
+    return 0;
+}
+
+// Splits a synthetic 64MB log into lines and words with x::Tokenize() and with
+// utils::TokenizeView() and prints the time each one takes.
+int TOKENIZER_BENCHMARK(void) {
+    std::string log;
+    const std::string line = "2018-06-01 12:00:00.000 [info] worker=7 request=GET /index.html status=200\r\n";
+    while (log.size() < 64 * 1024 * 1024) log += line;
+
+    std::vector<std::string> tokens;
+    size_t copied = 0;
+    auto copy_time = TimeMicroseconds([&]() { copied = x::Tokenize(log, std::string(" \r\n"), &tokens); });
+
+    size_t viewed = 0;
+    auto view_time = TimeMicroseconds([&]() {
+        for (std::string_view token : utils::TokenizeView(log, " \r\n")) {
+            (void)token;
+            ++viewed;
+        }
+    });
+
+    std::cout << "Tokenize: " << copied << " tokens in " << copy_time << "us" << std::endl;
+    std::cout << "TokenizeView: " << viewed << " tokens in " << view_time << "us" << std::endl;
+    return copied == viewed ? 0 : 1;
+}
+
+#endif // TEST
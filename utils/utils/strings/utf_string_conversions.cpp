@@ -0,0 +1,560 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/utf_string_conversions.h"
+
+#include <string.h>
+
+#include <type_traits>
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+const uint32 kReplacementCharacter = 0xFFFD;
+// Returned by the decoders in place of a code point.
+const uint32 kInvalid = 0xFFFFFFFE;
+const uint32 kIncomplete = 0xFFFFFFFF;
+
+template <typename Char>
+inline uint32 CodeUnit(Char c) {
+    return static_cast<typename std::make_unsigned<Char>::type>(c);
+}
+
+// Copy the leading characters of |src| that are below |limit| (0x80 or
+// 0x100) to |dst|, widening or narrowing them, and return how many there were.
+// With a NULL |dst| they only count.
+template <typename Char>
+size_t WidenScalar(const char* src, size_t length, uint32 limit, Char* dst) {
+    for (size_t i = 0; i < length; ++i) {
+        const uint32 c = CodeUnit(src[i]);
+        if (c >= limit) return i;
+        if (dst) dst[i] = static_cast<Char>(c);
+    }
+    return length;
+}
+
+template <typename Char>
+size_t NarrowScalar(const Char* src, size_t length, uint32 limit, char* dst) {
+    for (size_t i = 0; i < length; ++i) {
+        const uint32 c = CodeUnit(src[i]);
+        if (c >= limit) return i;
+        if (dst) dst[i] = static_cast<char>(c);
+    }
+    return length;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+TARGET_ISA("sse2") size_t WidenSSE2(const char* src, size_t length, uint32 limit, char16* dst) {
+    using namespace utils::simd;
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i bytes = Load128(src + i);
+        if (limit <= 0x80 && MoveMask128(bytes)) break;
+        if (dst) {
+            Store128(dst + i, _mm_unpacklo_epi8(bytes, zero));
+            Store128(dst + i + 8, _mm_unpackhi_epi8(bytes, zero));
+        }
+    }
+    return i + WidenScalar(src + i, length - i, limit, dst ? dst + i : nullptr);
+}
+
+TARGET_ISA("sse2") size_t NarrowSSE2(const char16* src, size_t length, uint32 limit, char* dst) {
+    using namespace utils::simd;
+    const __m128i high = Broadcast128(static_cast<char16>(~(limit - 1)));
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i a = Load128(src + i);
+        const __m128i b = Load128(src + i + 8);
+        const __m128i above = _mm_and_si128(_mm_or_si128(a, b), high);
+        if (MoveMask128(Equal128(above, _mm_setzero_si128(), char16())) != 0xFFFF) break;
+        if (dst) Store128(dst + i, _mm_packus_epi16(a, b));
+    }
+    return i + NarrowScalar(src + i, length - i, limit, dst ? dst + i : nullptr);
+}
+
+TARGET_ISA("avx2") size_t WidenAVX2(const char* src, size_t length, uint32 limit, char16* dst) {
+    using namespace utils::simd;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i bytes = Load256(src + i);
+        if (limit <= 0x80 && MoveMask256(bytes)) break;
+        if (dst) {
+            Store256(dst + i, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+            Store256(dst + i + 16, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+        }
+    }
+    _mm256_zeroupper();
+    return i + WidenSSE2(src + i, length - i, limit, dst ? dst + i : nullptr);
+}
+
+TARGET_ISA("avx2") size_t NarrowAVX2(const char16* src, size_t length, uint32 limit, char* dst) {
+    using namespace utils::simd;
+    const __m256i high = Broadcast256(static_cast<char16>(~(limit - 1)));
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i a = Load256(src + i);
+        const __m256i b = Load256(src + i + 16);
+        const __m256i above = _mm256_and_si256(_mm256_or_si256(a, b), high);
+        if (MoveMask256(Equal256(above, _mm256_setzero_si256(), char16())) != 0xFFFFFFFF) break;
+        // packus works within 128-bit lanes; put the quadwords back in order.
+        if (dst) Store256(dst + i, _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+    }
+    _mm256_zeroupper();
+    return i + NarrowSSE2(src + i, length - i, limit, dst ? dst + i : nullptr);
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+struct TranscodeKernels {
+    size_t (*widen)(const char*, size_t, uint32, char16*);
+    size_t (*narrow)(const char16*, size_t, uint32, char*);
+
+    // wchar_t is 32 bits wide outside Windows, where only the scalar loops
+    // exist.
+    static TranscodeKernels Select() {
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (sizeof(char16) == 2) {
+            const utils::CPU& cpu = utils::CPU::Get();
+            if (cpu.has_avx2()) return { &WidenAVX2, &NarrowAVX2 };
+            if (cpu.has_sse2()) return { &WidenSSE2, &NarrowSSE2 };
+        }
+#endif
+        return { &WidenScalar<char16>, &NarrowScalar<char16> };
+    }
+
+    static const TranscodeKernels& Get() {
+        static const TranscodeKernels kernels = Select();
+        return kernels;
+    }
+};
+
+// Decodes the sequence starting at |src[*index]| and moves |*index| past it.
+// An invalid sequence yields kInvalid and is skipped up to, not including, the
+// first byte that does not fit, so each maximal invalid subsequence becomes
+// one U+FFFD. Input that ends inside a sequence yields kIncomplete.
+inline uint32 DecodeUTF8(const char* src, size_t length, size_t* index) {
+    const uint32 lead = CodeUnit(src[(*index)++]);
+    if (lead < 0x80) return lead;
+
+    // The second byte has a narrower range for leads that could otherwise
+    // start an overlong form, a surrogate or a value above U+10FFFF.
+    size_t trail;
+    uint32 lower = 0x80, upper = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        trail = 1;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        trail = 2;
+        if (lead == 0xE0) lower = 0xA0;
+        if (lead == 0xED) upper = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        trail = 3;
+        if (lead == 0xF0) lower = 0x90;
+        if (lead == 0xF4) upper = 0x8F;
+    } else {
+        return kInvalid;
+    }
+
+    uint32 code_point = lead & (0x3F >> trail);
+    for (; trail; --trail) {
+        if (*index == length) return kIncomplete;
+        const uint32 c = CodeUnit(src[*index]);
+        if (c < lower || c > upper) return kInvalid;
+        code_point = (code_point << 6) | (c & 0x3F);
+        lower = 0x80;
+        upper = 0xBF;
+        ++*index;
+    }
+    return code_point;
+}
+
+// The wide counterpart of DecodeUTF8(): pairs surrogates on UTF-16 and
+// range-checks UTF-32.
+template <typename Char>
+inline uint32 DecodeWide(const Char* src, size_t length, size_t* index) {
+    const uint32 c = CodeUnit(src[(*index)++]);
+    if (c >= 0xD800 && c <= 0xDFFF) {
+        if (sizeof(Char) > 2 || c > 0xDBFF) return kInvalid;
+        if (*index == length) return kIncomplete;
+        const uint32 low = CodeUnit(src[*index]);
+        if (low < 0xDC00 || low > 0xDFFF) return kInvalid;
+        ++*index;
+        return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+    }
+    return c > 0x10FFFF ? kInvalid : c;
+}
+
+// Output sinks. Constructed with a NULL buffer they only count, which is how
+// the exact output length is found before the real pass.
+class WideSink {
+public:
+    explicit WideSink(char16* out) : out_(out) {}
+
+    size_t ASCIIRun(const char* src, size_t length) {
+        const size_t run = TranscodeKernels::Get().widen(src, length, 0x80, out_ ? out_ + size_ : nullptr);
+        size_ += run;
+        return run;
+    }
+
+    void Put(uint32 code_point) {
+        if (sizeof(char16) == 2 && code_point >= 0x10000) {
+            if (out_) {
+                out_[size_] = static_cast<char16>(0xD800 + ((code_point - 0x10000) >> 10));
+                out_[size_ + 1] = static_cast<char16>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+            }
+            size_ += 2;
+            return;
+        }
+        if (out_) out_[size_] = static_cast<char16>(code_point);
+        ++size_;
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    char16* out_;
+    size_t size_ = 0;
+};
+
+class UTF8Sink {
+public:
+    explicit UTF8Sink(char* out) : out_(out) {}
+
+    size_t ASCIIRun(const char16* src, size_t length) {
+        const size_t run = TranscodeKernels::Get().narrow(src, length, 0x80, out_ ? out_ + size_ : nullptr);
+        size_ += run;
+        return run;
+    }
+
+    size_t ASCIIRun(const char* src, size_t length) {
+        const size_t run = TranscodeKernels::Get().widen(src, length, 0x80, nullptr);
+        if (out_) memcpy(out_ + size_, src, run);
+        size_ += run;
+        return run;
+    }
+
+    void Put(uint32 code_point) {
+        if (code_point < 0x80) {
+            Write(code_point);
+        } else if (code_point < 0x800) {
+            Write(0xC0 | (code_point >> 6));
+            Write(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            Write(0xE0 | (code_point >> 12));
+            Write(0x80 | ((code_point >> 6) & 0x3F));
+            Write(0x80 | (code_point & 0x3F));
+        } else {
+            Write(0xF0 | (code_point >> 18));
+            Write(0x80 | ((code_point >> 12) & 0x3F));
+            Write(0x80 | ((code_point >> 6) & 0x3F));
+            Write(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    void Write(uint32 byte) {
+        if (out_) out_[size_] = static_cast<char>(byte);
+        ++size_;
+    }
+
+    char* out_;
+    size_t size_ = 0;
+};
+
+// Rejects anything above U+00FF instead of encoding it.
+class Latin1Sink {
+public:
+    explicit Latin1Sink(char* out) : out_(out) {}
+
+    size_t ASCIIRun(const char* src, size_t length) {
+        const size_t run = TranscodeKernels::Get().widen(src, length, 0x80, nullptr);
+        if (out_) memcpy(out_ + size_, src, run);
+        size_ += run;
+        return run;
+    }
+
+    void Put(uint32 code_point) {
+        if (code_point > 0xFF) fits_ = false;
+        else if (out_) out_[size_] = static_cast<char>(code_point);
+        ++size_;
+    }
+
+    size_t size() const { return size_; }
+    bool fits() const { return fits_; }
+
+private:
+    char* out_;
+    size_t size_ = 0;
+    bool fits_ = true;
+};
+
+// Feed |src| to |sink| and return the number of input units consumed. That is
+// all of them unless |stream| is set and the input ends inside a sequence,
+// which is then left for the next chunk. Invalid input clears |*valid|.
+template <typename Sink>
+size_t DecodeUTF8Into(const char* src, size_t length, bool stream, Sink* sink, bool* valid) {
+    size_t i = 0;
+    while (i < length) {
+        if (CodeUnit(src[i]) < 0x80) {
+            i += sink->ASCIIRun(src + i, length - i);
+            continue;
+        }
+        const size_t start = i;
+        uint32 code_point = DecodeUTF8(src, length, &i);
+        if (code_point == kIncomplete) {
+            if (stream) return start;
+            code_point = kInvalid;
+        }
+        if (code_point == kInvalid) {
+            *valid = false;
+            code_point = kReplacementCharacter;
+        }
+        sink->Put(code_point);
+    }
+    return length;
+}
+
+template <typename Sink>
+size_t DecodeWideInto(const char16* src, size_t length, bool stream, Sink* sink, bool* valid) {
+    size_t i = 0;
+    while (i < length) {
+        if (CodeUnit(src[i]) < 0x80) {
+            i += sink->ASCIIRun(src + i, length - i);
+            continue;
+        }
+        const size_t start = i;
+        uint32 code_point = DecodeWide(src, length, &i);
+        if (code_point == kIncomplete) {
+            if (stream) return start;
+            code_point = kInvalid;
+        }
+        if (code_point == kInvalid) {
+            *valid = false;
+            code_point = kReplacementCharacter;
+        }
+        sink->Put(code_point);
+    }
+    return length;
+}
+
+// Every Latin-1 byte is its own code point.
+void EncodeLatin1Into(std::string_view latin1, UTF8Sink* sink) {
+    for (size_t i = 0; i < latin1.size(); ++i) {
+        i += sink->ASCIIRun(latin1.data() + i, latin1.size() - i);
+        if (i < latin1.size()) sink->Put(CodeUnit(latin1[i]));
+    }
+}
+
+// Appends the conversion of |src| to |*output| with a counting pass, one
+// resize and a writing pass. Returns the number of input units consumed.
+size_t AppendUTF8AsWide(const char* src, size_t length, bool stream, std::wstring* output, bool* valid) {
+    WideSink counter(nullptr);
+    const size_t consumed = DecodeUTF8Into(src, length, stream, &counter, valid);
+    if (!counter.size()) return consumed;
+    const size_t offset = output->size();
+    output->resize(offset + counter.size());
+    WideSink writer(&(*output)[offset]);
+    DecodeUTF8Into(src, consumed, false, &writer, valid);
+    return consumed;
+}
+
+size_t AppendWideAsUTF8(const char16* src, size_t length, bool stream, std::string* output, bool* valid) {
+    UTF8Sink counter(nullptr);
+    const size_t consumed = DecodeWideInto(src, length, stream, &counter, valid);
+    if (!counter.size()) return consumed;
+    const size_t offset = output->size();
+    output->resize(offset + counter.size());
+    UTF8Sink writer(&(*output)[offset]);
+    DecodeWideInto(src, consumed, false, &writer, valid);
+    return consumed;
+}
+
+}  // namespace
+
+bool utils::UTF8ToWide(const char* src, size_t length, std::wstring* output) {
+    bool valid = true;
+    output->clear();
+    AppendUTF8AsWide(src, length, false, output, &valid);
+    return valid;
+}
+
+std::wstring utils::UTF8ToWide(std::string_view utf8) {
+    std::wstring result;
+    UTF8ToWide(utf8.data(), utf8.size(), &result);
+    return result;
+}
+
+bool utils::WideToUTF8(const char16* src, size_t length, std::string* output) {
+    bool valid = true;
+    output->clear();
+    AppendWideAsUTF8(src, length, false, output, &valid);
+    return valid;
+}
+
+std::string utils::WideToUTF8(std::basic_string_view<char16> wide) {
+    std::string result;
+    WideToUTF8(wide.data(), wide.size(), &result);
+    return result;
+}
+
+size_t utils::UTF8ToWideLength(std::string_view utf8) {
+    bool valid = true;
+    WideSink counter(nullptr);
+    DecodeUTF8Into(utf8.data(), utf8.size(), false, &counter, &valid);
+    return counter.size();
+}
+
+size_t utils::WideToUTF8Length(std::basic_string_view<char16> wide) {
+    bool valid = true;
+    UTF8Sink counter(nullptr);
+    DecodeWideInto(wide.data(), wide.size(), false, &counter, &valid);
+    return counter.size();
+}
+
+bool utils::IsStringUTF8(std::string_view str) {
+    bool valid = true;
+    WideSink counter(nullptr);
+    DecodeUTF8Into(str.data(), str.size(), false, &counter, &valid);
+    return valid;
+}
+
+bool utils::IsStringASCII(std::string_view str) {
+    return TranscodeKernels::Get().widen(str.data(), str.size(), 0x80, nullptr) == str.size();
+}
+
+bool utils::IsStringASCII(std::basic_string_view<char16> str) {
+    return TranscodeKernels::Get().narrow(str.data(), str.size(), 0x80, nullptr) == str.size();
+}
+
+std::wstring utils::Latin1ToWide(std::string_view latin1) {
+    std::wstring result;
+    result.resize(latin1.size());
+    if (!latin1.empty()) TranscodeKernels::Get().widen(latin1.data(), latin1.size(), 0x100, &result[0]);
+    return result;
+}
+
+std::string utils::Latin1ToUTF8(std::string_view latin1) {
+    UTF8Sink counter(nullptr);
+    EncodeLatin1Into(latin1, &counter);
+    std::string result;
+    if (!counter.size()) return result;
+    result.resize(counter.size());
+    UTF8Sink writer(&result[0]);
+    EncodeLatin1Into(latin1, &writer);
+    return result;
+}
+
+bool utils::WideToLatin1(std::basic_string_view<char16> wide, std::string* latin1) {
+    std::string output;
+    output.resize(wide.size());
+    latin1->clear();
+    if (!wide.empty() &&
+        TranscodeKernels::Get().narrow(wide.data(), wide.size(), 0x100, &output[0]) != wide.size())
+        return false;
+    latin1->swap(output);
+    return true;
+}
+
+bool utils::UTF8ToLatin1(std::string_view utf8, std::string* latin1) {
+    latin1->clear();
+    bool valid = true;
+    Latin1Sink counter(nullptr);
+    DecodeUTF8Into(utf8.data(), utf8.size(), false, &counter, &valid);
+    if (!valid || !counter.fits()) return false;
+    if (!counter.size()) return true;
+
+    latin1->resize(counter.size());
+    Latin1Sink writer(&(*latin1)[0]);
+    DecodeUTF8Into(utf8.data(), utf8.size(), false, &writer, &valid);
+    return true;
+}
+
+bool utils::UTF8StreamDecoder::Decode(std::string_view chunk, std::wstring* output) {
+    // Complete the sequence held back from the previous chunk one byte at a
+    // time. A byte that turns out not to belong to it is decoded again below.
+    size_t consumed = 0;
+    while (pending_size_ && consumed < chunk.size()) {
+        pending_[pending_size_++] = chunk[consumed++];
+        size_t index = 0;
+        uint32 code_point = DecodeUTF8(pending_, pending_size_, &index);
+        if (code_point == kIncomplete) continue;
+        if (code_point == kInvalid) {
+            valid_ = false;
+            code_point = kReplacementCharacter;
+        }
+        consumed -= pending_size_ - index;
+        pending_size_ = 0;
+
+        char16 units[2];
+        WideSink sink(units);
+        sink.Put(code_point);
+        output->append(units, sink.size());
+    }
+
+    const char* rest = chunk.data() + consumed;
+    const size_t rest_size = chunk.size() - consumed;
+    const size_t used = AppendUTF8AsWide(rest, rest_size, true, output, &valid_);
+    memcpy(pending_ + pending_size_, rest + used, rest_size - used);
+    pending_size_ += rest_size - used;
+    return valid_;
+}
+
+bool utils::UTF8StreamDecoder::Finish(std::wstring* output) {
+    if (pending_size_) {
+        valid_ = false;
+        output->push_back(static_cast<char16>(kReplacementCharacter));
+        pending_size_ = 0;
+    }
+    const bool valid = valid_;
+    valid_ = true;
+    return valid;
+}
+
+bool utils::UTF8StreamEncoder::Encode(std::basic_string_view<char16> chunk, std::string* output) {
+    size_t consumed = 0;
+    if (has_pending_ && !chunk.empty()) {
+        const char16 pair[2] = { pending_, chunk[0] };
+        size_t index = 0;
+        uint32 code_point = DecodeWide(pair, 2, &index);
+        if (code_point == kInvalid) {
+            valid_ = false;
+            code_point = kReplacementCharacter;
+        }
+        consumed = index - 1;
+        has_pending_ = false;
+
+        char bytes[4];
+        UTF8Sink sink(bytes);
+        sink.Put(code_point);
+        output->append(bytes, sink.size());
+    }
+
+    const char16* rest = chunk.data() + consumed;
+    const size_t rest_size = chunk.size() - consumed;
+    const size_t used = AppendWideAsUTF8(rest, rest_size, true, output, &valid_);
+    if (used < rest_size) {
+        pending_ = rest[used];
+        has_pending_ = true;
+    }
+    return valid_;
+}
+
+bool utils::UTF8StreamEncoder::Finish(std::string* output) {
+    if (has_pending_) {
+        valid_ = false;
+        output->append("\xEF\xBF\xBD");
+        has_pending_ = false;
+    }
+    const bool valid = valid_;
+    valid_ = true;
+    return valid;
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_UTF_STRING_CONVERSIONS_INCLUDE_H_
+#define UTILS_STRINGS_UTF_STRING_CONVERSIONS_INCLUDE_H_
+
+#include <string>
+#include <string_view>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+// Conversions between UTF-8, wide strings and Latin-1. Wide strings are UTF-16
+// where wchar_t is 16 bits (Windows) and UTF-32 elsewhere.
+//
+// Invalid input - malformed or overlong UTF-8, unpaired surrogates, values
+// above U+10FFFF - is replaced with U+FFFD, one per maximal invalid
+// subsequence, and makes the conversion return false. The output length is
+// computed exactly before anything is written, so each result is allocated
+// once. Runs of ASCII are converted 16 or 32 characters at a time with
+// SSE2/AVX2.
+namespace utils {
+
+UTILS_API bool UTF8ToWide(const char* src, size_t length, std::wstring* output);
+UTILS_API std::wstring UTF8ToWide(std::string_view utf8);
+UTILS_API bool WideToUTF8(const char16* src, size_t length, std::string* output);
+UTILS_API std::string WideToUTF8(std::basic_string_view<char16> wide);
+
+// Return the length the conversions above produce, without converting.
+UTILS_API size_t UTF8ToWideLength(std::string_view utf8);
+UTILS_API size_t WideToUTF8Length(std::basic_string_view<char16> wide);
+
+UTILS_API bool IsStringUTF8(std::string_view str);
+UTILS_API bool IsStringASCII(std::string_view str);
+UTILS_API bool IsStringASCII(std::basic_string_view<char16> str);
+
+// Latin-1 (ISO-8859-1) maps the bytes 0x00-0xFF onto U+0000-U+00FF, so these
+// directions always succeed.
+UTILS_API std::wstring Latin1ToWide(std::string_view latin1);
+UTILS_API std::string Latin1ToUTF8(std::string_view latin1);
+
+// Fail, leaving |latin1| empty, if the input is invalid or holds a character
+// above U+00FF.
+UTILS_API bool WideToLatin1(std::basic_string_view<char16> wide, std::string* latin1);
+UTILS_API bool UTF8ToLatin1(std::string_view utf8, std::string* latin1);
+
+// Converts UTF-8 that arrives in chunks, e.g. from a file or socket. A
+// sequence split between two chunks is held back until the rest of it
+// arrives, so the output is the same as UTF8ToWide() on the whole input.
+class UTILS_API UTF8StreamDecoder {
+public:
+    UTF8StreamDecoder() {}
+
+    // Appends the wide form of |chunk| to |*output|. Returns false once
+    // invalid input has been seen.
+    bool Decode(std::string_view chunk, std::wstring* output);
+
+    // Ends the stream; a sequence still held back becomes U+FFFD. Returns
+    // whether the whole stream was valid and readies the decoder for a new
+    // one.
+    bool Finish(std::wstring* output);
+
+private:
+    char pending_[4];
+    size_t pending_size_ = 0;
+    bool valid_ = true;
+
+    DISALLOW_COPY_AND_ASSIGN(UTF8StreamDecoder);
+};
+
+// The reverse of UTF8StreamDecoder: a surrogate pair split between two chunks
+// is held back until its second half arrives.
+class UTILS_API UTF8StreamEncoder {
+public:
+    UTF8StreamEncoder() {}
+
+    bool Encode(std::basic_string_view<char16> chunk, std::string* output);
+    bool Finish(std::string* output);
+
+private:
+    char16 pending_ = 0;
+    bool has_pending_ = false;
+    bool valid_ = true;
+
+    DISALLOW_COPY_AND_ASSIGN(UTF8StreamEncoder);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_UTF_STRING_CONVERSIONS_INCLUDE_H_
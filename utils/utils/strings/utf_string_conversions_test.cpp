@@ -0,0 +1,96 @@
+#include <Windows.h>
+#include "utils/strings/utf_string_conversions.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+namespace {
+
+// The per-character loop x::WideToLatin1() used to run.
+bool WideToLatin1Reference(const std::wstring& wide, std::string* latin1) {
+    std::string output;
+    output.resize(wide.size());
+    latin1->clear();
+    for (size_t i = 0; i < wide.size(); i++) {
+        if (wide[i] > 255) return false;
+        output[i] = static_cast<char>(wide[i]);
+    }
+    latin1->swap(output);
+    return true;
+}
+
+}  // namespace
+
+int UTF_STRING_CONVERSIONS_TEST(void) {
+    // ASCII, Latin-1, BMP and a supplementary character, long enough to run
+    // through the vector loops too.
+    const std::string utf8 = "plain ascii text that spans more than one register \xC3\xA9t\xC3\xA9 \xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80!";
+    const std::wstring wide = utils::UTF8ToWide(utf8);
+    if (!utils::IsStringUTF8(utf8) || utils::IsStringASCII(utf8)) __debugbreak();
+    if (wide.size() != utils::UTF8ToWideLength(utf8)) __debugbreak();
+    if (utils::WideToUTF8(wide) != utf8 || utils::WideToUTF8Length(wide) != utf8.size()) __debugbreak();
+    if (wide.find(L"\x00E9t\x00E9 \x4E2D\x6587") == std::wstring::npos) __debugbreak();
+
+    // One U+FFFD per maximal invalid subsequence: a truncated sequence, an
+    // overlong form, a surrogate and a stray continuation byte.
+    std::wstring repaired;
+    if (utils::UTF8ToWide("a\xE4\xB8" "b\xC0\xAF" "c\xED\xA0\x80" "d\x80", 12, &repaired)) __debugbreak();
+    if (repaired != L"a\xFFFD" L"b\xFFFD\xFFFD" L"c\xFFFD\xFFFD\xFFFD" L"d\xFFFD") __debugbreak();
+    if (utils::IsStringUTF8("\xF4\x90\x80\x80")) __debugbreak();
+
+    // Chunked input gives the same result wherever the chunks are cut.
+    for (size_t cut = 0; cut <= utf8.size(); ++cut) {
+        utils::UTF8StreamDecoder decoder;
+        std::wstring streamed;
+        decoder.Decode(std::string_view(utf8).substr(0, cut), &streamed);
+        decoder.Decode(std::string_view(utf8).substr(cut), &streamed);
+        if (!decoder.Finish(&streamed) || streamed != wide) __debugbreak();
+    }
+    for (size_t cut = 0; cut <= wide.size(); ++cut) {
+        utils::UTF8StreamEncoder encoder;
+        std::string streamed;
+        encoder.Encode(std::wstring_view(wide).substr(0, cut), &streamed);
+        encoder.Encode(std::wstring_view(wide).substr(cut), &streamed);
+        if (!encoder.Finish(&streamed) || streamed != utf8) __debugbreak();
+    }
+    utils::UTF8StreamDecoder truncated;
+    std::wstring tail;
+    truncated.Decode("ok\xE2\x82", &tail);
+    if (truncated.Finish(&tail) || tail != L"ok\xFFFD") __debugbreak();
+
+    // Latin-1 round trips, and matches the old narrowing loop.
+    std::string latin1, expected;
+    const std::wstring latin1_wide = L"caf\x00E9 na\x00EFve \x00FF and some more ASCII to fill a register";
+    if (!x::WideToLatin1(latin1_wide, &latin1) || !WideToLatin1Reference(latin1_wide, &expected)) __debugbreak();
+    if (latin1 != expected || utils::Latin1ToWide(latin1) != latin1_wide) __debugbreak();
+    if (utils::Latin1ToUTF8(latin1) != utils::WideToUTF8(latin1_wide)) __debugbreak();
+    std::string back;
+    if (!utils::UTF8ToLatin1(utils::Latin1ToUTF8(latin1), &back) || back != latin1) __debugbreak();
+    if (x::WideToLatin1(L"\x0100", &latin1) || !latin1.empty()) __debugbreak();
+    if (utils::UTF8ToLatin1("\xE4\xB8\xAD", &latin1)) __debugbreak();
+    return 0;
+}
+
+// Converts mostly-ASCII text, as found in paths, logs and markup, back and
+// forth, and narrows it to Latin-1 with the old loop and the vector kernel.
+int UTF_STRING_CONVERSIONS_BENCHMARK(void) {
+    std::string utf8;
+    const std::string line = "C:\\Users\\Public\\Documents\\r\xC3\xA9sum\xC3\xA9-2018.docx opened by worker 7\r\n";
+    while (utf8.size() < 16 * 1024 * 1024) utf8 += line;
+
+    std::wstring wide;
+    std::string narrow;
+    auto decode = TimeMicroseconds([&]() { utils::UTF8ToWide(utf8.data(), utf8.size(), &wide); });
+    auto encode = TimeMicroseconds([&]() { utils::WideToUTF8(wide.data(), wide.size(), &narrow); });
+    auto scalar_latin1 = TimeMicroseconds([&]() { WideToLatin1Reference(wide, &narrow); });
+    auto vector_latin1 = TimeMicroseconds([&]() { x::WideToLatin1(wide, &narrow); });
+
+    std::cout << "UTF8ToWide " << decode << "us, WideToUTF8 " << encode << "us for " << utf8.size() << " bytes" << std::endl;
+    std::cout << "WideToLatin1: scalar " << scalar_latin1 << "us, vector " << vector_latin1 << "us" << std::endl;
+    return narrow.empty() ? 1 : 0;
+}
+
+#endif // TEST
@@ -0,0 +1,289 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/strings/whitespace.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "utils/cpu.h"
+#include "utils/simd.h"
+
+namespace {
+
+using utils::WhitespaceSet;
+using utils::WHITESPACE_TRIM;
+using utils::WHITESPACE_COLLAPSE;
+using utils::WHITESPACE_ASCII;
+
+const wchar_t kUnicodeWhitespace[] = { WHITESPACE_UNICODE };
+
+inline bool IsUnicodeWhitespace(wchar_t c) {
+    for (size_t i = 0; i + 1 < arraysize(kUnicodeWhitespace); ++i) {
+        if (c == kUnicodeWhitespace[i]) return true;
+    }
+    return false;
+}
+
+template <typename Char, WhitespaceSet kSet>
+inline bool IsWhitespaceScalar(Char c) {
+    if (kSet == WHITESPACE_ASCII) return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+    if (kSet == WHITESPACE_TRIM && sizeof(Char) == 1) return (c >= 0x09 && c <= 0x0D) || c == ' ';
+    if (kSet == WHITESPACE_COLLAPSE && c == 0) return true;
+    // Same conversion as the IsWhitespace(wchar_t) call this replaces.
+    return IsUnicodeWhitespace(static_cast<wchar_t>(c));
+}
+
+// Whether |kSet| holds characters above 0x7F for this code unit. For char it
+// only does when char is unsigned, because IsWhitespace() widens the byte.
+template <typename Char, WhitespaceSet kSet>
+inline bool HasNonASCIIWhitespace() {
+    if (kSet == WHITESPACE_ASCII) return false;
+    if (sizeof(Char) > 1) return true;
+    return kSet == WHITESPACE_COLLAPSE && std::is_unsigned<char>::value;
+}
+
+template <typename Char, WhitespaceSet kSet>
+size_t FindFirstScalar(const Char* str, size_t length, bool want_whitespace) {
+    for (size_t i = 0; i < length; ++i) {
+        if (IsWhitespaceScalar<Char, kSet>(str[i]) == want_whitespace) return i;
+    }
+    return length;
+}
+
+template <typename Char, WhitespaceSet kSet>
+size_t FindLastNonWhitespaceScalar(const Char* str, size_t length) {
+    for (size_t i = length; i > 0; --i) {
+        if (!IsWhitespaceScalar<Char, kSet>(str[i - 1])) return i - 1;
+    }
+    return length;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// Builds a movemask-style mask, sizeof(Char) bits per character, for a block
+// that the vector compare cannot classify on its own.
+template <typename Char, WhitespaceSet kSet>
+uint32 WhitespaceMaskScalar(const Char* block, size_t lanes) {
+    const uint32 lane_bits = (1u << sizeof(Char)) - 1;
+    uint32 mask = 0;
+    for (size_t i = 0; i < lanes; ++i) {
+        if (IsWhitespaceScalar<Char, kSet>(block[i])) mask |= lane_bits << (i * sizeof(Char));
+    }
+    return mask;
+}
+
+TARGET_ISA("sse2") inline __m128i NonASCII128(__m128i v, char) { return v; }
+TARGET_ISA("sse2") inline __m128i NonASCII128(__m128i v, char16) {
+    return utils::simd::InRange128(v, char16(0x80), char16(0xFF80));
+}
+TARGET_ISA("avx2") inline __m256i NonASCII256(__m256i v, char) { return v; }
+TARGET_ISA("avx2") inline __m256i NonASCII256(__m256i v, char16) {
+    return utils::simd::InRange256(v, char16(0x80), char16(0xFF80));
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("sse2") inline uint32 WhitespaceMask128(const Char* block) {
+    using namespace utils::simd;
+    const __m128i v = Load128(block);
+    __m128i hits = Equal128(v, Broadcast128(Char(' ')), Char());
+    if (kSet == WHITESPACE_ASCII) {
+        hits = _mm_or_si128(hits, Equal128(v, Broadcast128(Char('\t')), Char()));
+        hits = _mm_or_si128(hits, Equal128(v, Broadcast128(Char('\n')), Char()));
+        hits = _mm_or_si128(hits, Equal128(v, Broadcast128(Char('\r')), Char()));
+    } else {
+        hits = _mm_or_si128(hits, InRange128(v, Char(0x09), Char(5)));
+        if (kSet == WHITESPACE_COLLAPSE) hits = _mm_or_si128(hits, Equal128(v, _mm_setzero_si128(), Char()));
+    }
+    if (HasNonASCIIWhitespace<Char, kSet>() && MoveMask128(NonASCII128(v, Char())))
+        return WhitespaceMaskScalar<Char, kSet>(block, Lanes<Char>::k128);
+    return MoveMask128(hits);
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("avx2") inline uint32 WhitespaceMask256(const Char* block) {
+    using namespace utils::simd;
+    const __m256i v = Load256(block);
+    __m256i hits = Equal256(v, Broadcast256(Char(' ')), Char());
+    if (kSet == WHITESPACE_ASCII) {
+        hits = _mm256_or_si256(hits, Equal256(v, Broadcast256(Char('\t')), Char()));
+        hits = _mm256_or_si256(hits, Equal256(v, Broadcast256(Char('\n')), Char()));
+        hits = _mm256_or_si256(hits, Equal256(v, Broadcast256(Char('\r')), Char()));
+    } else {
+        hits = _mm256_or_si256(hits, InRange256(v, Char(0x09), Char(5)));
+        if (kSet == WHITESPACE_COLLAPSE) hits = _mm256_or_si256(hits, Equal256(v, _mm256_setzero_si256(), Char()));
+    }
+    if (HasNonASCIIWhitespace<Char, kSet>() && MoveMask256(NonASCII256(v, Char())))
+        return WhitespaceMaskScalar<Char, kSet>(block, Lanes<Char>::k256);
+    return MoveMask256(hits);
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("sse2") size_t FindFirstSSE2(const Char* str, size_t length, bool want_whitespace) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k128;
+    const uint32 flip = want_whitespace ? 0 : 0xFFFF;
+    size_t i = 0;
+    for (; i + kLanes <= length; i += kLanes) {
+        const uint32 mask = WhitespaceMask128<Char, kSet>(str + i) ^ flip;
+        if (mask) return i + LowestSetBit(mask) / sizeof(Char);
+    }
+    return i + FindFirstScalar<Char, kSet>(str + i, length - i, want_whitespace);
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("sse2") size_t FindLastNonWhitespaceSSE2(const Char* str, size_t length) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k128;
+    size_t end = length;
+    for (; end >= kLanes; end -= kLanes) {
+        const uint32 mask = WhitespaceMask128<Char, kSet>(str + end - kLanes) ^ 0xFFFF;
+        if (mask) return end - kLanes + HighestSetBit(mask) / sizeof(Char);
+    }
+    const size_t found = FindLastNonWhitespaceScalar<Char, kSet>(str, end);
+    return found == end ? length : found;
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("avx2") size_t FindFirstAVX2(const Char* str, size_t length, bool want_whitespace) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k256;
+    const uint32 flip = want_whitespace ? 0 : 0xFFFFFFFF;
+    size_t i = 0;
+    for (; i + kLanes <= length; i += kLanes) {
+        const uint32 mask = WhitespaceMask256<Char, kSet>(str + i) ^ flip;
+        if (mask) return i + LowestSetBit(mask) / sizeof(Char);
+    }
+    _mm256_zeroupper();
+    return i + FindFirstSSE2<Char, kSet>(str + i, length - i, want_whitespace);
+}
+
+template <typename Char, WhitespaceSet kSet>
+TARGET_ISA("avx2") size_t FindLastNonWhitespaceAVX2(const Char* str, size_t length) {
+    using namespace utils::simd;
+    const size_t kLanes = Lanes<Char>::k256;
+    size_t end = length;
+    for (; end >= kLanes; end -= kLanes) {
+        const uint32 mask = WhitespaceMask256<Char, kSet>(str + end - kLanes) ^ 0xFFFFFFFF;
+        if (mask) return end - kLanes + HighestSetBit(mask) / sizeof(Char);
+    }
+    _mm256_zeroupper();
+    const size_t found = FindLastNonWhitespaceSSE2<Char, kSet>(str, end);
+    return found == end ? length : found;
+}
+
+#endif  // ARCH_CPU_X86_FAMILY
+
+template <typename Char, WhitespaceSet kSet>
+struct WhitespaceKernels {
+    size_t (*find_first)(const Char*, size_t, bool);
+    size_t (*find_last_non_whitespace)(const Char*, size_t);
+
+    // wchar_t is 32 bits wide outside Windows, where only the scalar loops
+    // exist.
+    static WhitespaceKernels Select() {
+#if defined(ARCH_CPU_X86_FAMILY)
+        if (sizeof(Char) <= 2) {
+            const utils::CPU& cpu = utils::CPU::Get();
+            if (cpu.has_avx2()) return { &FindFirstAVX2<Char, kSet>, &FindLastNonWhitespaceAVX2<Char, kSet> };
+            if (cpu.has_sse2()) return { &FindFirstSSE2<Char, kSet>, &FindLastNonWhitespaceSSE2<Char, kSet> };
+        }
+#endif
+        return { &FindFirstScalar<Char, kSet>, &FindLastNonWhitespaceScalar<Char, kSet> };
+    }
+
+    static const WhitespaceKernels& Get() {
+        static const WhitespaceKernels kernels = Select();
+        return kernels;
+    }
+};
+
+template <typename Char>
+size_t FindFirst(const Char* str, size_t length, WhitespaceSet set, bool want_whitespace) {
+    switch (set) {
+    case WHITESPACE_TRIM:
+        return WhitespaceKernels<Char, WHITESPACE_TRIM>::Get().find_first(str, length, want_whitespace);
+    case WHITESPACE_COLLAPSE:
+        return WhitespaceKernels<Char, WHITESPACE_COLLAPSE>::Get().find_first(str, length, want_whitespace);
+    default:
+        return WhitespaceKernels<Char, WHITESPACE_ASCII>::Get().find_first(str, length, want_whitespace);
+    }
+}
+
+template <typename Char>
+size_t FindLastNonWhitespaceT(const Char* str, size_t length, WhitespaceSet set) {
+    switch (set) {
+    case WHITESPACE_TRIM:
+        return WhitespaceKernels<Char, WHITESPACE_TRIM>::Get().find_last_non_whitespace(str, length);
+    case WHITESPACE_COLLAPSE:
+        return WhitespaceKernels<Char, WHITESPACE_COLLAPSE>::Get().find_last_non_whitespace(str, length);
+    default:
+        return WhitespaceKernels<Char, WHITESPACE_ASCII>::Get().find_last_non_whitespace(str, length);
+    }
+}
+
+template <typename Char>
+inline bool IsLineBreak(Char c) {
+    return c == '\n' || c == '\r';
+}
+
+// Alternates between copying a word and skipping the whitespace after it.
+// Leading and trailing runs produce nothing; any other run produces one space,
+// unless |trim_sequences_with_line_breaks| is set and it holds CR or LF.
+template <typename Char>
+size_t CollapseWhitespaceT(const Char* src, size_t length, bool trim_sequences_with_line_breaks, Char* dst) {
+    const WhitespaceKernels<Char, WHITESPACE_COLLAPSE>& kernels = WhitespaceKernels<Char, WHITESPACE_COLLAPSE>::Get();
+    size_t written = 0;
+    size_t word = kernels.find_first(src, length, false);
+    while (word < length) {
+        const size_t space = word + kernels.find_first(src + word, length - word, true);
+        std::copy(src + word, src + space, dst + written);
+        written += space - word;
+        if (space == length) break;
+
+        const size_t next = space + kernels.find_first(src + space, length - space, false);
+        if (next == length) break;
+        if (!trim_sequences_with_line_breaks || std::find_if(src + space, src + next, &IsLineBreak<Char>) == src + next)
+            dst[written++] = ' ';
+        word = next;
+    }
+    return written;
+}
+
+}  // namespace
+
+size_t utils::internal::FindFirstWhitespace(const char* str, size_t length, WhitespaceSet set) {
+    return FindFirst(str, length, set, true);
+}
+
+size_t utils::internal::FindFirstWhitespace(const char16* str, size_t length, WhitespaceSet set) {
+    return FindFirst(str, length, set, true);
+}
+
+size_t utils::internal::FindFirstNonWhitespace(const char* str, size_t length, WhitespaceSet set) {
+    return FindFirst(str, length, set, false);
+}
+
+size_t utils::internal::FindFirstNonWhitespace(const char16* str, size_t length, WhitespaceSet set) {
+    return FindFirst(str, length, set, false);
+}
+
+size_t utils::internal::FindLastNonWhitespace(const char* str, size_t length, WhitespaceSet set) {
+    return FindLastNonWhitespaceT(str, length, set);
+}
+
+size_t utils::internal::FindLastNonWhitespace(const char16* str, size_t length, WhitespaceSet set) {
+    return FindLastNonWhitespaceT(str, length, set);
+}
+
+size_t utils::internal::CollapseWhitespace(const char* src, size_t length, bool trim_sequences_with_line_breaks, char* dst) {
+    return CollapseWhitespaceT(src, length, trim_sequences_with_line_breaks, dst);
+}
+
+size_t utils::internal::CollapseWhitespace(const char16* src, size_t length, bool trim_sequences_with_line_breaks, char16* dst) {
+    return CollapseWhitespaceT(src, length, trim_sequences_with_line_breaks, dst);
+}
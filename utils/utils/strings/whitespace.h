@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_STRINGS_WHITESPACE_INCLUDE_H_
+#define UTILS_STRINGS_WHITESPACE_INCLUDE_H_
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// The whitespace definitions stl_util.h has always used. They differ in small
+// ways and each caller keeps its own, so the vectorized paths give the same
+// results as the character loops they replace.
+enum WhitespaceSet {
+    // kWhitespaceASCII for char and kWhitespaceUTF16 for char16 strings; used
+    // by TrimWhitespace() and ContainsOnlyWhitespace().
+    WHITESPACE_TRIM,
+    // IsWhitespace(), used by CollapseWhitespace(). Same as WHITESPACE_TRIM,
+    // except that NUL counts too because wcschr() finds the terminator.
+    WHITESPACE_COLLAPSE,
+    // IsAsciiWhitespace(): tab, LF, CR and space only.
+    WHITESPACE_ASCII,
+};
+
+namespace internal {
+
+// Return the offset of the first character of [str, str + length) that is
+// (FindFirstWhitespace) or is not (FindFirstNonWhitespace) in |set|, or
+// |length| when there is none. ASCII characters are classified 16 or 32 at a
+// time with SSE2/AVX2; only blocks holding non-ASCII UTF-16 fall back to the
+// character loop.
+UTILS_API size_t FindFirstWhitespace(const char* str, size_t length, WhitespaceSet set);
+UTILS_API size_t FindFirstWhitespace(const char16* str, size_t length, WhitespaceSet set);
+UTILS_API size_t FindFirstNonWhitespace(const char* str, size_t length, WhitespaceSet set);
+UTILS_API size_t FindFirstNonWhitespace(const char16* str, size_t length, WhitespaceSet set);
+
+// Returns the offset of the last character that is not in |set|, or |length|
+// when there is none.
+UTILS_API size_t FindLastNonWhitespace(const char* str, size_t length, WhitespaceSet set);
+UTILS_API size_t FindLastNonWhitespace(const char16* str, size_t length, WhitespaceSet set);
+
+// Writes |src| to |dst| with WHITESPACE_COLLAPSE runs handled the way
+// x::CollapseWhitespace() documents, and returns the number of characters
+// written. The result is never longer than the input, so |dst| needs room for
+// |length| characters; it may not overlap |src|. Whole words are copied at
+// once instead of character by character.
+UTILS_API size_t CollapseWhitespace(const char* src, size_t length, bool trim_sequences_with_line_breaks, char* dst);
+UTILS_API size_t CollapseWhitespace(const char16* src, size_t length, bool trim_sequences_with_line_breaks, char16* dst);
+
+} // namespace internal
+} // namespace utils
+
+#endif  // !UTILS_STRINGS_WHITESPACE_INCLUDE_H_
@@ -0,0 +1,94 @@
+#include <Windows.h>
+#include "utils/strings/whitespace.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <iostream>
+
+#ifdef TEST
+
+namespace {
+
+// The character loop CollapseWhitespaceT() used before the vectorized scan.
+template <typename STR>
+STR CollapseWhitespaceReference(const STR& text, bool trim_sequences_with_line_breaks) {
+    STR result;
+    bool in_whitespace = true;
+    bool already_trimmed = true;
+    for (auto c : text) {
+        if (IsWhitespace(c)) {
+            if (!in_whitespace) {
+                in_whitespace = true;
+                result.push_back(' ');
+            }
+            if (trim_sequences_with_line_breaks && !already_trimmed && (c == '\n' || c == '\r')) {
+                already_trimmed = true;
+                result.pop_back();
+            }
+        } else {
+            in_whitespace = false;
+            already_trimmed = false;
+            result.push_back(c);
+        }
+    }
+    if (in_whitespace && !already_trimmed) result.pop_back();
+    return result;
+}
+
+}  // namespace
+
+int WHITESPACE_TEST(void) {
+    const std::string samples[] = {
+        "", " ", "\t\r\n", "word", "  leading", "trailing \t ", " \v both\f ",
+        "one  two\t\tthree", "line\r\nbreak", " a \n b \x0B c ", std::string("nul\0inside", 10),
+        "a run of text that is longer than one 32 byte register, with  gaps \r\n and \t tabs   ",
+    };
+    for (const std::string& sample : samples) {
+        std::string expected, trimmed;
+        const bool expected_trimmed = x::TrimString(sample, kWhitespaceASCII, &expected);
+        const bool was_trimmed = x::TrimWhitespaceASCII(sample, TRIM_ALL, &trimmed) != TRIM_NONE;
+        if (trimmed != expected || was_trimmed != expected_trimmed) __debugbreak();
+        if (x::CollapseWhitespaceASCII(sample, true) != CollapseWhitespaceReference(sample, true)) __debugbreak();
+        if (x::CollapseWhitespaceASCII(sample, false) != CollapseWhitespaceReference(sample, false)) __debugbreak();
+
+        bool only_whitespace = true;
+        for (char c : sample) only_whitespace = only_whitespace && IsAsciiWhitespace(c);
+        if (x::ContainsOnlyWhitespaceASCII(sample) != only_whitespace) __debugbreak();
+    }
+
+    const std::wstring wide = L"\x3000 ideographic\x00A0no-break\x2028" L"separated \x2029\r\n ";
+    std::wstring trimmed;
+    if (x::TrimWhitespace(wide, TRIM_TRAILING, &trimmed) != TRIM_TRAILING) __debugbreak();
+    if (trimmed != L"\x3000 ideographic\x00A0no-break\x2028separated") __debugbreak();
+    if (x::CollapseWhitespace(wide, true) != CollapseWhitespaceReference(wide, true)) __debugbreak();
+    if (!x::ContainsOnlyWhitespace(std::wstring(L"\x2000\x2001 \x3000\t"))) __debugbreak();
+    return 0;
+}
+
+// Collapses and trims a 16MB block of loosely formatted text with the old
+// character loop and with the vectorized scans.
+int WHITESPACE_BENCHMARK(void) {
+    std::string text;
+    const std::string paragraph = "    The quick  brown fox\tjumps over the lazy dog;   "
+                                  "indentation_and_long_identifiers_are_common_in_source_files \r\n";
+    while (text.size() < 16 * 1024 * 1024) text += paragraph;
+
+    size_t sizes = 0;
+    auto scalar_collapse = TimeMicroseconds([&]() { sizes += CollapseWhitespaceReference(text, true).size(); });
+    auto vector_collapse = TimeMicroseconds([&]() { sizes += x::CollapseWhitespaceASCII(text, true).size(); });
+
+    const std::string padded = std::string(4096, ' ') + paragraph + std::string(4096, '\t');
+    std::string trimmed;
+    auto scalar_trim = TimeMicroseconds([&]() {
+        for (int i = 0; i < 10000; ++i) sizes += x::TrimString(padded, kWhitespaceASCII, &trimmed);
+    });
+    auto vector_trim = TimeMicroseconds([&]() {
+        for (int i = 0; i < 10000; ++i) sizes += x::TrimWhitespaceASCII(padded, TRIM_ALL, &trimmed);
+    });
+
+    std::cout << "CollapseWhitespace: scalar " << scalar_collapse << "us, vector " << vector_collapse << "us" << std::endl;
+    std::cout << "TrimWhitespace: scalar " << scalar_trim << "us, vector " << vector_trim << "us" << std::endl;
+    return sizes ? 0 : 1;
+}
+
+#endif // TEST
@@ -0,0 +1,29 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_TEST_UTIL_INCLUDE_H_
+#define UTILS_TEST_UTIL_INCLUDE_H_
+
+#ifdef TEST
+
+#include <chrono>
+
+// Helpers shared by the *_test.cpp files.
+
+// Runs |function| once and returns the wall time it took, for the
+// *_BENCHMARK functions.
+template <typename Function>
+long long TimeMicroseconds(Function function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif // TEST
+
+#endif  // !UTILS_TEST_UTIL_INCLUDE_H_
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http://ant.sh). All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+
+utils::ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i) threads_.emplace_back(&ThreadPool::ThreadMain, this);
+}
+
+utils::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        quit_ = true;
+    }
+    start_.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+}
+
+void utils::ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count <= 1 || threads_.empty()) {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(run_lock_);
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        task_ = &task;
+        count_ = count;
+        next_ = 0;
+        running_ = threads_.size();
+        ++generation_;
+    }
+    start_.notify_all();
+    RunTasks();
+
+    std::unique_lock<std::mutex> lock(lock_);
+    done_.wait(lock, [this]() { return running_ == 0; });
+    task_ = nullptr;
+}
+
+utils::ThreadPool& utils::ThreadPool::Default() {
+    static ThreadPool* pool = new ThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+    return *pool;
+}
+
+void utils::ThreadPool::ThreadMain() {
+    uint64 generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            start_.wait(lock, [this, generation]() { return quit_ || generation_ != generation; });
+            if (quit_) return;
+            generation = generation_;
+        }
+        RunTasks();
+        std::lock_guard<std::mutex> lock(lock_);
+        if (--running_ == 0) done_.notify_one();
+    }
+}
+
+void utils::ThreadPool::RunTasks() {
+    for (size_t i = next_++; i < count_; i = next_++) (*task_)(i);
+}
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_THREAD_POOL_INCLUDE_H_
+#define UTILS_THREAD_POOL_INCLUDE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+#include "utils/basictypes.h"
+
+namespace utils {
+
+// A fixed set of threads for fork-join loops, such as the parallel container
+// algorithms in utils/containers/parallel_algorithm.h. The thread calling
+// ParallelFor() runs tasks too, so a pool of size() N starts N - 1 threads,
+// and a pool of size 1 runs everything inline.
+class UTILS_API ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    size_t size() const { return threads_.size() + 1; }
+
+    // Calls |task| with each index in [0, |count|) on the pool and the calling
+    // thread, and returns when all calls have returned. Calls from different
+    // threads take turns; |task| must not call ParallelFor() on the same pool.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Returns the process-wide pool with one thread per logical processor.
+    // It is never destroyed, so no thread is joined while the loader lock is
+    // held at DLL unload.
+    static ThreadPool& Default();
+
+private:
+    void ThreadMain();
+    void RunTasks();
+
+    std::vector<std::thread> threads_;
+
+    // Serializes ParallelFor() callers.
+    std::mutex run_lock_;
+
+    // Guards the fields below and the start of each loop.
+    std::mutex lock_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{ 0 };
+    size_t running_ = 0;
+    uint64 generation_ = 0;
+    bool quit_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+} // namespace utils
+
+#endif  // !UTILS_THREAD_POOL_INCLUDE_H_
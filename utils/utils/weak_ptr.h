@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2018 The Authors of ANT(http:://ant.sh) . All Rights Reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef UTILS_WEAK_PTR_INCLUDE_H_
+#define UTILS_WEAK_PTR_INCLUDE_H_
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "utils/scoped_ref_object.h"
+
+// Weak pointers hold a reference to an object without keeping it alive. An
+// object hands them out from a WeakPtrFactory member, declared last so that
+// they go invalid before any other member is destroyed:
+//
+//   class Controller : public RefObject<Controller> {
+//   public:
+//       Controller() : weak_factory_(this) {}
+//       WeakPtr<Controller> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+//
+//   private:
+//       WeakPtrFactory<Controller> weak_factory_;
+//   };
+//
+// A factory and all its weak pointers share one reference-counted flag, made
+// when the first pointer is handed out. Invalidating clears the flag and
+// drops it, whatever the number of pointers, and get() reads it without a
+// lock. Since a valid pointer only stays valid until the owner next runs,
+// get(), dereferencing and invalidating belong on the thread that made the
+// flag; debug builds check it. Weak pointers may be copied, passed to and
+// destroyed on any thread.
+//
+// An AtomicRefObject can lose its last reference, and so invalidate, on any
+// thread, so its flag is not tied to one. Lock() takes a reference to it
+// from any thread, under the lock invalidating takes, and only if its count
+// has not already reached zero; get() on such a pointer is only safe while
+// the caller holds a reference some other way.
+
+namespace subtle {
+
+class WeakReferenceFlag : public AtomicRefObject<WeakReferenceFlag> {
+public:
+    explicit WeakReferenceFlag(bool any_thread) : any_thread_(any_thread) {}
+
+    bool IsValid() const {
+        assert(any_thread_ || CalledOnValidThread());
+        return is_valid_.load(std::memory_order_relaxed);
+    }
+
+    void Invalidate() {
+        assert(any_thread_ || CalledOnValidThread());
+        std::lock_guard<std::mutex> guard(lock_);
+        is_valid_.store(false, std::memory_order_relaxed);
+    }
+
+    // Returns |take|() if the flag is valid, with invalidation held off
+    // meanwhile.
+    template <typename Take>
+    bool TakeIfValid(const Take& take) const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return is_valid_.load(std::memory_order_relaxed) && take();
+    }
+
+private:
+    friend class AtomicRefObject<WeakReferenceFlag>;
+    ~WeakReferenceFlag() {}
+
+#if !defined(NDEBUG)
+    bool CalledOnValidThread() const { return thread_id_ == std::this_thread::get_id(); }
+
+    const std::thread::id thread_id_ = std::this_thread::get_id();
+#endif
+    const bool any_thread_;
+    std::atomic<bool> is_valid_{ true };
+    mutable std::mutex lock_;
+};
+
+} // subtle
+
+template <typename T>
+class WeakPtrFactory;
+
+template <typename T>
+class WeakPtr {
+public:
+    WeakPtr() {}
+
+    WeakPtr(std::nullptr_t) {}
+
+    template <typename U>
+    WeakPtr(const WeakPtr<U>& r) : flag_(r.flag_), ptr_(r.ptr_) {}
+
+    template <typename U>
+    WeakPtr(WeakPtr<U>&& r) noexcept : flag_(std::move(r.flag_)), ptr_(r.ptr_) {
+        r.ptr_ = nullptr;
+    }
+
+    // Null once the object has gone.
+    T* get() const { return flag_ && flag_->IsValid() ? ptr_ : nullptr; }
+
+    T& operator*() const {
+        assert(get() != nullptr);
+        return *get();
+    }
+
+    T* operator->() const {
+        assert(get() != nullptr);
+        return get();
+    }
+
+    explicit operator bool() const { return get() != nullptr; }
+
+    // A reference to the object, or null once it has gone or is going. For
+    // AtomicRefObject types only; safe on any thread.
+    scoped_refptr<T> Lock() const {
+        if (!flag_ || !flag_->TakeIfValid([this]() { return ptr_->TryAddRef(); })) return nullptr;
+        return scoped_refptr<T>(ptr_, kAdoptRef);
+    }
+
+    void reset() {
+        flag_.reset();
+        ptr_ = nullptr;
+    }
+
+    void swap(WeakPtr<T>& r) {
+        flag_.swap(r.flag_);
+        std::swap(ptr_, r.ptr_);
+    }
+
+private:
+    template <typename U> friend class WeakPtr;
+    friend class WeakPtrFactory<T>;
+
+    WeakPtr(const scoped_refptr<subtle::WeakReferenceFlag>& flag, T* ptr) : flag_(flag), ptr_(ptr) {}
+
+    scoped_refptr<subtle::WeakReferenceFlag> flag_;
+    T* ptr_ = nullptr;
+};
+
+template <typename T>
+bool operator==(const WeakPtr<T>& weak_ptr, std::nullptr_t) { return !weak_ptr; }
+
+template <typename T>
+bool operator!=(const WeakPtr<T>& weak_ptr, std::nullptr_t) { return !!weak_ptr; }
+
+template <typename T>
+class WeakPtrFactory {
+public:
+    explicit WeakPtrFactory(T* ptr) : ptr_(ptr) {}
+
+    ~WeakPtrFactory() { InvalidateWeakPtrs(); }
+
+    WeakPtr<T> GetWeakPtr() {
+        if (!flag_) flag_ = MakeRefCounted<subtle::WeakReferenceFlag>(std::is_base_of<subtle::AtomicRefCounted, T>::value);
+        return WeakPtr<T>(flag_, ptr_);
+    }
+
+    // Invalidates every weak pointer handed out so far; later ones share a
+    // new flag.
+    void InvalidateWeakPtrs() {
+        if (!flag_) return;
+        flag_->Invalidate();
+        flag_.reset();
+    }
+
+    bool HasWeakPtrs() const { return flag_ && !flag_->OneRef(); }
+
+private:
+    scoped_refptr<subtle::WeakReferenceFlag> flag_;
+    T* const ptr_;
+
+    WeakPtrFactory(const WeakPtrFactory&) = delete;
+    void operator=(const WeakPtrFactory&) = delete;
+};
+
+#endif  // !UTILS_WEAK_PTR_INCLUDE_H_
@@ -0,0 +1,184 @@
+#include <Windows.h>
+#include "utils/weak_ptr.h"
+#include "utils/stl_util.h"
+#include "utils/test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef TEST
+
+namespace {
+
+class Base : public RefObject<Base> {
+public:
+    Base() : weak_factory_(this) {}
+
+    WeakPtr<Base> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+    void InvalidateWeakPtrs() { weak_factory_.InvalidateWeakPtrs(); }
+    bool HasWeakPtrs() const { return weak_factory_.HasWeakPtrs(); }
+
+    int value = 0;
+
+private:
+    WeakPtrFactory<Base> weak_factory_;
+};
+
+std::atomic<int> shared_destroyed(0);
+
+class Shared : public AtomicRefObject<Shared> {
+public:
+    Shared() : weak_factory_(this) {}
+    ~Shared() {
+        ++shared_destroyed;
+        // Widens the window between the count reaching zero and the factory
+        // invalidating the flag.
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+
+    WeakPtr<Shared> AsWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+private:
+    WeakPtrFactory<Shared> weak_factory_;
+};
+
+// The weak handle dynamic_library_interface.h made before: a weak_ptr to the
+// object and one to a flag whose check takes a mutex.
+class ThreadFlag {
+public:
+    bool CalledOnValidThread() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return thread_id_ == std::this_thread::get_id();
+    }
+
+private:
+    mutable std::mutex lock_;
+    std::thread::id thread_id_ = std::this_thread::get_id();
+};
+
+struct SharedWeakHandle {
+    Base* get() const {
+        auto object = object_.lock();
+        if (!object) return nullptr;
+        auto flag = flag_.lock();
+        return flag && flag->CalledOnValidThread() ? object.get() : nullptr;
+    }
+
+    std::weak_ptr<Base> object_;
+    std::weak_ptr<ThreadFlag> flag_;
+};
+
+}  // namespace
+
+int WEAK_PTR_TEST(void) {
+    WeakPtr<Base> empty;
+    if (empty || empty.get() || empty != nullptr) __debugbreak();
+
+    scoped_refptr<Base> base = MakeRefCounted<Base>();
+    if (base->HasWeakPtrs()) __debugbreak();
+    WeakPtr<Base> weak = base->AsWeakPtr();
+    WeakPtr<Base> copy = weak;
+    if (weak.get() != base.get() || !copy || copy == nullptr || !base->HasWeakPtrs()) __debugbreak();
+    copy->value = 4;
+    if ((*weak).value != 4) __debugbreak();
+
+    // Weak pointers neither hold nor count a reference to the object.
+    if (!base->OneRef()) __debugbreak();
+    WeakPtr<Base> moved(std::move(copy));
+    if (copy || moved.get() != base.get()) __debugbreak();
+    moved.reset();
+    if (moved || !weak) __debugbreak();
+
+    // Invalidating clears every pointer at once; the factory then hands out
+    // pointers on a new flag.
+    base->InvalidateWeakPtrs();
+    if (weak || weak.get() || base->HasWeakPtrs()) __debugbreak();
+    WeakPtr<Base> fresh = base->AsWeakPtr();
+    if (fresh.get() != base.get() || weak) __debugbreak();
+    weak.swap(fresh);
+    if (!weak || fresh) __debugbreak();
+
+    // Destroying the object invalidates them too.
+    base = nullptr;
+    if (weak) __debugbreak();
+
+    // Copies made and dropped on other threads only touch the flag's count.
+    scoped_refptr<Shared> shared = MakeRefCounted<Shared>();
+    WeakPtr<Shared> weak_shared = shared->AsWeakPtr();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([weak_shared]() {
+            for (int k = 0; k < 100000; ++k) {
+                WeakPtr<Shared> copy = weak_shared;
+                WeakPtr<Shared> moved = std::move(copy);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    if (weak_shared.get() != shared.get()) __debugbreak();
+    if (weak_shared.Lock() != shared) __debugbreak();
+    shared = nullptr;
+    if (weak_shared || weak_shared.Lock() || shared_destroyed != 1) __debugbreak();
+
+    // The last reference goes on another thread while this one keeps
+    // upgrading: Lock() either gets the object alive or null, and never
+    // brings it back once its count has reached zero.
+    for (int round = 0; round < 2000; ++round) {
+        scoped_refptr<Shared> object = MakeRefCounted<Shared>();
+        WeakPtr<Shared> weak_object = object->AsWeakPtr();
+        std::atomic<bool> started(false);
+        std::thread releaser([&object, &started]() {
+            started = true;
+            object = nullptr;
+        });
+        while (!started) {}
+        while (weak_object.Lock()) {}
+        releaser.join();
+        if (shared_destroyed != 2 + round) __debugbreak();
+    }
+    return 0;
+}
+
+// Makes 1M weak handles and dereferences one 10M times, with the
+// shared_ptr/weak_ptr/mutex handle dynamic_library_interface.h used and
+// with WeakPtr, and prints the time each takes.
+int WEAK_PTR_BENCHMARK(void) {
+    const int kHandles = 1000000;
+    const int kGets = 10000000;
+    auto shared_object = std::make_shared<Base>();
+    auto shared_flag = std::make_shared<ThreadFlag>();
+    scoped_refptr<Base> object = MakeRefCounted<Base>();
+    long long shared_sum = 0, weak_sum = 0;
+
+    auto shared_make = TimeMicroseconds([&]() {
+        for (int i = 0; i < kHandles; ++i) {
+            SharedWeakHandle handle{ shared_object, shared_flag };
+            shared_sum += handle.get() != nullptr;
+        }
+    });
+    auto weak_make = TimeMicroseconds([&]() {
+        for (int i = 0; i < kHandles; ++i) {
+            WeakPtr<Base> handle = object->AsWeakPtr();
+            weak_sum += handle.get() != nullptr;
+        }
+    });
+    SharedWeakHandle shared_handle{ shared_object, shared_flag };
+    WeakPtr<Base> weak_handle = object->AsWeakPtr();
+    auto shared_get = TimeMicroseconds([&]() {
+        for (int i = 0; i < kGets; ++i) shared_sum += shared_handle.get()->value + 1;
+    });
+    auto weak_get = TimeMicroseconds([&]() {
+        for (int i = 0; i < kGets; ++i) weak_sum += weak_handle.get()->value + 1;
+    });
+
+    std::cout << "Make a weak handle: shared_ptr " << shared_make << "us, WeakPtr " << weak_make << "us" << std::endl;
+    std::cout << "Dereference: shared_ptr " << shared_get << "us, WeakPtr " << weak_get << "us" << std::endl;
+    return shared_sum == weak_sum ? 0 : 1;
+}
+
+#endif // TEST